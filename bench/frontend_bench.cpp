@@ -0,0 +1,664 @@
+#include <benchmark/benchmark.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/scanner.hpp"
+#include "ast/flat_ast.hpp"
+#include "driver.hpp"
+#include "parser/incremental_parser.hpp"
+#include "parser/parallel_parser.hpp"
+#include "parser/parser.tab.hpp"
+#include "parser/recursive_descent_parser.hpp"
+#include "semantic/cfa_visitor.hpp"
+#include "semantic/entrypoint_visitor.hpp"
+#include "semantic/pass_manager.hpp"
+#include "semantic/inheritance_visitor.hpp"
+#include "semantic/semantic_error.hpp"
+#include "semantic/symbol_table.hpp"
+#include "semantic/symbol_table_class_collector_visitor.hpp"
+#include "semantic/symbol_table_index.hpp"
+#include "semantic/symbol_table_method_collector_visitor.hpp"
+#include "semantic/symbol_table_visitor.hpp"
+#include "semantic/type_checker_visitor.hpp"
+#include "stdlib/builtins.hpp"
+#include "util/program_generator.hpp"
+#include "visitor/iterative_visitor.hpp"
+#include "visitor/recursive_visitor.hpp"
+
+namespace {
+    // Locations of the parsed programs point at it.
+    const std::string filename = "generated.opp";
+
+    class NodeCounter : public yy::RecursiveVisitor<void> {
+    public:
+        size_t count() const noexcept {
+            return count_;
+        }
+
+        void operator()(const BooleanLiteralExpr &node) override { count(node); }
+
+        void operator()(const IntegerLiteralExpr &node) override { count(node); }
+
+        void operator()(const RealLiteralExpr &node) override { count(node); }
+
+        void operator()(const StringLiteralExpr &node) override { count(node); }
+
+        void operator()(const ThisExpr &node) override { count(node); }
+
+        void operator()(const FieldAccessExpr &node) override { count(node); }
+
+        void operator()(const MethodCallExpr &node) override { count(node); }
+
+        void operator()(const MemberAccess &node) override { count(node); }
+
+        void operator()(const Body &node) override { count(node); }
+
+        void operator()(const ReturnStmt &node) override { count(node); }
+
+        void operator()(const AssignmentStmt &node) override { count(node); }
+
+        void operator()(const IfStmt &node) override { count(node); }
+
+        void operator()(const WhileStmt &node) override { count(node); }
+
+        void operator()(const MemberDeclaration &node) override { count(node); }
+
+        void operator()(const ParameterDeclaration &node) override { count(node); }
+
+        void operator()(const VariableDeclaration &node) override { count(node); }
+
+        void operator()(const ConstructorDeclaration &node) override { count(node); }
+
+        void operator()(const ConstructorDefinition &node) override { count(node); }
+
+        void operator()(const MethodDeclaration &node) override { count(node); }
+
+        void operator()(const MethodDefinition &node) override { count(node); }
+
+        void operator()(const ProgramDeclaration &node) override { count(node); }
+
+        void operator()(const ClassDeclaration &node) override { count(node); }
+
+        void operator()(const ClassDefinition &node) override { count(node); }
+
+        void operator()(const Program &node) override { count(node); }
+
+    private:
+        template<class Node>
+        void count(const Node &node) {
+            ++count_;
+            RecursiveVisitor::operator()(node);
+        }
+
+        size_t count_ = 0;
+    };
+
+    // With `flat`, bison builds its FlatAst too.
+    std::unique_ptr<Program> parse(const std::string &text, yy::ParserBackend backend = yy::ParserBackend::Bison,
+                                   yy::FlatAstBuilder *flat = nullptr) {
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(text)), filename};
+        std::unique_ptr<Program> program;
+        int failure = backend == yy::ParserBackend::RecursiveDescent
+                      ? yy::RecursiveDescentParser(scanner, program)()
+                      : yy::parser(scanner, program, flat)();
+        if (failure != 0) {
+            throw std::runtime_error("Generated program does not parse");
+        }
+        return program;
+    }
+
+    size_t count_nodes(const Program &program) {
+        NodeCounter counter;
+        program.accept(counter);
+        return counter.count();
+    }
+
+    // Generated once per shape; several benchmarks share a shape.
+    struct Workload {
+        std::string text;
+        std::unique_ptr<Program> program;
+        size_t nodes;
+    };
+
+    const Workload &workload(const yy::ProgramShape &shape) {
+        static std::map<std::tuple<size_t, size_t, size_t, size_t>, std::unique_ptr<Workload>> workloads;
+        auto &entry = workloads[{shape.classes, shape.methods_per_class, shape.body_depth, shape.chain_length}];
+        if (!entry) {
+            entry = std::make_unique<Workload>();
+            entry->text = yy::generate_program(shape);
+            entry->program = parse(entry->text);
+            entry->nodes = count_nodes(*entry->program);
+        }
+        return *entry;
+    }
+
+    void set_rates(benchmark::State &state, const Workload &load) {
+        state.SetBytesProcessed(state.iterations() * load.text.size());
+        state.counters["nodes"] = benchmark::Counter(
+                static_cast<double>(state.iterations() * load.nodes),
+                benchmark::Counter::kIsRate
+        );
+    }
+
+    // Runs a pass of either kind over the program.
+    template<class PassVisitor>
+    void run_visitor(const Program &program, PassVisitor &pass) {
+        if constexpr (std::is_base_of_v<VisitorBase, PassVisitor>) {
+            program.accept(pass);
+        } else {
+            pass.visit(program);
+        }
+    }
+
+    enum class Pass {
+        ClassCollector,
+        MethodCollector,
+        SymbolTable,
+        EntryPoint,
+        TypeChecker,
+        ControlFlow,
+        Inheritance,
+    };
+
+    // The semantic state the driver threads through its passes.
+    class Analysis {
+    public:
+        Analysis() : table_(std::make_unique<SymbolTable>()) {
+            oppstd::register_builtins(table_.get());
+        }
+
+        void run(const Program &program, Pass pass) {
+            switch (pass) {
+                case Pass::ClassCollector:
+                    accept(program, yy::SymbolTableClassCollectorVisitor(table_.get(), errors_));
+                    break;
+                case Pass::MethodCollector:
+                    accept(program, yy::SymbolTableMethodCollectorVisitor(table_.get(), errors_));
+                    break;
+                case Pass::SymbolTable:
+                    accept(program, yy::SymbolTableVisitor(table_.get(), index_.get(), errors_));
+                    break;
+                case Pass::EntryPoint:
+                    accept(program, yy::EntryPointVisitor(index_.get(), errors_));
+                    break;
+                case Pass::TypeChecker:
+                    accept(program, yy::TypeCheckerVisitor(index_.get(), errors_));
+                    break;
+                case Pass::ControlFlow:
+                    accept(program, yy::CFAVisitor(errors_));
+                    break;
+                case Pass::Inheritance:
+                    accept(program, yy::InheritanceVisitor(index_.get(), errors_));
+                    break;
+            }
+        }
+
+        void clear_errors() {
+            errors_.clear();
+        }
+
+    private:
+        template<class PassVisitor>
+        static void accept(const Program &program, PassVisitor &&visitor) {
+            run_visitor(program, visitor);
+        }
+
+        std::unique_ptr<SymbolTableIndex> index_ = std::make_unique<SymbolTableIndex>();
+        std::unique_ptr<SymbolTable> table_;
+        std::vector<SemanticError> errors_;
+    };
+
+    yy::ProgramShape shape_of(const benchmark::State &state) {
+        yy::ProgramShape shape;
+        shape.classes = state.range(0);
+        shape.body_depth = state.range(1);
+        shape.chain_length = state.range(2);
+        return shape;
+    }
+
+    // Classes, body depth, chain length.
+    void shapes(benchmark::internal::Benchmark *benchmark) {
+        benchmark->ArgNames({"classes", "depth", "chain"});
+        benchmark->Args({100, 2, 3});
+        benchmark->Args({1000, 2, 3});
+        benchmark->Args({100, 5, 3});
+        benchmark->Args({100, 2, 12});
+    }
+}
+
+static void BM_GetToken(benchmark::State &state) {
+    const Workload &load = workload(shape_of(state));
+    size_t tokens = 0;
+
+    for (auto _: state) {
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(load.text)), filename};
+        do {
+            ++tokens;
+        } while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF);
+    }
+    state.SetBytesProcessed(state.iterations() * load.text.size());
+    state.counters["tokens"] = benchmark::Counter(static_cast<double>(tokens), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_GetToken)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+// Includes building the AST and tearing it down, as a compile does.
+static void BM_Parse(benchmark::State &state, yy::ParserBackend backend) {
+    const Workload &load = workload(shape_of(state));
+
+    for (auto _: state) {
+        benchmark::DoNotOptimize(parse(load.text, backend));
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_Parse, bison, yy::ParserBackend::Bison)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Parse, recursive_descent, yy::ParserBackend::RecursiveDescent)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+namespace {
+    class IterativeNodeCounter : public yy::IterativeVisitor<IterativeNodeCounter> {
+    public:
+        template<class Node>
+        bool enter(const Node &) {
+            ++count;
+            return true;
+        }
+
+        size_t count = 0;
+    };
+
+    class FlatNodeCounter : public yy::FlatVisitor {
+    public:
+        bool enter(const yy::FlatAst &, yy::NodeId) override {
+            ++count;
+            return true;
+        }
+
+        size_t count = 0;
+    };
+
+    enum class Walk {
+        Tree,
+        Iterative,
+        Flat,
+    };
+}
+
+// A full traversal, the one thing every semantic pass does: of the tree by
+// virtual calls and by IterativeVisitor, and of the same program flattened.
+static void BM_Walk(benchmark::State &state, Walk walk) {
+    const Workload &load = workload(shape_of(state));
+    const yy::FlatAst ast = yy::flatten(*load.program);
+
+    for (auto _: state) {
+        if (walk == Walk::Flat) {
+            FlatNodeCounter counter;
+            ast.walk(counter);
+            benchmark::DoNotOptimize(counter.count);
+        } else if (walk == Walk::Iterative) {
+            IterativeNodeCounter counter;
+            counter.visit(*load.program);
+            benchmark::DoNotOptimize(counter.count);
+        } else {
+            benchmark::DoNotOptimize(count_nodes(*load.program));
+        }
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_Walk, tree, Walk::Tree)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Walk, iterative, Walk::Iterative)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Walk, flat, Walk::Flat)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+static void BM_Flatten(benchmark::State &state) {
+    const Workload &load = workload(shape_of(state));
+
+    for (auto _: state) {
+        benchmark::DoNotOptimize(yy::flatten(*load.program));
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK(BM_Flatten)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+// Bison building the FlatAst beside the AST, against BM_Parse/bison followed
+// by BM_Flatten.
+static void BM_ParseFlat(benchmark::State &state) {
+    const Workload &load = workload(shape_of(state));
+
+    for (auto _: state) {
+        yy::FlatAst ast;
+        yy::FlatAstBuilder builder(ast);
+        benchmark::DoNotOptimize(parse(load.text, yy::ParserBackend::Bison, &builder));
+        benchmark::DoNotOptimize(ast.size());
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK(BM_ParseFlat)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+// The classes of a multi-megabyte program parsed on as many threads as asked for.
+static void BM_ParallelParse(benchmark::State &state) {
+    yy::ProgramShape shape;
+    shape.classes = 2000;
+    const Workload &load = workload(shape);
+    const auto threads = static_cast<unsigned>(state.range(0));
+
+    for (auto _: state) {
+        yy::ParallelParser parser(load.text, filename, threads);
+        auto program = parser.parse();
+        if (!program) {
+            state.SkipWithError("Generated program was not parsed in parallel");
+            break;
+        }
+        benchmark::DoNotOptimize(program);
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK(BM_ParallelParse)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// A keystroke in the middle of a 100k line program, typed into a method header
+// and deleted again, each followed by the new AST. Only a line break moves the
+// classes behind it.
+static void BM_IncrementalParse(benchmark::State &state, std::string_view typed) {
+    yy::ProgramShape shape;
+    shape.classes = 500;
+    const Workload &load = workload(shape);
+    yy::IncrementalParser parser(load.text, filename);
+    const size_t offset = load.text.find("method m5", load.text.find("class C250 ")) + std::string_view("method").size();
+
+    for (auto _: state) {
+        parser.apply({offset, 0, typed});
+        parser.apply({offset, typed.size(), ""});
+        benchmark::DoNotOptimize(parser.program());
+    }
+    if (parser.parsed_classes() != 1) {
+        state.SkipWithError("Edit was not parsed incrementally");
+    }
+    state.counters["edits"] = benchmark::Counter(static_cast<double>(2 * state.iterations()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_CAPTURE(BM_IncrementalParse, space, " ")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IncrementalParse, line_break, "\n")->Unit(benchmark::kMillisecond);
+
+// One semantic pass on the state the passes in front of it leave; only the pass
+// is timed. The collectors and the symbol table pass fill the tables, so they get
+// new ones every iteration; the passes behind them only read the tables and
+// report errors, and run again on the same ones.
+static void BM_SemanticPass(benchmark::State &state, Pass pass) {
+    const Workload &load = workload(shape_of(state));
+    auto prepare = [&] {
+        auto analysis = std::make_unique<Analysis>();
+        for (int before = 0; before < static_cast<int>(pass); before++) {
+            analysis->run(*load.program, static_cast<Pass>(before));
+        }
+        return analysis;
+    };
+
+    if (pass > Pass::SymbolTable) {
+        auto analysis = prepare();
+        for (auto _: state) {
+            analysis->run(*load.program, pass);
+            analysis->clear_errors();
+        }
+    } else {
+        for (auto _: state) {
+            state.PauseTiming();
+            auto analysis = prepare();
+            state.ResumeTiming();
+
+            analysis->run(*load.program, pass);
+
+            state.PauseTiming();
+            analysis.reset();
+            state.ResumeTiming();
+        }
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_SemanticPass, class_collector, Pass::ClassCollector)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SemanticPass, method_collector, Pass::MethodCollector)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SemanticPass, symbol_table, Pass::SymbolTable)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SemanticPass, entrypoint, Pass::EntryPoint)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SemanticPass, type_checker, Pass::TypeChecker)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SemanticPass, control_flow, Pass::ControlFlow)->Apply(shapes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SemanticPass, inheritance, Pass::Inheritance)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+// BM_SemanticPass/control_flow over the FlatAst of the same program.
+static void BM_FlatControlFlow(benchmark::State &state) {
+    const Workload &load = workload(shape_of(state));
+    const yy::FlatAst ast = yy::flatten(*load.program);
+    std::vector<SemanticError> errors;
+
+    for (auto _: state) {
+        yy::FlatCFAVisitor pass(ast, errors);
+        ast.walk(pass);
+        errors.clear();
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK(BM_FlatControlFlow)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+namespace {
+    // The names a program looks up, each with the scope it is looked up in:
+    // those of the fields and variables it reads and assigns, and the class of
+    // every integer literal, which is found in the outermost scope. And how
+    // many symbols it declares.
+    class NameUses : public yy::IterativeVisitor<NameUses> {
+    public:
+        explicit NameUses(SymbolTableIndex &index) : index_(index) {}
+
+        using IterativeVisitor::enter;
+
+        bool enter(const FieldAccessExpr &node) {
+            uses.emplace_back(&index_.restore(&node), node.name());
+            return true;
+        }
+
+        bool enter(const AssignmentStmt &node) {
+            uses.emplace_back(&index_.restore(&node), node.name());
+            return true;
+        }
+
+        bool enter(const IntegerLiteralExpr &node) {
+            uses.emplace_back(&index_.restore(&node), oppstd::integer_class);
+            return true;
+        }
+
+        bool enter(const ClassDefinition &) {
+            symbols++;
+            return true;
+        }
+
+        bool enter(const ConstructorDefinition &) {
+            symbols++;
+            return true;
+        }
+
+        bool enter(const MethodDefinition &) {
+            symbols++;
+            return true;
+        }
+
+        bool enter(const VariableDeclaration &) {
+            symbols++;
+            return true;
+        }
+
+        bool enter(const ParameterDeclaration &) {
+            symbols++;
+            return true;
+        }
+
+        std::vector<std::pair<SymbolTable *, yy::Name>> uses;
+        size_t symbols = 0;
+
+    private:
+        SymbolTableIndex &index_;
+    };
+
+    // What the allocator has handed out and not got back; 0 where it does not
+    // tell.
+    size_t allocated() {
+#ifdef __GLIBC__
+        return mallinfo2().uordblks;
+#else
+        return 0;
+#endif
+    }
+}
+
+// resolve_symbol() for every name the program looks up, from the scope it is
+// looked up in. The memory of the tables, without the index into them, is
+// counted per symbol declared.
+static void BM_SymbolLookup(benchmark::State &state) {
+    const Workload &load = workload(shape_of(state));
+    std::vector<SemanticError> errors;
+    auto index = std::make_unique<SymbolTableIndex>();
+    const size_t before = allocated();
+    auto table = std::make_unique<SymbolTable>();
+    oppstd::register_builtins(table.get());
+    yy::SymbolTableClassCollectorVisitor classes(table.get(), errors);
+    run_visitor(*load.program, classes);
+    yy::SymbolTableMethodCollectorVisitor members(table.get(), errors);
+    run_visitor(*load.program, members);
+    yy::SymbolTableVisitor scopes(table.get(), index.get(), errors);
+    run_visitor(*load.program, scopes);
+
+    NameUses names(*index);
+    names.visit(*load.program);
+    index.reset();
+    const size_t tables = allocated() - before - names.uses.capacity() * sizeof(names.uses[0]);
+
+    for (auto _: state) {
+        for (auto [scope, name]: names.uses) {
+            benchmark::DoNotOptimize(scope->resolve_symbol(name));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * names.uses.size());
+    state.counters["bytes_per_symbol"] = static_cast<double>(tables) / static_cast<double>(names.symbols);
+}
+
+BENCHMARK(BM_SymbolLookup)->Apply(shapes)->Unit(benchmark::kMillisecond);
+
+// All of the driver's passes: one after the other, in as few walks as they
+// allow, and on four threads, with and without fusing. The tables are new
+// every iteration, and built untimed.
+static void BM_SemanticAnalysis(benchmark::State &state, bool fusion, unsigned threads) {
+    const Workload &load = workload(shape_of(state));
+    std::vector<SemanticError> errors;
+    for (auto _: state) {
+        state.PauseTiming();
+        auto index = std::make_unique<SymbolTableIndex>();
+        auto table = std::make_unique<SymbolTable>();
+        oppstd::register_builtins(table.get());
+        yy::PassManager passes;
+        passes.set_fusion(fusion);
+        passes.set_threads(threads);
+        yy::add_semantic_passes(passes, table.get(), index.get());
+        state.ResumeTiming();
+
+        passes.run(*load.program, errors);
+
+        state.PauseTiming();
+        errors.clear();
+        table.reset();
+        index.reset();
+        state.ResumeTiming();
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_SemanticAnalysis, serial, false, 1)->Apply(shapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_SemanticAnalysis, fused, true, 1)->Apply(shapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_SemanticAnalysis, parallel, false, 4)->Apply(shapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_SemanticAnalysis, fused_parallel, true, 4)->Apply(shapes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+namespace {
+    // A method whose body is `levels` while loops deep, as machine-generated
+    // code may be. Counted with a walk of its own: a recursive one would run
+    // out of stack.
+    const Workload &nested_workload(size_t levels) {
+        static std::map<size_t, std::unique_ptr<Workload>> workloads;
+        auto &entry = workloads[levels];
+        if (!entry) {
+            entry = std::make_unique<Workload>();
+            entry->text = "class A is\n    method m() : Integer is\n";
+            for (size_t level = 0; level < levels; level++) {
+                entry->text += "while true loop\n";
+            }
+            entry->text += "return 1\n";
+            for (size_t level = 0; level < levels; level++) {
+                entry->text += "end\n";
+            }
+            entry->text += "    end\nend\nA()\n";
+            entry->program = parse(entry->text);
+
+            IterativeNodeCounter counter;
+            counter.visit(*entry->program);
+            entry->nodes = counter.count;
+        }
+        return *entry;
+    }
+}
+
+// A full walk of deeply nested bodies: by virtual calls as far as the stack
+// allows, and by IterativeVisitor to a million levels.
+static void BM_DeepWalk(benchmark::State &state, Walk walk) {
+    const Workload &load = nested_workload(state.range(0));
+    for (auto _: state) {
+        if (walk == Walk::Iterative) {
+            IterativeNodeCounter counter;
+            counter.visit(*load.program);
+            benchmark::DoNotOptimize(counter.count);
+        } else {
+            benchmark::DoNotOptimize(count_nodes(*load.program));
+        }
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_DeepWalk, tree, Walk::Tree)->ArgName("levels")->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DeepWalk, iterative, Walk::Iterative)
+        ->ArgName("levels")->Arg(1000)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// The passes over one scope per body on the same, after the collectors (and
+// the symbol table, for the type checker) and on new tables every iteration.
+static void BM_DeepNesting(benchmark::State &state, Pass pass) {
+    const Workload &load = nested_workload(state.range(0));
+    for (auto _: state) {
+        state.PauseTiming();
+        auto analysis = std::make_unique<Analysis>();
+        analysis->run(*load.program, Pass::ClassCollector);
+        analysis->run(*load.program, Pass::MethodCollector);
+        if (pass == Pass::TypeChecker) {
+            analysis->run(*load.program, Pass::SymbolTable);
+        }
+        state.ResumeTiming();
+
+        analysis->run(*load.program, pass);
+
+        state.PauseTiming();
+        analysis.reset();
+        state.ResumeTiming();
+    }
+    set_rates(state, load);
+}
+
+BENCHMARK_CAPTURE(BM_DeepNesting, symbol_table, Pass::SymbolTable)->ArgName("levels")->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DeepNesting, type_checker, Pass::TypeChecker)->ArgName("levels")->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DeepNesting, control_flow, Pass::ControlFlow)->ArgName("levels")->Arg(1000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "lexer/keywords.hpp"
+
+namespace {
+    const std::vector<std::string_view> vocabulary = {
+            "class", "Point", "extends", "Shape", "is", "var", "x", "Integer", "this", "px",
+            "method", "distance", "other", "Real", "if", "then", "return", "else", "end",
+            "while", "true", "loop", "counter", "plus", "false", "result", "sqrt", "label", "String",
+            "i", "isEmpty", "endpoint", "loops", "thenable", "classify", "value", "get", "set", "next",
+    };
+
+    // Long shuffled identifier stream, so the branch predictor cannot learn the sequence.
+    const std::vector<std::string_view> words = [] {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<size_t> pick(0, vocabulary.size() - 1);
+        std::vector<std::string_view> result(1 << 16);
+        for (auto &word: result) {
+            word = vocabulary[pick(random)];
+        }
+        return result;
+    }();
+
+    // The comparison chain the scanner used before the keyword table.
+    int keyword_chain(std::string_view s) {
+        if (s == "true") return yy::parser::token::BOOLEAN_LITERAL;
+        if (s == "false") return yy::parser::token::BOOLEAN_LITERAL;
+        if (s == "class") return yy::parser::token::CLASS;
+        if (s == "extends") return yy::parser::token::EXTENDS;
+        if (s == "is") return yy::parser::token::IS;
+        if (s == "end") return yy::parser::token::END;
+        if (s == "this") return yy::parser::token::THIS;
+        if (s == "method") return yy::parser::token::METHOD;
+        if (s == "return") return yy::parser::token::RETURN;
+        if (s == "var") return yy::parser::token::VAR;
+        if (s == "if") return yy::parser::token::IF;
+        if (s == "then") return yy::parser::token::THEN;
+        if (s == "else") return yy::parser::token::ELSE;
+        if (s == "while") return yy::parser::token::WHILE;
+        if (s == "loop") return yy::parser::token::LOOP;
+        return yy::parser::token::IDENTIFIER;
+    }
+
+    int keyword_table(std::string_view s) {
+        const yy::Keyword *keyword = yy::find_keyword(s);
+        return keyword ? keyword->token : yy::parser::token::IDENTIFIER;
+    }
+}
+
+static void BM_KeywordChain(benchmark::State &state) {
+    for (auto _: state) {
+        for (auto word: words) {
+            benchmark::DoNotOptimize(keyword_chain(word));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+BENCHMARK(BM_KeywordChain);
+
+static void BM_KeywordPerfectHash(benchmark::State &state) {
+    for (auto _: state) {
+        for (auto word: words) {
+            benchmark::DoNotOptimize(keyword_table(word));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+BENCHMARK(BM_KeywordPerfectHash);
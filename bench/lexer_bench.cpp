@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include <string>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/incremental_lexer.hpp"
+#include "lexer/parallel_lexer.hpp"
+#include "lexer/scanner.hpp"
+#include "lexer/scan_kernels.hpp"
+#include "lexer/token_cache.hpp"
+
+namespace {
+    const std::string corpus_unit = R"(
+class Point extends Shape is
+    var x : Integer(12345)
+    var label : String('a rather long string literal, as code generators like to emit them')
+    this(px: Integer, py: Real) is
+        x := px
+        while true loop
+            x := x.plus(1)
+        end
+    end
+
+    method distance(other: Point) : Real is
+        if false then
+            return 3.14159
+        else
+            return this.dist_squared_to_the_other_point(other).sqrt()
+        end
+    end
+
+    method area() : Real => 0.5
+end
+)";
+
+    // The corpus cut down to about fifty thousand lines, an editor sized file.
+    const std::string &editor_file() {
+        static const std::string text = [] {
+            std::string result;
+            size_t lines = 0;
+            while (lines < 50000) {
+                result += corpus_unit;
+                lines += std::count(corpus_unit.begin(), corpus_unit.end(), '\n');
+            }
+            return result;
+        }();
+        return text;
+    }
+
+    const std::string &corpus() {
+        static const std::string text = [] {
+            std::string result;
+            while (result.size() < (100 << 20)) {
+                result += corpus_unit;
+            }
+            return result;
+        }();
+        return text;
+    }
+}
+
+static void BM_ScannerKernels(benchmark::State &state) {
+    const yy::ScanKernels *kernels = yy::available_scan_kernels().at(state.range(0));
+    const std::string filename = "bench.opp";
+    state.SetLabel(kernels->name);
+
+    for (auto _: state) {
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(corpus())), filename, *kernels};
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * corpus().size());
+}
+
+BENCHMARK(BM_ScannerKernels)
+        ->DenseRange(0, static_cast<int>(yy::available_scan_kernels().size()) - 1)
+        ->Unit(benchmark::kMillisecond);
+
+static void BM_TokenCacheReplay(benchmark::State &state) {
+    const std::string filename = "bench.opp";
+    const std::string path = (std::filesystem::temp_directory_path() / "opp_bench.optok").string();
+    {
+        yy::TokenCacheWriter recorder;
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(corpus())), filename};
+        scanner.record_to(&recorder);
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+        recorder.write(path, corpus());
+    }
+
+    for (auto _: state) {
+        // Opening includes hashing the source, as a compile would.
+        auto cache = yy::TokenCacheReader::open(path, corpus());
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(corpus())), filename};
+        scanner.replay_from(cache.get());
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * corpus().size());
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_TokenCacheReplay)->Unit(benchmark::kMillisecond);
+
+// Compare against BM_ScannerKernels for the serial baseline; threads beyond the
+// machine's cores only add scheduling overhead.
+static void BM_ParallelLexer(benchmark::State &state) {
+    const std::string filename = "bench.opp";
+    const auto threads = static_cast<unsigned>(state.range(0));
+
+    for (auto _: state) {
+        yy::ParallelLexer lexer(corpus(), threads);
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(corpus())), filename};
+        scanner.replay_from(&lexer);
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * corpus().size());
+}
+
+BENCHMARK(BM_ParallelLexer)
+        ->RangeMultiplier(2)
+        ->Range(1, 16)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+
+// Types one character into an identifier in the middle of the file and deletes
+// it again; two single character edits per iteration.
+static void BM_IncrementalEdit(benchmark::State &state) {
+    yy::IncrementalLexer lexer(editor_file(), "edited.opp");
+    const size_t offset = editor_file().find("dist_squared", editor_file().size() / 2);
+
+    for (auto _: state) {
+        lexer.apply({offset, 0, "x"});
+        lexer.apply({offset, 1, ""});
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK(BM_IncrementalEdit)->Unit(benchmark::kMicrosecond);
+
+// What an edit cost before: lexing the whole file again.
+static void BM_FullRelex(benchmark::State &state) {
+    for (auto _: state) {
+        yy::IncrementalLexer lexer(editor_file(), "edited.opp");
+        benchmark::DoNotOptimize(lexer.tokens().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FullRelex)->Unit(benchmark::kMicrosecond);
+
+// The corpus read from a file descriptor through the default window, as a pipe would be.
+static void BM_StreamingReader(benchmark::State &state) {
+    const std::string filename = "bench.opp";
+    const std::string path = (std::filesystem::temp_directory_path() / "opp_bench_stream.opp").string();
+    std::ofstream(path, std::ios::binary) << corpus();
+
+    for (auto _: state) {
+        int fd = open(path.c_str(), O_RDONLY);
+        yy::Scanner scanner{yy::BufferedReader::stream(fd), filename};
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+        close(fd);
+    }
+    state.SetBytesProcessed(state.iterations() * corpus().size());
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_StreamingReader)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,183 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <malloc.h>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include "ast/ast_arena.hpp"
+#include "lexer/buffered_reader.hpp"
+#include "lexer/scanner.hpp"
+#include "parser/parser.tab.hpp"
+#include "util/program_generator.hpp"
+
+// Live heap bytes and their high-water mark, counted while `tracking` is set.
+// Untracked allocations cost one branch, so the other benchmarks are unaffected.
+namespace {
+    bool tracking = false;
+    size_t live_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t allocations = 0;
+}
+
+void *operator new(size_t size) {
+    void *memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    if (tracking) {
+        ++allocations;
+        live_bytes += malloc_usable_size(memory);
+        peak_bytes = std::max(peak_bytes, live_bytes);
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    if (tracking && memory) {
+        live_bytes -= std::min(live_bytes, malloc_usable_size(memory));
+    }
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    operator delete(memory);
+}
+
+namespace {
+    const std::string filename = "stress.opp";
+
+    std::string member_chain(size_t links) {
+        std::string text = "class Main is\n    this() is\n        var chained : this";
+        for (size_t i = 0; i < links; i++) {
+            text += ".next()";
+        }
+        return text + "\n    end\nend\n\nMain()\n";
+    }
+
+    std::string parameter_list(size_t parameters) {
+        std::string text = "class Main is\n    method wide(";
+        for (size_t i = 0; i < parameters; i++) {
+            text += (i ? ", p" : "p") + std::to_string(i) + ": Integer";
+        }
+        return text + ") is\n    end\nend\n\nMain()\n";
+    }
+
+    std::unique_ptr<Program> parse(const std::string &text) {
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(text)), filename};
+        std::unique_ptr<Program> program;
+        yy::parser parser(scanner, program, nullptr);
+        if (parser() != 0) {
+            throw std::runtime_error("Stress program does not parse");
+        }
+        return program;
+    }
+
+    // Heap the parse needs beyond the AST it returns: the parser stack and the
+    // lists it builds the AST from. A stack growing with the input shows here
+    // as bytes per element that do not go down as the input grows.
+    size_t transient_bytes(const std::string &text) {
+        live_bytes = 0;
+        peak_bytes = 0;
+        tracking = true;
+        auto program = parse(text);
+        const size_t retained = live_bytes;
+        program.reset();
+        tracking = false;
+        return peak_bytes - retained;
+    }
+
+    void stress(benchmark::State &state, const std::string &text) {
+        const auto elements = static_cast<size_t>(state.range(0));
+        const size_t transient = transient_bytes(text);
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(parse(text));
+        }
+        state.SetItemsProcessed(state.iterations() * elements);
+        state.counters["transient_bytes"] = static_cast<double>(transient);
+        state.counters["transient_per_element"] = static_cast<double>(transient) / elements;
+    }
+}
+
+static void BM_LongMemberChain(benchmark::State &state) {
+    stress(state, member_chain(state.range(0)));
+}
+
+BENCHMARK(BM_LongMemberChain)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+static void BM_LongParameterList(benchmark::State &state) {
+    stress(state, parameter_list(state.range(0)));
+}
+
+BENCHMARK(BM_LongParameterList)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+namespace {
+    // A few megabytes of generated classes, parsed into the heap or an arena.
+    const std::string &generated_program() {
+        static const std::string text = [] {
+            yy::ProgramShape shape;
+            shape.classes = 500;
+            return yy::generate_program(shape);
+        }();
+        return text;
+    }
+
+    struct ParsedProgram {
+        std::unique_ptr<yy::AstArena> arena;
+        std::unique_ptr<Program> program;
+    };
+
+    ParsedProgram parse_into(bool use_arena) {
+        ParsedProgram parsed;
+        if (use_arena) {
+            parsed.arena = std::make_unique<yy::AstArena>();
+        }
+        yy::AstArena::Scope scope(parsed.arena.get());
+        parsed.program = parse(generated_program());
+        return parsed;
+    }
+
+    void tear_down(ParsedProgram &parsed) {
+        parsed.program.reset();
+        parsed.arena.reset();
+    }
+}
+
+// Parse time, and the heap allocations it takes.
+static void BM_AstParse(benchmark::State &state, bool use_arena) {
+    size_t parse_allocations = 0;
+    for (auto _: state) {
+        allocations = 0;
+        tracking = true;
+        ParsedProgram parsed = parse_into(use_arena);
+        tracking = false;
+        parse_allocations = allocations;
+
+        state.PauseTiming();
+        tear_down(parsed);
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(state.iterations() * generated_program().size());
+    state.counters["allocations"] = static_cast<double>(parse_allocations);
+}
+
+BENCHMARK_CAPTURE(BM_AstParse, heap, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AstParse, arena, true)->Unit(benchmark::kMillisecond);
+
+// Tearing the AST down, and the arena with it.
+static void BM_AstTeardown(benchmark::State &state, bool use_arena) {
+    for (auto _: state) {
+        state.PauseTiming();
+        ParsedProgram parsed = parse_into(use_arena);
+        state.ResumeTiming();
+
+        tear_down(parsed);
+    }
+}
+
+BENCHMARK_CAPTURE(BM_AstTeardown, heap, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AstTeardown, arena, true)->Unit(benchmark::kMillisecond);
@@ -8,6 +8,7 @@ class OPPFrontendConan(ConanFile):
     def requirements(self):
         self.requires("llvm/17.0.2")
         self.requires("gtest/1.16.0")
+        self.requires("benchmark/1.9.1")
 
     def build_requirements(self):
         self.tool_requires("bison/3.8.2")
@@ -1,21 +1,78 @@
 #include "ast/ast.hpp"
 
-NodeBase::NodeBase(yy::location l) noexcept: location_(l) {}
+#include <cstddef>
+#include <new>
+
+#include "ast/ast_arena.hpp"
+
+namespace {
+    // In front of every node, saying where it came from; sized to keep the node aligned.
+    constexpr size_t origin_size = alignof(std::max_align_t);
+
+    enum class Origin : unsigned char {
+        Heap,
+        Arena,
+    };
+}
+
+NodeBase::NodeBase(yy::NodeKind kind, yy::SourceRange l) noexcept: location_(l), kind_(kind) {}
 
 NodeBase::~NodeBase() {}
 
-yy::location NodeBase::location() const noexcept {
+yy::SourceRange NodeBase::location() const noexcept {
     return location_;
 }
 
-BodyExpr::BodyExpr(yy::location l) noexcept: NodeBase(l) {}
+void NodeBase::relocate(yy::SourceRange l) noexcept {
+    location_ = l;
+}
 
-BodyExpr::~BodyExpr() {}
+void *NodeBase::operator new(size_t size) {
+    yy::AstArena *arena = yy::AstArena::current();
+    auto *memory = static_cast<std::byte *>(
+            arena ? arena->allocate(origin_size + size) : ::operator new(origin_size + size)
+    );
+    *reinterpret_cast<Origin *>(memory) = arena ? Origin::Arena : Origin::Heap;
+    return memory + origin_size;
+}
 
-Body::Body(yy::location l, std::vector<std::unique_ptr<BodyExpr>> &&expressions) noexcept
-        : NodeBase(l), expressions_(std::move(expressions)) {}
+void NodeBase::operator delete(void *node) noexcept {
+    auto *memory = static_cast<std::byte *>(node) - origin_size;
+    if (*reinterpret_cast<Origin *>(memory) == Origin::Heap) {
+        ::operator delete(memory);
+    }
+}
 
-Body::~Body() {}
+BodyExpr::BodyExpr(yy::NodeKind kind, yy::SourceRange l) noexcept: NodeBase(kind, l) {}
+
+BodyExpr::~BodyExpr() {}
+
+Body::Body(yy::SourceRange l, std::vector<std::unique_ptr<BodyExpr>> &&expressions) noexcept
+        : NodeBase(yy::NodeKind::Body, l), expressions_(std::move(expressions)) {}
+
+Body::~Body() {
+    // If and while statements nest bodies as deep as the source does; free the
+    // bodies below from a list rather than through destructor calls per level.
+    std::vector<std::unique_ptr<Body>> nested;
+    auto take = [&nested](std::vector<std::unique_ptr<BodyExpr>> &expressions) {
+        for (auto &expression: expressions) {
+            if (auto *if_stmt = llvm::dyn_cast_or_null<IfStmt>(expression.get())) {
+                nested.push_back(std::move(if_stmt->then_body_));
+                nested.push_back(std::move(if_stmt->else_body_));
+            } else if (auto *while_stmt = llvm::dyn_cast_or_null<WhileStmt>(expression.get())) {
+                nested.push_back(std::move(while_stmt->loop_body_));
+            }
+        }
+    };
+    take(expressions_);
+    while (!nested.empty()) {
+        auto body = std::move(nested.back());
+        nested.pop_back();
+        if (body) {
+            take(body->expressions_);
+        }
+    }
+}
 
 const std::vector<std::unique_ptr<BodyExpr>> &Body::expressions() const noexcept {
     return expressions_;
@@ -25,15 +82,15 @@ void Body::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-Expr::Expr(yy::location l) noexcept: BodyExpr(l) {}
+Expr::Expr(yy::NodeKind kind, yy::SourceRange l) noexcept: BodyExpr(kind, l) {}
 
 Expr::~Expr() {}
 
-PrimaryExpr::PrimaryExpr(yy::location l) noexcept: Expr(l) {}
+PrimaryExpr::PrimaryExpr(yy::NodeKind kind, yy::SourceRange l) noexcept: Expr(kind, l) {}
 
 PrimaryExpr::~PrimaryExpr() {}
 
-BooleanLiteralExpr::BooleanLiteralExpr(yy::location l, bool value) noexcept: PrimaryExpr(l), value_(value) {}
+BooleanLiteralExpr::BooleanLiteralExpr(yy::SourceRange l, bool value) noexcept: PrimaryExpr(yy::NodeKind::BooleanLiteral, l), value_(value) {}
 
 BooleanLiteralExpr::~BooleanLiteralExpr() {}
 
@@ -45,7 +102,7 @@ void BooleanLiteralExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-IntegerLiteralExpr::IntegerLiteralExpr(yy::location l, int value) noexcept: PrimaryExpr(l), value_(value) {}
+IntegerLiteralExpr::IntegerLiteralExpr(yy::SourceRange l, int value) noexcept: PrimaryExpr(yy::NodeKind::IntegerLiteral, l), value_(value) {}
 
 IntegerLiteralExpr::~IntegerLiteralExpr() {}
 
@@ -57,7 +114,7 @@ void IntegerLiteralExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-RealLiteralExpr::RealLiteralExpr(yy::location l, double value) noexcept: PrimaryExpr(l), value_(value) {}
+RealLiteralExpr::RealLiteralExpr(yy::SourceRange l, double value) noexcept: PrimaryExpr(yy::NodeKind::RealLiteral, l), value_(value) {}
 
 RealLiteralExpr::~RealLiteralExpr() {}
 
@@ -69,7 +126,7 @@ void RealLiteralExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-StringLiteralExpr::StringLiteralExpr(const yy::location &l, const std::string &value) noexcept: PrimaryExpr(l),
+StringLiteralExpr::StringLiteralExpr(const yy::SourceRange &l, const std::string &value) noexcept: PrimaryExpr(yy::NodeKind::StringLiteral, l),
                                                                                                 value_(value) {}
 
 StringLiteralExpr::~StringLiteralExpr() {}
@@ -82,7 +139,7 @@ void StringLiteralExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ThisExpr::ThisExpr(yy::location l) noexcept: PrimaryExpr(l) {}
+ThisExpr::ThisExpr(yy::SourceRange l) noexcept: PrimaryExpr(yy::NodeKind::This, l) {}
 
 ThisExpr::~ThisExpr() {}
 
@@ -90,15 +147,15 @@ void ThisExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-MemberAccessExpr::MemberAccessExpr(yy::location l) noexcept: Expr(l) {}
+MemberAccessExpr::MemberAccessExpr(yy::NodeKind kind, yy::SourceRange l) noexcept: Expr(kind, l) {}
 
 MemberAccessExpr::~MemberAccessExpr() {}
 
-FieldAccessExpr::FieldAccessExpr(const yy::location &l, const std::string &name) noexcept: MemberAccessExpr(l), name_(name) {}
+FieldAccessExpr::FieldAccessExpr(const yy::SourceRange &l, yy::Name name) noexcept: MemberAccessExpr(yy::NodeKind::FieldAccess, l), name_(name) {}
 
 FieldAccessExpr::~FieldAccessExpr() {}
 
-const std::string &FieldAccessExpr::name() const {
+yy::Name FieldAccessExpr::name() const {
     return name_;
 }
 
@@ -106,13 +163,13 @@ void FieldAccessExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-MethodCallExpr::MethodCallExpr(const yy::location &l, const std::string &name,
+MethodCallExpr::MethodCallExpr(const yy::SourceRange &l, yy::Name name,
                                std::vector<std::unique_ptr<Expr>> &&arguments)
-        : MemberAccessExpr(l), name_(name), arguments_(std::move(arguments)) {}
+        : MemberAccessExpr(yy::NodeKind::MethodCall, l), name_(name), arguments_(std::move(arguments)) {}
 
 MethodCallExpr::~MethodCallExpr() {}
 
-const std::string &MethodCallExpr::name() const noexcept {
+yy::Name MethodCallExpr::name() const noexcept {
     return name_;
 }
 
@@ -124,30 +181,45 @@ void MethodCallExpr::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-MemberAccess::MemberAccess(yy::location l, std::unique_ptr<Expr> &&lhs,
+MemberAccess::MemberAccess(yy::SourceRange l, std::unique_ptr<Expr> &&lhs,
                            std::unique_ptr<MemberAccessExpr> &&rhs) noexcept
-        : MemberAccessExpr(l), lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+        : MemberAccessExpr(yy::NodeKind::MemberAccess, l), lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
 
-MemberAccess::~MemberAccess() {}
+MemberAccess::~MemberAccess() {
+    // A fluent chain nests as deep as it is long; free it link by link rather
+    // than through one destructor call per link.
+    std::unique_ptr<MemberAccessExpr> next = std::move(rhs_);
+    while (auto *access = llvm::dyn_cast_or_null<MemberAccess>(next.get())) {
+        next = std::move(access->rhs_);
+    }
+}
 
 const Expr *MemberAccess::lhs() const noexcept {
     return lhs_.get();
 }
 
+Expr *MemberAccess::lhs() noexcept {
+    return lhs_.get();
+}
+
 const MemberAccessExpr *MemberAccess::rhs() const noexcept {
     return rhs_.get();
 }
 
+MemberAccessExpr *MemberAccess::rhs() noexcept {
+    return rhs_.get();
+}
+
 void MemberAccess::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-Stmt::Stmt(yy::location l) noexcept: BodyExpr(l) {}
+Stmt::Stmt(yy::NodeKind kind, yy::SourceRange l) noexcept: BodyExpr(kind, l) {}
 
 Stmt::~Stmt() {}
 
-ReturnStmt::ReturnStmt(yy::location l, std::unique_ptr<Expr> &&expression) noexcept
-        : Stmt(l), expression_(std::move(expression)) {}
+ReturnStmt::ReturnStmt(yy::SourceRange l, std::unique_ptr<Expr> &&expression) noexcept
+        : Stmt(yy::NodeKind::Return, l), expression_(std::move(expression)) {}
 
 ReturnStmt::~ReturnStmt() {}
 
@@ -155,16 +227,20 @@ const Expr *ReturnStmt::expression() const noexcept {
     return expression_.get();
 }
 
+Expr *ReturnStmt::expression() noexcept {
+    return expression_.get();
+}
+
 void ReturnStmt::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-AssignmentStmt::AssignmentStmt(yy::location l, std::string name, std::unique_ptr<Expr> &&expression)
-        : Stmt(l), name_(std::move(name)), expression_(std::move(expression)) {}
+AssignmentStmt::AssignmentStmt(yy::SourceRange l, yy::Name name, std::unique_ptr<Expr> &&expression)
+        : Stmt(yy::NodeKind::Assignment, l), name_(name), expression_(std::move(expression)) {}
 
 AssignmentStmt::~AssignmentStmt() {}
 
-const std::string &AssignmentStmt::name() const noexcept {
+yy::Name AssignmentStmt::name() const noexcept {
     return name_;
 }
 
@@ -172,13 +248,17 @@ const Expr *AssignmentStmt::expression() const noexcept {
     return expression_.get();
 }
 
+Expr *AssignmentStmt::expression() noexcept {
+    return expression_.get();
+}
+
 void AssignmentStmt::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-IfStmt::IfStmt(yy::location l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&then_body,
+IfStmt::IfStmt(yy::SourceRange l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&then_body,
                std::unique_ptr<Body> &&else_body) noexcept
-        : Stmt(l), condition_(std::move(condition)), then_body_(std::move(then_body)),
+        : Stmt(yy::NodeKind::If, l), condition_(std::move(condition)), then_body_(std::move(then_body)),
           else_body_(std::move(else_body)) {}
 
 IfStmt::~IfStmt() {}
@@ -187,20 +267,32 @@ const Expr *IfStmt::condition() const noexcept {
     return condition_.get();
 }
 
+Expr *IfStmt::condition() noexcept {
+    return condition_.get();
+}
+
 const Body *IfStmt::then_body() const noexcept {
     return then_body_.get();
 }
 
+Body *IfStmt::then_body() noexcept {
+    return then_body_.get();
+}
+
 const Body *IfStmt::else_body() const noexcept {
     return else_body_.get();
 }
 
+Body *IfStmt::else_body() noexcept {
+    return else_body_.get();
+}
+
 void IfStmt::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-WhileStmt::WhileStmt(yy::location l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&loop_body) noexcept
-        : Stmt(l), condition_(std::move(condition)), loop_body_(std::move(loop_body)) {}
+WhileStmt::WhileStmt(yy::SourceRange l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&loop_body) noexcept
+        : Stmt(yy::NodeKind::While, l), condition_(std::move(condition)), loop_body_(std::move(loop_body)) {}
 
 WhileStmt::~WhileStmt() {}
 
@@ -208,21 +300,29 @@ const Expr *WhileStmt::condition() const noexcept {
     return condition_.get();
 }
 
+Expr *WhileStmt::condition() noexcept {
+    return condition_.get();
+}
+
 const Body *WhileStmt::loop_body() const noexcept {
     return loop_body_.get();
 }
 
+Body *WhileStmt::loop_body() noexcept {
+    return loop_body_.get();
+}
+
 void WhileStmt::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-MemberDeclarationExpr::MemberDeclarationExpr(yy::location l) noexcept: NodeBase(l) {}
+MemberDeclarationExpr::MemberDeclarationExpr(yy::NodeKind kind, yy::SourceRange l) noexcept: NodeBase(kind, l) {}
 
 MemberDeclarationExpr::~MemberDeclarationExpr() {}
 
-MemberDeclaration::MemberDeclaration(yy::location l,
+MemberDeclaration::MemberDeclaration(yy::SourceRange l,
                                      std::vector<std::unique_ptr<MemberDeclarationExpr>> &&member_declarations) noexcept
-        : NodeBase(l), member_declarations_(std::move(member_declarations)) {}
+        : NodeBase(yy::NodeKind::MemberDeclaration, l), member_declarations_(std::move(member_declarations)) {}
 
 MemberDeclaration::~MemberDeclaration() {}
 
@@ -234,16 +334,16 @@ void MemberDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ParameterDeclaration::ParameterDeclaration(yy::location l, std::string name, std::string type)
-        : NodeBase(l), name_(std::move(name)), type_(std::move(type)) {}
+ParameterDeclaration::ParameterDeclaration(yy::SourceRange l, yy::Name name, yy::Name type)
+        : NodeBase(yy::NodeKind::Parameter, l), name_(name), type_(type) {}
 
 ParameterDeclaration::~ParameterDeclaration() {}
 
-const std::string &ParameterDeclaration::name() const noexcept {
+yy::Name ParameterDeclaration::name() const noexcept {
     return name_;
 }
 
-const std::string &ParameterDeclaration::type() const noexcept {
+yy::Name ParameterDeclaration::type() const noexcept {
     return type_;
 }
 
@@ -251,12 +351,12 @@ void ParameterDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-VariableDeclaration::VariableDeclaration(yy::location l, std::string name, std::unique_ptr<Expr> &&initializer)
-        : MemberDeclarationExpr(l), BodyExpr(l), name_(std::move(name)), initializer_(std::move(initializer)) {}
+VariableDeclaration::VariableDeclaration(yy::SourceRange l, yy::Name name, std::unique_ptr<Expr> &&initializer)
+        : MemberDeclarationExpr(yy::NodeKind::Variable, l), BodyExpr(yy::NodeKind::Variable, l), name_(name), initializer_(std::move(initializer)) {}
 
 VariableDeclaration::~VariableDeclaration() {}
 
-const std::string &VariableDeclaration::name() const noexcept {
+yy::Name VariableDeclaration::name() const noexcept {
     return name_;
 }
 
@@ -264,13 +364,17 @@ const Expr *VariableDeclaration::initializer() const noexcept {
     return initializer_.get();
 }
 
+Expr *VariableDeclaration::initializer() noexcept {
+    return initializer_.get();
+}
+
 void VariableDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ConstructorDeclaration::ConstructorDeclaration(yy::location l,
+ConstructorDeclaration::ConstructorDeclaration(yy::SourceRange l,
                                                std::vector<std::unique_ptr<ParameterDeclaration>> &&parameters) noexcept
-        : MemberDeclarationExpr(l), parameters_(std::move(parameters)) {}
+        : MemberDeclarationExpr(yy::NodeKind::ConstructorDeclaration, l), parameters_(std::move(parameters)) {}
 
 ConstructorDeclaration::~ConstructorDeclaration() {}
 
@@ -282,9 +386,9 @@ void ConstructorDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ConstructorDefinition::ConstructorDefinition(yy::location l, std::unique_ptr<ConstructorDeclaration> &&header,
+ConstructorDefinition::ConstructorDefinition(yy::SourceRange l, std::unique_ptr<ConstructorDeclaration> &&header,
                                              std::unique_ptr<Body> &&body) noexcept
-        : MemberDeclarationExpr(l), header_(std::move(header)), body_(std::move(body)) {}
+        : MemberDeclarationExpr(yy::NodeKind::ConstructorDefinition, l), header_(std::move(header)), body_(std::move(body)) {}
 
 ConstructorDefinition::~ConstructorDefinition() {}
 
@@ -292,23 +396,31 @@ const ConstructorDeclaration *ConstructorDefinition::header() const noexcept {
     return header_.get();
 }
 
+ConstructorDeclaration *ConstructorDefinition::header() noexcept {
+    return header_.get();
+}
+
 const Body *ConstructorDefinition::body() const noexcept {
     return body_.get();
 }
 
+Body *ConstructorDefinition::body() noexcept {
+    return body_.get();
+}
+
 void ConstructorDefinition::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-MethodDeclaration::MethodDeclaration(yy::location l, std::string name,
+MethodDeclaration::MethodDeclaration(yy::SourceRange l, yy::Name name,
                                      std::vector<std::unique_ptr<ParameterDeclaration>> &&parameters,
-                                     std::string return_type)
-        : MemberDeclarationExpr(l), name_(std::move(name)), parameters_(std::move(parameters)),
-          return_type_(std::move(return_type)) {}
+                                     yy::Name return_type)
+        : MemberDeclarationExpr(yy::NodeKind::MethodDeclaration, l), name_(name), parameters_(std::move(parameters)),
+          return_type_(return_type) {}
 
 MethodDeclaration::~MethodDeclaration() {}
 
-const std::string &MethodDeclaration::name() const noexcept {
+yy::Name MethodDeclaration::name() const noexcept {
     return name_;
 }
 
@@ -316,7 +428,7 @@ const std::vector<std::unique_ptr<ParameterDeclaration>> &MethodDeclaration::par
     return parameters_;
 }
 
-const std::string &MethodDeclaration::return_type() const noexcept {
+yy::Name MethodDeclaration::return_type() const noexcept {
     return return_type_;
 }
 
@@ -324,9 +436,9 @@ void MethodDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-MethodDefinition::MethodDefinition(yy::location l, std::unique_ptr<MethodDeclaration> &&header,
+MethodDefinition::MethodDefinition(yy::SourceRange l, std::unique_ptr<MethodDeclaration> &&header,
                                    std::unique_ptr<Body> &&body) noexcept
-        : MemberDeclarationExpr(l), header_(std::move(header)), body_(std::move(body)) {}
+        : MemberDeclarationExpr(yy::NodeKind::MethodDefinition, l), header_(std::move(header)), body_(std::move(body)) {}
 
 MethodDefinition::~MethodDefinition() {}
 
@@ -334,21 +446,29 @@ const MethodDeclaration *MethodDefinition::header() const noexcept {
     return header_.get();
 }
 
+MethodDeclaration *MethodDefinition::header() noexcept {
+    return header_.get();
+}
+
 const Body *MethodDefinition::body() const noexcept {
     return body_.get();
 }
 
+Body *MethodDefinition::body() noexcept {
+    return body_.get();
+}
+
 void MethodDefinition::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ProgramDeclarationExpr::ProgramDeclarationExpr(yy::location l) noexcept: NodeBase(l) {}
+ProgramDeclarationExpr::ProgramDeclarationExpr(yy::NodeKind kind, yy::SourceRange l) noexcept: NodeBase(kind, l) {}
 
 ProgramDeclarationExpr::~ProgramDeclarationExpr() {}
 
-ProgramDeclaration::ProgramDeclaration(yy::location l,
+ProgramDeclaration::ProgramDeclaration(yy::SourceRange l,
                                        std::vector<std::unique_ptr<ProgramDeclarationExpr>> &&class_declarations) noexcept
-        : NodeBase(l), class_declarations_(std::move(class_declarations)) {}
+        : NodeBase(yy::NodeKind::ProgramDeclaration, l), class_declarations_(std::move(class_declarations)) {}
 
 ProgramDeclaration::~ProgramDeclaration() {}
 
@@ -356,20 +476,24 @@ const std::vector<std::unique_ptr<ProgramDeclarationExpr>> &ProgramDeclaration::
     return class_declarations_;
 }
 
+std::vector<std::unique_ptr<ProgramDeclarationExpr>> ProgramDeclaration::release_class_declarations() noexcept {
+    return std::move(class_declarations_);
+}
+
 void ProgramDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ClassDeclaration::ClassDeclaration(yy::location l, std::string name, std::string parent)
-        : ProgramDeclarationExpr(l), name_(std::move(name)), parent_(std::move(parent)) {}
+ClassDeclaration::ClassDeclaration(yy::SourceRange l, yy::Name name, yy::Name parent)
+        : ProgramDeclarationExpr(yy::NodeKind::ClassDeclaration, l), name_(name), parent_(parent) {}
 
 ClassDeclaration::~ClassDeclaration() {}
 
-const std::string &ClassDeclaration::name() const noexcept {
+yy::Name ClassDeclaration::name() const noexcept {
     return name_;
 }
 
-const std::string &ClassDeclaration::parent() const noexcept {
+yy::Name ClassDeclaration::parent() const noexcept {
     return parent_;
 }
 
@@ -377,9 +501,9 @@ void ClassDeclaration::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-ClassDefinition::ClassDefinition(yy::location l, std::unique_ptr<ClassDeclaration> &&header,
+ClassDefinition::ClassDefinition(yy::SourceRange l, std::unique_ptr<ClassDeclaration> &&header,
                                  std::unique_ptr<MemberDeclaration> &&body) noexcept
-        : ProgramDeclarationExpr(l), header_(std::move(header)), body_(std::move(body)) {}
+        : ProgramDeclarationExpr(yy::NodeKind::ClassDefinition, l), header_(std::move(header)), body_(std::move(body)) {}
 
 ClassDefinition::~ClassDefinition() {}
 
@@ -387,17 +511,25 @@ const ClassDeclaration *ClassDefinition::header() const noexcept {
     return header_.get();
 }
 
+ClassDeclaration *ClassDefinition::header() noexcept {
+    return header_.get();
+}
+
 const MemberDeclaration *ClassDefinition::body() const noexcept {
     return body_.get();
 }
 
+MemberDeclaration *ClassDefinition::body() noexcept {
+    return body_.get();
+}
+
 void ClassDefinition::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
 
-Program::Program(yy::location l, std::unique_ptr<ProgramDeclaration> &&class_declarations,
+Program::Program(yy::SourceRange l, std::unique_ptr<ProgramDeclaration> &&class_declarations,
                  std::unique_ptr<Expr> &&main_class) noexcept
-        : NodeBase(l), class_declarations_(std::move(class_declarations)), main_class_(std::move(main_class)) {}
+        : NodeBase(yy::NodeKind::Program, l), class_declarations_(std::move(class_declarations)), main_class_(std::move(main_class)) {}
 
 Program::~Program() {}
 
@@ -405,10 +537,26 @@ const ProgramDeclaration *Program::class_declarations() const noexcept {
     return class_declarations_.get();
 }
 
+ProgramDeclaration *Program::class_declarations() noexcept {
+    return class_declarations_.get();
+}
+
 const Expr *Program::main_class() const noexcept {
     return main_class_.get();
 }
 
+Expr *Program::main_class() noexcept {
+    return main_class_.get();
+}
+
+std::unique_ptr<ProgramDeclaration> Program::release_class_declarations() noexcept {
+    return std::move(class_declarations_);
+}
+
+std::unique_ptr<Expr> Program::release_main_class() noexcept {
+    return std::move(main_class_);
+}
+
 void Program::do_accept(VisitorBase &visitor) const noexcept {
     visitor(*this);
 }
@@ -0,0 +1,46 @@
+#include "ast/ast_arena.hpp"
+
+namespace {
+    thread_local yy::AstArena *current_arena = nullptr;
+
+    constexpr size_t round_up(size_t size) {
+        constexpr size_t alignment = alignof(std::max_align_t);
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+namespace yy {
+
+    void *AstArena::allocate(size_t size) {
+        size = round_up(size);
+        if (static_cast<size_t>(end_ - next_) < size) {
+            // An oversized request gets a block of its own; the current one stays open.
+            if (size > block_size / 4) {
+                blocks_.emplace_back(new std::byte[size]);
+                ++allocations_;
+                bytes_ += size;
+                return blocks_.back().get();
+            }
+            blocks_.emplace_back(new std::byte[block_size]);
+            next_ = blocks_.back().get();
+            end_ = next_ + block_size;
+        }
+        void *memory = next_;
+        next_ += size;
+        ++allocations_;
+        bytes_ += size;
+        return memory;
+    }
+
+    AstArena *AstArena::current() noexcept {
+        return current_arena;
+    }
+
+    AstArena::Scope::Scope(AstArena *arena) noexcept: previous_(current_arena) {
+        current_arena = arena;
+    }
+
+    AstArena::Scope::~Scope() {
+        current_arena = previous_;
+    }
+}
@@ -0,0 +1,375 @@
+#include "ast/flat_ast.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "visitor/iterative_visitor.hpp"
+
+namespace {
+    using yy::FlatAst;
+    using yy::NodeId;
+    using yy::NodeKind;
+
+    // Adds every node as it is left, so that its children are the nodes added
+    // since it was entered, as the parser's reductions add them.
+    class Flattener : public yy::IterativeVisitor<Flattener> {
+    public:
+        explicit Flattener(FlatAst &ast) : ast_(ast), builder_(ast) {}
+
+        template<class Node>
+        bool enter(const Node &) {
+            children_.push_back(0);
+            return true;
+        }
+
+        template<class Node>
+        void leave(const Node &node) {
+            add(node.kind(), node.location(), payload(node));
+        }
+
+        void leave(const VariableDeclaration &node) {
+            add(NodeKind::Variable, static_cast<const BodyExpr &>(node).location(), ast_.add_names(node.name()));
+        }
+
+    private:
+        void add(NodeKind kind, const yy::SourceRange &location, uint32_t payload) {
+            builder_.reduce(kind, location, children_.back(), payload);
+            children_.pop_back();
+            if (!children_.empty()) {
+                children_.back()++;
+            }
+        }
+
+        template<class Node>
+        uint32_t payload(const Node &) {
+            return 0;
+        }
+
+        uint32_t payload(const BooleanLiteralExpr &node) {
+            return node.value() ? 1 : 0;
+        }
+
+        uint32_t payload(const IntegerLiteralExpr &node) {
+            return static_cast<uint32_t>(node.value());
+        }
+
+        uint32_t payload(const RealLiteralExpr &node) {
+            return ast_.add_real(node.value());
+        }
+
+        uint32_t payload(const StringLiteralExpr &node) {
+            return ast_.add_string(node.value());
+        }
+
+        uint32_t payload(const FieldAccessExpr &node) {
+            return ast_.add_names(node.name());
+        }
+
+        uint32_t payload(const MethodCallExpr &node) {
+            return ast_.add_names(node.name());
+        }
+
+        uint32_t payload(const AssignmentStmt &node) {
+            return ast_.add_names(node.name());
+        }
+
+        uint32_t payload(const ParameterDeclaration &node) {
+            return ast_.add_names(node.name(), node.type());
+        }
+
+        uint32_t payload(const MethodDeclaration &node) {
+            return ast_.add_names(node.name(), node.return_type());
+        }
+
+        uint32_t payload(const ClassDeclaration &node) {
+            return ast_.add_names(node.name(), node.parent());
+        }
+
+        FlatAst &ast_;
+        yy::FlatAstBuilder builder_;
+        // How many children of each node being walked are added.
+        std::vector<uint32_t> children_;
+    };
+
+    // Builds every node as the class its parent holds it as.
+    class Unflattener {
+    public:
+        explicit Unflattener(const FlatAst &ast) : ast_(ast) {}
+
+        std::unique_ptr<Program> program(NodeId node) {
+            expect(node, NodeKind::Program);
+            auto classes = class_list(ast_.child(node, 0));
+            return std::make_unique<Program>(ast_.location(node), std::move(classes), expression(ast_.child(node, 1)));
+        }
+
+    private:
+        std::unique_ptr<ProgramDeclaration> class_list(NodeId node) {
+            expect(node, NodeKind::ProgramDeclaration);
+            std::vector<std::unique_ptr<ProgramDeclarationExpr>> classes;
+            for (NodeId child: ast_.children(node)) {
+                if (ast_.kind(child) == NodeKind::ClassDefinition) {
+                    auto header = class_header(ast_.child(child, 0));
+                    classes.push_back(std::make_unique<ClassDefinition>(
+                            ast_.location(child),
+                            std::move(header),
+                            members(ast_.child(child, 1))
+                    ));
+                } else {
+                    classes.push_back(class_header(child));
+                }
+            }
+            return std::make_unique<ProgramDeclaration>(ast_.location(node), std::move(classes));
+        }
+
+        std::unique_ptr<ClassDeclaration> class_header(NodeId node) {
+            expect(node, NodeKind::ClassDeclaration);
+            return std::make_unique<ClassDeclaration>(ast_.location(node), ast_.name(node), ast_.type(node));
+        }
+
+        std::unique_ptr<MemberDeclaration> members(NodeId node) {
+            expect(node, NodeKind::MemberDeclaration);
+            std::vector<std::unique_ptr<MemberDeclarationExpr>> members;
+            for (NodeId child: ast_.children(node)) {
+                members.push_back(member(child));
+            }
+            return std::make_unique<MemberDeclaration>(ast_.location(node), std::move(members));
+        }
+
+        std::unique_ptr<MemberDeclarationExpr> member(NodeId node) {
+            switch (ast_.kind(node)) {
+                case NodeKind::Variable:
+                    return variable(node);
+                case NodeKind::ConstructorDeclaration:
+                    return constructor_header(node);
+                case NodeKind::ConstructorDefinition: {
+                    auto header = constructor_header(ast_.child(node, 0));
+                    return std::make_unique<ConstructorDefinition>(
+                            ast_.location(node),
+                            std::move(header),
+                            body(ast_.child(node, 1))
+                    );
+                }
+                case NodeKind::MethodDeclaration:
+                    return method_header(node);
+                case NodeKind::MethodDefinition: {
+                    auto header = method_header(ast_.child(node, 0));
+                    return std::make_unique<MethodDefinition>(ast_.location(node), std::move(header), body(ast_.child(node, 1)));
+                }
+                default:
+                    misplaced(node);
+            }
+        }
+
+        std::unique_ptr<ConstructorDeclaration> constructor_header(NodeId node) {
+            expect(node, NodeKind::ConstructorDeclaration);
+            return std::make_unique<ConstructorDeclaration>(ast_.location(node), parameters(node));
+        }
+
+        std::unique_ptr<MethodDeclaration> method_header(NodeId node) {
+            expect(node, NodeKind::MethodDeclaration);
+            return std::make_unique<MethodDeclaration>(ast_.location(node), ast_.name(node), parameters(node), ast_.type(node));
+        }
+
+        std::vector<std::unique_ptr<ParameterDeclaration>> parameters(NodeId node) {
+            std::vector<std::unique_ptr<ParameterDeclaration>> parameters;
+            for (NodeId child: ast_.children(node)) {
+                expect(child, NodeKind::Parameter);
+                parameters.push_back(std::make_unique<ParameterDeclaration>(
+                        ast_.location(child),
+                        ast_.name(child),
+                        ast_.type(child)
+                ));
+            }
+            return parameters;
+        }
+
+        std::unique_ptr<VariableDeclaration> variable(NodeId node) {
+            expect(node, NodeKind::Variable);
+            return std::make_unique<VariableDeclaration>(ast_.location(node), ast_.name(node), expression(ast_.child(node, 0)));
+        }
+
+        std::unique_ptr<Body> body(NodeId node) {
+            expect(node, NodeKind::Body);
+            std::vector<std::unique_ptr<BodyExpr>> expressions;
+            for (NodeId child: ast_.children(node)) {
+                expressions.push_back(body_expression(child));
+            }
+            return std::make_unique<Body>(ast_.location(node), std::move(expressions));
+        }
+
+        std::unique_ptr<BodyExpr> body_expression(NodeId node) {
+            const auto &location = ast_.location(node);
+            switch (ast_.kind(node)) {
+                case NodeKind::Variable:
+                    return variable(node);
+                case NodeKind::Return:
+                    return std::make_unique<ReturnStmt>(location, expression(ast_.child(node, 0)));
+                case NodeKind::Assignment:
+                    return std::make_unique<AssignmentStmt>(location, ast_.name(node), expression(ast_.child(node, 0)));
+                case NodeKind::If: {
+                    auto condition = expression(ast_.child(node, 0));
+                    auto then_body = body(ast_.child(node, 1));
+                    auto else_body = ast_.children(node).size() > 2 ? body(ast_.child(node, 2)) : nullptr;
+                    return std::make_unique<IfStmt>(location, std::move(condition), std::move(then_body), std::move(else_body));
+                }
+                case NodeKind::While: {
+                    auto condition = expression(ast_.child(node, 0));
+                    return std::make_unique<WhileStmt>(location, std::move(condition), body(ast_.child(node, 1)));
+                }
+                default:
+                    return expression(node);
+            }
+        }
+
+        std::unique_ptr<Expr> expression(NodeId node) {
+            const auto &location = ast_.location(node);
+            switch (ast_.kind(node)) {
+                case NodeKind::BooleanLiteral:
+                    return std::make_unique<BooleanLiteralExpr>(location, ast_.boolean(node));
+                case NodeKind::IntegerLiteral:
+                    return std::make_unique<IntegerLiteralExpr>(location, ast_.integer(node));
+                case NodeKind::RealLiteral:
+                    return std::make_unique<RealLiteralExpr>(location, ast_.real(node));
+                case NodeKind::StringLiteral:
+                    return std::make_unique<StringLiteralExpr>(location, ast_.string(node));
+                case NodeKind::This:
+                    return std::make_unique<ThisExpr>(location);
+                default:
+                    return member_access(node);
+            }
+        }
+
+        // Chains are rebuilt from the innermost link out, as they are flattened.
+        std::unique_ptr<MemberAccessExpr> member_access(NodeId node) {
+            std::vector<NodeId> links;
+            for (; ast_.kind(node) == NodeKind::MemberAccess; node = ast_.child(node, 1)) {
+                links.push_back(node);
+            }
+
+            std::unique_ptr<MemberAccessExpr> tail;
+            if (ast_.kind(node) == NodeKind::FieldAccess) {
+                tail = std::make_unique<FieldAccessExpr>(ast_.location(node), ast_.name(node));
+            } else if (ast_.kind(node) == NodeKind::MethodCall) {
+                std::vector<std::unique_ptr<Expr>> arguments;
+                for (NodeId child: ast_.children(node)) {
+                    arguments.push_back(expression(child));
+                }
+                tail = std::make_unique<MethodCallExpr>(ast_.location(node), ast_.name(node), std::move(arguments));
+            } else {
+                misplaced(node);
+            }
+
+            for (size_t i = links.size(); i-- > 0;) {
+                auto lhs = expression(ast_.child(links[i], 0));
+                tail = std::make_unique<MemberAccess>(ast_.location(links[i]), std::move(lhs), std::move(tail));
+            }
+            return tail;
+        }
+
+        void expect(NodeId node, NodeKind kind) const {
+            if (ast_.kind(node) != kind) {
+                misplaced(node);
+            }
+        }
+
+        [[noreturn]] void misplaced(NodeId node) const {
+            throw std::runtime_error(
+                    "Cant unflatten node " + std::to_string(node) + " of kind "
+                    + std::to_string(static_cast<int>(ast_.kind(node))) + " where it is"
+            );
+        }
+
+        const FlatAst &ast_;
+    };
+}
+
+namespace yy {
+
+    NodeId FlatAst::add(NodeKind kind, const SourceRange &location, std::span<const NodeId> children, uint32_t payload) {
+        kinds_.push_back(kind);
+        locations_.push_back(location);
+        first_child_.push_back(static_cast<uint32_t>(children_.size()));
+        child_count_.push_back(static_cast<uint32_t>(children.size()));
+        payloads_.push_back(payload);
+        children_.insert(children_.end(), children.begin(), children.end());
+        return static_cast<NodeId>(kinds_.size() - 1);
+    }
+
+    uint32_t FlatAst::add_names(Name name, Name type) {
+        names_.push_back(name);
+        names_.push_back(type);
+        return static_cast<uint32_t>(names_.size() - 2);
+    }
+
+    uint32_t FlatAst::add_real(double value) {
+        reals_.push_back(value);
+        return static_cast<uint32_t>(reals_.size() - 1);
+    }
+
+    uint32_t FlatAst::add_string(std::string_view value) {
+        strings_.emplace_back(value);
+        return static_cast<uint32_t>(strings_.size() - 1);
+    }
+
+    void FlatAst::walk(FlatVisitor &visitor, NodeId from) const {
+        if (!visitor.enter(*this, from)) {
+            return;
+        }
+        // Every entered node, with the number of the child to enter next.
+        std::vector<std::pair<NodeId, uint32_t>> stack{{from, 0}};
+        while (!stack.empty()) {
+            const auto [node, next] = stack.back();
+            if (next == child_count_[node]) {
+                stack.pop_back();
+                visitor.leave(*this, node);
+                if (!stack.empty()) {
+                    visitor.after(*this, stack.back().first, stack.back().second - 1);
+                }
+                continue;
+            }
+            stack.back().second++;
+            NodeId child = children_[first_child_[node] + next];
+            if (visitor.enter(*this, child)) {
+                stack.emplace_back(child, 0);
+            } else {
+                visitor.after(*this, node, next);
+            }
+        }
+    }
+
+    NodeId FlatAstBuilder::reduce(NodeKind kind, const SourceRange &location, size_t children, uint32_t payload) {
+        const size_t first = pending_.size() - children;
+        NodeId node = ast_.add(kind, location, std::span<const NodeId>(pending_).subspan(first), payload);
+        pending_.resize(first);
+        pending_.push_back(node);
+        return node;
+    }
+
+    NodeId FlatAstBuilder::insert(NodeKind kind, const SourceRange &location, size_t after) {
+        NodeId node = ast_.add(kind, location);
+        pending_.insert(pending_.end() - static_cast<std::ptrdiff_t>(after), node);
+        return node;
+    }
+
+    NodeId FlatAstBuilder::nest_member_access(size_t links) {
+        const SourceLoc end = ast_.location(pending_.back()).end;
+        NodeId node = pending_.back();
+        for (size_t link = 0; link < links; link++) {
+            const SourceLoc begin = ast_.location(pending_[pending_.size() - 2]).begin;
+            node = reduce(NodeKind::MemberAccess, {begin, end}, 2);
+        }
+        return node;
+    }
+
+    FlatAst flatten(const Program &program) {
+        FlatAst ast;
+        Flattener flattener(ast);
+        flattener.visit(program);
+        return ast;
+    }
+
+    std::unique_ptr<Program> unflatten(const FlatAst &ast) {
+        return Unflattener(ast).program(ast.root());
+    }
+}
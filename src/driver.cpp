@@ -3,95 +3,185 @@
 //
 
 #include "driver.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include "ast/ast_arena.hpp"
+#include "ast/flat_ast.hpp"
 #include "lexer/scanner.hpp"
 #include "lexer/buffered_reader.hpp"
+#include "lexer/source_buffer.hpp"
+#include "lexer/parallel_lexer.hpp"
+#include "lexer/token_cache.hpp"
+#include "parser/parallel_parser.hpp"
+#include "parser/recursive_descent_parser.hpp"
 #include "visitor/pretty_print_visitor.hpp"
 #include "semantic/symbol_table.hpp"
-#include "semantic/entrypoint_visitor.hpp"
-#include "semantic/symbol_table_class_collector_visitor.hpp"
-#include "semantic/symbol_table_method_collector_visitor.hpp"
-#include "semantic/symbol_table_visitor.hpp"
+#include "semantic/pass_manager.hpp"
 #include "semantic/symbol_table_index.hpp"
 #include "semantic/semantic_error.hpp"
 #include "stdlib/builtins.hpp"
-#include "semantic/cfa_visitor.hpp"
-#include "semantic/type_checker_visitor.hpp"
-#include "semantic/inheritance_visitor.hpp"
+
+namespace {
+    void store_token_cache(
+            yy::Scanner &scanner,
+            yy::TokenCacheWriter &recorder,
+            const std::string &path,
+            std::string_view source
+    ) {
+        // The parser stops at the first syntax error; lex the rest so the cache covers the whole file.
+        try {
+            while (!recorder.complete() && scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+            }
+        } catch (const yy::parser::syntax_error &) {
+            return;
+        }
+        recorder.write(path, source);
+    }
+}
 
 yy::driver::driver() {
 
 }
 
-static std::string read_file(const std::string &filename) {
-    std::ifstream fin{};
-    fin.open(filename);
-
-    if (!fin.is_open()) {
-        throw std::runtime_error("Cant open file: " + filename);
+bool yy::driver::skip_pass(std::string name) {
+    std::replace(name.begin(), name.end(), '-', ' ');
+    PassManager passes;
+    add_semantic_passes(passes, nullptr, nullptr);
+    auto names = passes.passes();
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+        return false;
     }
-
-    return {
-            std::istreambuf_iterator<char>(fin),
-            std::istreambuf_iterator<char>()
-    };
+    skipped_passes_.push_back(std::move(name));
+    return true;
 }
 
 int yy::driver::parse(const std::string &filename) {
-    yy::Scanner scanner{BufferedReader(read_file(filename)), filename};
+    // The AST is torn down before the arena it lives in.
+    AstArena arena;
+    AstArena::Scope arena_scope(&arena);
+
+    std::optional<SourceBuffer> source;
+    if (!stream_window_) {
+        source = SourceBuffer::open(filename);
+    }
+    yy::Scanner scanner{
+            source ? BufferedReader(source->view()) : BufferedReader::open_stream(filename, stream_window_),
+            filename
+    };
+    scanner.set_trace(&trace_);
+
+    std::string token_cache_file;
+    std::unique_ptr<TokenCacheReader> cached_tokens;
+    TokenCacheWriter token_recorder;
+    if (!token_cache_.empty() && source) {
+        token_cache_file = token_cache_path(token_cache_, source->view());
+        cached_tokens = TokenCacheReader::open(token_cache_file, source->view());
+        if (cached_tokens) {
+            scanner.replay_from(cached_tokens.get());
+        } else {
+            scanner.record_to(&token_recorder);
+        }
+    }
+
+    // Declared first: the classes of the AST may live in the parallel parser's arenas.
+    std::unique_ptr<ParallelParser> parallel_parser;
+    std::unique_ptr<ParallelLexer> parallel_lexer;
     std::unique_ptr<Program> program;
+    FlatAst flat_ast;
+    FlatAstBuilder flat_builder(flat_ast);
+    if (parser_threads_ > 1 && source && !cached_tokens && !trace_.enabled(TraceChannel::Tokens)) {
+        parallel_parser = std::make_unique<ParallelParser>(source->view(), filename, parser_threads_);
+        program = parallel_parser->parse();
+    }
 
-    yy::parser parse(scanner, program);
+    int parse_failure = 0;
+    if (!program) {
+        if (lexer_threads_ > 1 && source && !cached_tokens) {
+            parallel_lexer = std::make_unique<ParallelLexer>(source->view(), lexer_threads_);
+            scanner.replay_from(parallel_lexer.get());
+        }
+
+        if (trace_.enabled(TraceChannel::Tokens)) {
+            trace_.stream() << ":: BEGIN TOKEN SEQUENCE ::\n\n";
+        }
+        parse_failure = parser_ == ParserBackend::RecursiveDescent
+                ? RecursiveDescentParser(scanner, program)()
+                : yy::parser(scanner, program, flat_ast_ ? &flat_builder : nullptr)();
+        if (trace_.enabled(TraceChannel::Tokens)) {
+            trace_.stream() << ":: END TOKEN SEQUENCE ::\n\n";
+        }
+    }
 
-    std::cout << ":: BEGIN TOKEN SEQUENCE ::" << std::endl << std::endl;
-    int parse_failure = parse();
-    std::cout << ":: END TOKEN SEQUENCE ::" << std::endl << std::endl;
+    if (!token_cache_file.empty() && !cached_tokens) {
+        store_token_cache(scanner, token_recorder, token_cache_file, source->view());
+    }
 
     if (parse_failure) {
+        trace_.flush();
         std::cerr << ":: ERROR DURING PARSING ::" << std::endl;
         return parse_failure;
     }
 
-    auto pretty_printer = yy::PrettyPrintVisitor();
-    program->accept(pretty_printer);
-    std::cout << ":: BEGIN DUMP AST NODES  ::" << std::endl << std::endl;
-    std::cout << pretty_printer.output() << std::endl;
-    std::cout << ":: END DUMP AST NODES  ::" << std::endl << std::endl;
+    if (trace_.enabled(TraceChannel::Ast)) {
+        auto pretty_printer = yy::PrettyPrintVisitor();
+        program->accept(pretty_printer);
+        trace_.stream() << ":: BEGIN DUMP AST NODES  ::\n\n";
+        trace_.stream() << pretty_printer.output() << "\n";
+        trace_.stream() << ":: END DUMP AST NODES  ::\n\n";
+    }
+
+    if (!semantic_analysis_) {
+        trace_.flush();
+        return 0;
+    }
 
+    if (flat_ast_ && flat_ast.size() == 0) {
+        flat_ast = flatten(*program);
+    }
 
-    std::cout << ":: BEGIN SEMANTIC ANALYSIS  ::" << std::endl << std::endl;
+    if (trace_.enabled(TraceChannel::Semantic)) {
+        trace_.stream() << ":: BEGIN SEMANTIC ANALYSIS  ::\n\n";
+    }
     std::vector<SemanticError> semantic_errors;
     auto symbol_table_index = std::make_unique<SymbolTableIndex>();
-    auto symbol_table = std::make_unique<SymbolTable>(nullptr, std::unique_ptr<Symbol>());
+    auto symbol_table = std::make_unique<SymbolTable>();
     oppstd::register_builtins(symbol_table.get());
 
-    auto top_table_visitor = SymbolTableClassCollectorVisitor(symbol_table.get(), semantic_errors);
-    program->accept(top_table_visitor);
-
-    auto membre_visitor = SymbolTableMethodCollectorVisitor(symbol_table.get(), semantic_errors);
-    program->accept(membre_visitor);
-
-    auto symbols_visitor = SymbolTableVisitor(symbol_table.get(), symbol_table_index.get(), semantic_errors);
-    program->accept(symbols_visitor);
-
-    auto entrypoint_visitor = EntryPointVisitor( symbol_table_index.get(), semantic_errors);
-    program->accept(entrypoint_visitor);
-
-    auto type_checker_visitor = TypeCheckerVisitor(symbol_table_index.get(), semantic_errors);
-    program->accept(type_checker_visitor);
-
-    auto cfa_visitor = CFAVisitor(semantic_errors);
-    program->accept(cfa_visitor);
-
-    auto inheritance_visitor = InheritanceVisitor(symbol_table_index.get(), semantic_errors);
-    program->accept(inheritance_visitor);
+    PassManager passes;
+    add_semantic_passes(passes, symbol_table.get(), symbol_table_index.get(), flat_ast_ ? &flat_ast : nullptr);
+    passes.set_threads(semantic_threads_);
+    for (auto &name: skipped_passes_) {
+        passes.disable(name);
+    }
+    if (trace_.enabled(TraceChannel::Semantic, TraceLevel::Debug)) {
+        for (auto &name: passes.passes()) {
+            trace_.stream() << "pass " << name << "\n";
+        }
+    }
+    passes.run(*program, semantic_errors);
 
-    std::cout << symbol_table->print_debug_info() << std::endl;
+    if (trace_.enabled(TraceChannel::Symbols)) {
+        trace_.stream() << symbol_table->print_debug_info() << "\n";
+    }
+    // Keep traces ahead of the diagnostics when both end up on a terminal.
+    trace_.flush();
 
     std::for_each(semantic_errors.begin(), semantic_errors.end(), [](auto &error) {
         std::cerr << error << std::endl;
     });
 
-    std::cout << ":: END SEMANTIC ANALYSIS  ::" << std::endl << std::endl;
+    if (trace_.enabled(TraceChannel::Semantic, TraceLevel::Debug)) {
+        trace_.stream() << semantic_errors.size() << " semantic errors\n";
+    }
+    if (trace_.enabled(TraceChannel::Semantic)) {
+        trace_.stream() << ":: END SEMANTIC ANALYSIS  ::\n\n";
+    }
+    trace_.flush();
 
     return 0;
 }
@@ -1,13 +1,56 @@
 #ifndef AST_HPP
 #define AST_HPP
 
-#include "parser/location.hh"
+#include "lexer/source_location.hpp"
+#include "util/name.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <llvm/Support/Casting.h>
+
+namespace yy {
+
+    // The class of a node, for llvm::isa, cast and dyn_cast, which the frontend
+    // uses instead of dynamic_cast: it is built without RTTI. One per class that
+    // is built; every abstract class is a range of them, so the order matters.
+    // VariableDeclaration is both a member and a statement and sits where the
+    // two ranges meet.
+    enum class NodeKind : uint8_t {
+        BooleanLiteral,
+        IntegerLiteral,
+        RealLiteral,
+        StringLiteral,
+        This,
+        FieldAccess,
+        MethodCall,
+        MemberAccess,
+        Return,
+        Assignment,
+        If,
+        While,
+        Variable,
+        ConstructorDeclaration,
+        ConstructorDefinition,
+        MethodDeclaration,
+        MethodDefinition,
+        ClassDeclaration,
+        ClassDefinition,
+        Body,
+        MemberDeclaration,
+        Parameter,
+        ProgramDeclaration,
+        Program,
+    };
+
+    constexpr bool kind_between(NodeKind kind, NodeKind first, NodeKind last) noexcept {
+        return first <= kind && kind <= last;
+    }
+}
+
 class VisitorBase;
 
 template<class T>
@@ -20,15 +63,28 @@ public:
     template<class T>
     T accept(Visitor<T> &visitor) const noexcept;
 
-    yy::location location() const noexcept;
+    yy::NodeKind kind() const noexcept {
+        return kind_;
+    }
+
+    yy::SourceRange location() const noexcept;
+
+    // Moves the node, but not its children, e.g. after an edit in front of it.
+    void relocate(yy::SourceRange l) noexcept;
+
+    // From the thread's yy::AstArena if one is in scope, else from the heap.
+    static void *operator new(size_t size);
+
+    static void operator delete(void *node) noexcept;
 
 protected:
-    NodeBase(yy::location l) noexcept;
+    NodeBase(yy::NodeKind kind, yy::SourceRange l) noexcept;
 
     virtual void do_accept(VisitorBase &visitor) const noexcept = 0;
 
 private:
-    yy::location location_;
+    yy::SourceRange location_;
+    yy::NodeKind kind_;
 };
 
 class BodyExpr : public NodeBase {
@@ -36,18 +92,26 @@ public:
 
     ~BodyExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::BooleanLiteral, yy::NodeKind::Variable);
+    }
+
 protected:
-    BodyExpr(yy::location l) noexcept;
+    BodyExpr(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class Body : public NodeBase {
 public:
-    Body(yy::location l, std::vector<std::unique_ptr<BodyExpr>> &&expressions) noexcept;
+    Body(yy::SourceRange l, std::vector<std::unique_ptr<BodyExpr>> &&expressions) noexcept;
 
     const std::vector<std::unique_ptr<BodyExpr>> &expressions() const noexcept;
 
     ~Body() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::Body;
+    }
+
 private:
     std::vector<std::unique_ptr<BodyExpr>> expressions_;
 
@@ -59,8 +123,12 @@ public:
     ~Expr() override;
 
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::BooleanLiteral, yy::NodeKind::MemberAccess);
+    }
+
 protected:
-    Expr(yy::location l) noexcept;
+    Expr(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class PrimaryExpr : public Expr {
@@ -68,18 +136,26 @@ public:
 
     ~PrimaryExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::BooleanLiteral, yy::NodeKind::This);
+    }
+
 protected:
-    PrimaryExpr(yy::location l) noexcept;
+    PrimaryExpr(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class BooleanLiteralExpr : public PrimaryExpr {
 public:
-    BooleanLiteralExpr(yy::location l, bool value) noexcept;
+    BooleanLiteralExpr(yy::SourceRange l, bool value) noexcept;
 
     bool value() const noexcept;
 
     ~BooleanLiteralExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::BooleanLiteral;
+    }
+
 private:
     bool value_;
 
@@ -88,12 +164,16 @@ private:
 
 class IntegerLiteralExpr : public PrimaryExpr {
 public:
-    IntegerLiteralExpr(yy::location l, int value) noexcept;
+    IntegerLiteralExpr(yy::SourceRange l, int value) noexcept;
 
     int value() const;
 
     ~IntegerLiteralExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::IntegerLiteral;
+    }
+
 private:
     int value_;
 
@@ -102,12 +182,16 @@ private:
 
 class RealLiteralExpr : public PrimaryExpr {
 public:
-    RealLiteralExpr(yy::location l, double value) noexcept;
+    RealLiteralExpr(yy::SourceRange l, double value) noexcept;
 
     double value() const noexcept;
 
     ~RealLiteralExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::RealLiteral;
+    }
+
 private:
     double value_;
 
@@ -116,12 +200,16 @@ private:
 
 class StringLiteralExpr : public PrimaryExpr {
 public:
-    StringLiteralExpr(const yy::location &l, const std::string &value) noexcept;
+    StringLiteralExpr(const yy::SourceRange &l, const std::string &value) noexcept;
 
     const std::string &value() const;
 
     ~StringLiteralExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::StringLiteral;
+    }
+
 private:
     std::string value_;
 
@@ -130,10 +218,14 @@ private:
 
 class ThisExpr : public PrimaryExpr {
 public:
-    ThisExpr(yy::location l) noexcept;
+    ThisExpr(yy::SourceRange l) noexcept;
 
     ~ThisExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::This;
+    }
+
 private:
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
@@ -143,36 +235,48 @@ public:
 
     ~MemberAccessExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::FieldAccess, yy::NodeKind::MemberAccess);
+    }
+
 protected:
-    MemberAccessExpr(yy::location l) noexcept;
+    MemberAccessExpr(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class FieldAccessExpr : public MemberAccessExpr {
 public:
-    FieldAccessExpr(const yy::location &l, const std::string &name) noexcept;
+    FieldAccessExpr(const yy::SourceRange &l, yy::Name name) noexcept;
 
-    const std::string &name() const;
+    yy::Name name() const;
 
     ~FieldAccessExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::FieldAccess;
+    }
+
 private:
-    std::string name_;
+    yy::Name name_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
 
 class MethodCallExpr : public MemberAccessExpr {
 public:
-    MethodCallExpr(const yy::location &l, const std::string &name, std::vector<std::unique_ptr<Expr>> &&arguments);
+    MethodCallExpr(const yy::SourceRange &l, yy::Name name, std::vector<std::unique_ptr<Expr>> &&arguments);
 
-    const std::string &name() const noexcept;
+    yy::Name name() const noexcept;
 
     const std::vector<std::unique_ptr<Expr>> &arguments() const noexcept;
 
     ~MethodCallExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::MethodCall;
+    }
+
 private:
-    std::string name_;
+    yy::Name name_;
     std::vector<std::unique_ptr<Expr>> arguments_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
@@ -180,14 +284,22 @@ private:
 
 class MemberAccess : public MemberAccessExpr {
 public:
-    MemberAccess(yy::location l, std::unique_ptr<Expr> &&lhs, std::unique_ptr<MemberAccessExpr> &&rhs) noexcept;
+    MemberAccess(yy::SourceRange l, std::unique_ptr<Expr> &&lhs, std::unique_ptr<MemberAccessExpr> &&rhs) noexcept;
 
     const Expr *lhs() const noexcept;
 
+    Expr *lhs() noexcept;
+
     const MemberAccessExpr *rhs() const noexcept;
 
+    MemberAccessExpr *rhs() noexcept;
+
     ~MemberAccess() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::MemberAccess;
+    }
+
 private:
     std::unique_ptr<Expr> lhs_;
     std::unique_ptr<MemberAccessExpr> rhs_;
@@ -200,18 +312,28 @@ public:
 
     ~Stmt() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::Return, yy::NodeKind::While);
+    }
+
 protected:
-    Stmt(yy::location l) noexcept;
+    Stmt(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class ReturnStmt : public Stmt {
 public:
-    ReturnStmt(yy::location l, std::unique_ptr<Expr> &&expression) noexcept;
+    ReturnStmt(yy::SourceRange l, std::unique_ptr<Expr> &&expression) noexcept;
 
     const Expr *expression() const noexcept;
 
+    Expr *expression() noexcept;
+
     ~ReturnStmt() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::Return;
+    }
+
 private:
     std::unique_ptr<Expr> expression_;
 
@@ -220,16 +342,22 @@ private:
 
 class AssignmentStmt : public Stmt {
 public:
-    AssignmentStmt(yy::location l, std::string name, std::unique_ptr<Expr> &&expression);
+    AssignmentStmt(yy::SourceRange l, yy::Name name, std::unique_ptr<Expr> &&expression);
 
-    const std::string &name() const noexcept;
+    yy::Name name() const noexcept;
 
     const Expr *expression() const noexcept;
 
+    Expr *expression() noexcept;
+
     ~AssignmentStmt() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::Assignment;
+    }
+
 private:
-    std::string name_;
+    yy::Name name_;
     std::unique_ptr<Expr> expression_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
@@ -237,39 +365,61 @@ private:
 
 class IfStmt : public Stmt {
 public:
-    IfStmt(yy::location l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&then_body,
+    IfStmt(yy::SourceRange l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&then_body,
            std::unique_ptr<Body> &&else_body = nullptr) noexcept;
 
     const Expr *condition() const noexcept;
 
+    Expr *condition() noexcept;
+
     const Body *then_body() const noexcept;
 
+    Body *then_body() noexcept;
+
     const Body *else_body() const noexcept;
 
+    Body *else_body() noexcept;
+
     ~IfStmt() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::If;
+    }
+
 private:
     std::unique_ptr<Expr> condition_;
     std::unique_ptr<Body> then_body_;
     std::unique_ptr<Body> else_body_;
 
+    friend class Body;
+
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
 
 class WhileStmt : public Stmt {
 public:
-    WhileStmt(yy::location l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&loop_body) noexcept;
+    WhileStmt(yy::SourceRange l, std::unique_ptr<Expr> &&condition, std::unique_ptr<Body> &&loop_body) noexcept;
 
     const Expr *condition() const noexcept;
 
+    Expr *condition() noexcept;
+
     const Body *loop_body() const noexcept;
 
+    Body *loop_body() noexcept;
+
     ~WhileStmt() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::While;
+    }
+
 private:
     std::unique_ptr<Expr> condition_;
     std::unique_ptr<Body> loop_body_;
 
+    friend class Body;
+
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
 
@@ -278,19 +428,27 @@ public:
 
     ~MemberDeclarationExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::Variable, yy::NodeKind::MethodDefinition);
+    }
+
 protected:
-    MemberDeclarationExpr(yy::location l) noexcept;
+    MemberDeclarationExpr(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class MemberDeclaration : public NodeBase {
 public:
-    MemberDeclaration(yy::location l,
+    MemberDeclaration(yy::SourceRange l,
                       std::vector<std::unique_ptr<MemberDeclarationExpr>> &&member_declarations) noexcept;
 
     const std::vector<std::unique_ptr<MemberDeclarationExpr>> &member_declarations() const noexcept;
 
     ~MemberDeclaration() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::MemberDeclaration;
+    }
+
 private:
     std::vector<std::unique_ptr<MemberDeclarationExpr>> member_declarations_;
 
@@ -299,33 +457,46 @@ private:
 
 class ParameterDeclaration : public NodeBase {
 public:
-    ParameterDeclaration(yy::location l, std::string name, std::string type);
+    ParameterDeclaration(yy::SourceRange l, yy::Name name, yy::Name type);
 
-    const std::string &name() const noexcept;
+    yy::Name name() const noexcept;
 
-    const std::string &type() const noexcept;
+    yy::Name type() const noexcept;
 
     ~ParameterDeclaration() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::Parameter;
+    }
+
 private:
-    std::string name_;
-    std::string type_;
+    yy::Name name_;
+    yy::Name type_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
 
 class VariableDeclaration : public MemberDeclarationExpr, public BodyExpr {
 public:
-    VariableDeclaration(yy::location l, std::string name, std::unique_ptr<Expr> &&initializer);
+    VariableDeclaration(yy::SourceRange l, yy::Name name, std::unique_ptr<Expr> &&initializer);
 
-    const std::string &name() const noexcept;
+    yy::Name name() const noexcept;
 
     const Expr *initializer() const noexcept;
 
+    Expr *initializer() noexcept;
+
     ~VariableDeclaration() override;
 
+    // Cast from a BodyExpr or a MemberDeclarationExpr: NodeBase is an ambiguous
+    // base. For the same reason, a NodeBase that is a variable may only be cast
+    // to the one of the two it was stored as.
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::Variable;
+    }
+
 private:
-    std::string name_;
+    yy::Name name_;
     std::unique_ptr<Expr> initializer_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
@@ -333,12 +504,16 @@ private:
 
 class ConstructorDeclaration : public MemberDeclarationExpr {
 public:
-    ConstructorDeclaration(yy::location l, std::vector<std::unique_ptr<ParameterDeclaration>> &&parameters) noexcept;
+    ConstructorDeclaration(yy::SourceRange l, std::vector<std::unique_ptr<ParameterDeclaration>> &&parameters) noexcept;
 
     const std::vector<std::unique_ptr<ParameterDeclaration>> &parameters() const noexcept;
 
     ~ConstructorDeclaration() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::ConstructorDeclaration;
+    }
+
 private:
     std::vector<std::unique_ptr<ParameterDeclaration>> parameters_;
 
@@ -347,15 +522,23 @@ private:
 
 class ConstructorDefinition : public MemberDeclarationExpr {
 public:
-    ConstructorDefinition(yy::location l, std::unique_ptr<ConstructorDeclaration> &&header,
+    ConstructorDefinition(yy::SourceRange l, std::unique_ptr<ConstructorDeclaration> &&header,
                           std::unique_ptr<Body> &&body) noexcept;
 
     const ConstructorDeclaration *header() const noexcept;
 
+    ConstructorDeclaration *header() noexcept;
+
     const Body *body() const noexcept;
 
+    Body *body() noexcept;
+
     ~ConstructorDefinition() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::ConstructorDefinition;
+    }
+
 private:
     std::unique_ptr<ConstructorDeclaration> header_;
     std::unique_ptr<Body> body_;
@@ -365,36 +548,48 @@ private:
 
 class MethodDeclaration : public MemberDeclarationExpr {
 public:
-    MethodDeclaration(yy::location l, std::string name, std::vector<std::unique_ptr<ParameterDeclaration>> &&parameters,
-                      std::string return_type = "");
+    MethodDeclaration(yy::SourceRange l, yy::Name name, std::vector<std::unique_ptr<ParameterDeclaration>> &&parameters,
+                      yy::Name return_type = {});
 
-    const std::string &name() const noexcept;
+    yy::Name name() const noexcept;
 
     const std::vector<std::unique_ptr<ParameterDeclaration>> &parameters() const noexcept;
 
-    const std::string &return_type() const noexcept;
+    yy::Name return_type() const noexcept;
 
     ~MethodDeclaration() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::MethodDeclaration;
+    }
+
 private:
-    std::string name_;
+    yy::Name name_;
     std::vector<std::unique_ptr<ParameterDeclaration>> parameters_;
-    std::string return_type_;
+    yy::Name return_type_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
 
 class MethodDefinition : public MemberDeclarationExpr {
 public:
-    MethodDefinition(yy::location l, std::unique_ptr<MethodDeclaration> &&header,
+    MethodDefinition(yy::SourceRange l, std::unique_ptr<MethodDeclaration> &&header,
                      std::unique_ptr<Body> &&body) noexcept;
 
     const MethodDeclaration *header() const noexcept;
 
+    MethodDeclaration *header() noexcept;
+
     const Body *body() const noexcept;
 
+    Body *body() noexcept;
+
     ~MethodDefinition() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::MethodDefinition;
+    }
+
 private:
     std::unique_ptr<MethodDeclaration> header_;
     std::unique_ptr<Body> body_;
@@ -407,19 +602,30 @@ public:
 
     ~ProgramDeclarationExpr() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return yy::kind_between(node->kind(), yy::NodeKind::ClassDeclaration, yy::NodeKind::ClassDefinition);
+    }
+
 protected:
-    ProgramDeclarationExpr(yy::location l) noexcept;
+    ProgramDeclarationExpr(yy::NodeKind kind, yy::SourceRange l) noexcept;
 };
 
 class ProgramDeclaration : public NodeBase {
 public:
-    ProgramDeclaration(yy::location l,
+    ProgramDeclaration(yy::SourceRange l,
                        std::vector<std::unique_ptr<ProgramDeclarationExpr>> &&class_declarations) noexcept;
 
     const std::vector<std::unique_ptr<ProgramDeclarationExpr>> &class_declarations() const noexcept;
 
+    // Hands the classes over, e.g. to the declarations rebuilt after an edit.
+    std::vector<std::unique_ptr<ProgramDeclarationExpr>> release_class_declarations() noexcept;
+
     ~ProgramDeclaration() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::ProgramDeclaration;
+    }
+
 private:
     std::vector<std::unique_ptr<ProgramDeclarationExpr>> class_declarations_;
 
@@ -428,32 +634,44 @@ private:
 
 class ClassDeclaration : public ProgramDeclarationExpr {
 public:
-    ClassDeclaration(yy::location l, std::string name, std::string parent = "");
+    ClassDeclaration(yy::SourceRange l, yy::Name name, yy::Name parent = {});
 
-    const std::string &name() const noexcept;
+    yy::Name name() const noexcept;
 
-    const std::string &parent() const noexcept;
+    yy::Name parent() const noexcept;
 
     ~ClassDeclaration() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::ClassDeclaration;
+    }
+
 private:
-    std::string name_;
-    std::string parent_;
+    yy::Name name_;
+    yy::Name parent_;
 
     void do_accept(VisitorBase &visitor) const noexcept override;
 };
 
 class ClassDefinition : public ProgramDeclarationExpr {
 public:
-    ClassDefinition(yy::location l, std::unique_ptr<ClassDeclaration> &&header,
+    ClassDefinition(yy::SourceRange l, std::unique_ptr<ClassDeclaration> &&header,
                     std::unique_ptr<MemberDeclaration> &&body) noexcept;
 
     const ClassDeclaration *header() const noexcept;
 
+    ClassDeclaration *header() noexcept;
+
     const MemberDeclaration *body() const noexcept;
 
+    MemberDeclaration *body() noexcept;
+
     ~ClassDefinition() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::ClassDefinition;
+    }
+
 private:
     std::unique_ptr<ClassDeclaration> header_;
     std::unique_ptr<MemberDeclaration> body_;
@@ -463,15 +681,27 @@ private:
 
 class Program : public NodeBase {
 public:
-    Program(yy::location l, std::unique_ptr<ProgramDeclaration> &&class_declarations,
+    Program(yy::SourceRange l, std::unique_ptr<ProgramDeclaration> &&class_declarations,
             std::unique_ptr<Expr> &&main_class) noexcept;
 
     const ProgramDeclaration *class_declarations() const noexcept;
 
+    ProgramDeclaration *class_declarations() noexcept;
+
     const Expr *main_class() const noexcept;
 
+    Expr *main_class() noexcept;
+
+    std::unique_ptr<ProgramDeclaration> release_class_declarations() noexcept;
+
+    std::unique_ptr<Expr> release_main_class() noexcept;
+
     ~Program() override;
 
+    static bool classof(const NodeBase *node) noexcept {
+        return node->kind() == yy::NodeKind::Program;
+    }
+
 private:
     std::unique_ptr<ProgramDeclaration> class_declarations_;
     std::unique_ptr<Expr> main_class_;
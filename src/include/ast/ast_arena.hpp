@@ -0,0 +1,68 @@
+#ifndef OPP_FRONTEND_AST_ARENA_HPP
+#define OPP_FRONTEND_AST_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace yy {
+
+    // A bump allocator for the AST of one compilation.
+    //
+    // While a Scope is open on a thread, every node built there is placed in its
+    // arena, one behind the other in the order the parser builds them, and
+    // deleting one only runs its destructor. The memory goes back in one piece
+    // when the arena is destroyed, so the arena must outlive its nodes. Nodes
+    // built outside of any scope come from the heap as before.
+    //
+    // An arena is not thread safe; give every thread that builds nodes its own.
+    class AstArena {
+    public:
+        static constexpr size_t block_size = 64 << 10;
+
+        AstArena() = default;
+
+        AstArena(const AstArena &) = delete;
+
+        AstArena &operator=(const AstArena &) = delete;
+
+        void *allocate(size_t size);
+
+        // How many allocations the arena served, and how many bytes they took.
+        size_t allocations() const noexcept {
+            return allocations_;
+        }
+
+        size_t bytes() const noexcept {
+            return bytes_;
+        }
+
+        // Where the nodes built on this thread go; null for the heap.
+        static AstArena *current() noexcept;
+
+        // Sends the nodes built on this thread to `arena`, or with null to the
+        // heap, until the scope closes.
+        class Scope {
+        public:
+            explicit Scope(AstArena *arena) noexcept;
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+            ~Scope();
+
+        private:
+            AstArena *previous_;
+        };
+
+    private:
+        std::vector<std::unique_ptr<std::byte[]>> blocks_;
+        std::byte *next_ = nullptr;
+        std::byte *end_ = nullptr;
+        size_t allocations_ = 0;
+        size_t bytes_ = 0;
+    };
+}
+
+#endif //OPP_FRONTEND_AST_ARENA_HPP
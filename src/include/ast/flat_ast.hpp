@@ -0,0 +1,177 @@
+#ifndef OPP_FRONTEND_FLAT_AST_HPP
+#define OPP_FRONTEND_FLAT_AST_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "lexer/source_location.hpp"
+#include "util/name.hpp"
+
+namespace yy {
+
+    // A node of a FlatAst: its index in every one of the arrays.
+    using NodeId = uint32_t;
+
+    class FlatVisitor;
+
+    // The AST as a struct of arrays, for passes that walk all of it.
+    //
+    // Every node is a kind, a location, a range of the shared child list and a
+    // 32 bit payload, each in an array of its own, so a walk that only looks at
+    // kinds reads one byte per node. Children are in the order the classes of
+    // ast.hpp hand them out; an if has two or three. The payload is the value
+    // of a boolean or integer literal, or an index: into the reals, the strings,
+    // or the names, where a node with two names has them one behind the other.
+    //
+    // Nodes are added children first, as a parser reduces them, so the root is
+    // the last node. The bison parser builds one beside the Program when it is
+    // handed a FlatAstBuilder; flatten() makes one of a Program otherwise.
+    class FlatAst {
+    public:
+        NodeId add(NodeKind kind, const SourceRange &location, std::span<const NodeId> children, uint32_t payload = 0);
+
+        NodeId add(NodeKind kind, const SourceRange &location, std::initializer_list<NodeId> children = {},
+                   uint32_t payload = 0) {
+            return add(kind, location, std::span<const NodeId>(children.begin(), children.size()), payload);
+        }
+
+        // Payloads.
+
+        uint32_t add_names(Name name, Name type = {});
+
+        uint32_t add_real(double value);
+
+        uint32_t add_string(std::string_view value);
+
+        size_t size() const noexcept {
+            return kinds_.size();
+        }
+
+        NodeId root() const noexcept {
+            return static_cast<NodeId>(kinds_.size() - 1);
+        }
+
+        NodeKind kind(NodeId node) const noexcept {
+            return kinds_[node];
+        }
+
+        const SourceRange &location(NodeId node) const noexcept {
+            return locations_[node];
+        }
+
+        std::span<const NodeId> children(NodeId node) const noexcept {
+            return {children_.data() + first_child_[node], child_count_[node]};
+        }
+
+        NodeId child(NodeId node, uint32_t index) const noexcept {
+            return children_[first_child_[node] + index];
+        }
+
+        bool boolean(NodeId node) const noexcept {
+            return payloads_[node] != 0;
+        }
+
+        int integer(NodeId node) const noexcept {
+            return static_cast<int>(payloads_[node]);
+        }
+
+        double real(NodeId node) const noexcept {
+            return reals_[payloads_[node]];
+        }
+
+        const std::string &string(NodeId node) const noexcept {
+            return strings_[payloads_[node]];
+        }
+
+        Name name(NodeId node) const noexcept {
+            return names_[payloads_[node]];
+        }
+
+        // The type of a parameter, the return type of a method, the parent of a class.
+        Name type(NodeId node) const noexcept {
+            return names_[payloads_[node] + 1];
+        }
+
+        // From the root, children in order. Iterative, so bodies and chains of
+        // any depth take no stack.
+        void walk(FlatVisitor &visitor) const {
+            if (!kinds_.empty()) {
+                walk(visitor, root());
+            }
+        }
+
+        // The same from `node`, e.g. one class of the program.
+        void walk(FlatVisitor &visitor, NodeId node) const;
+
+    private:
+        std::vector<NodeKind> kinds_;
+        std::vector<SourceRange> locations_;
+        std::vector<uint32_t> first_child_;
+        std::vector<uint32_t> child_count_;
+        std::vector<uint32_t> payloads_;
+        std::vector<NodeId> children_;
+        std::vector<Name> names_;
+        std::vector<double> reals_;
+        std::vector<std::string> strings_;
+    };
+
+    class FlatVisitor {
+    public:
+        // Before the children of `node`; false skips them, and leave().
+        virtual bool enter(const FlatAst &ast, NodeId node) = 0;
+
+        // Once child number `child` of `node` is done, entered or not.
+        virtual void after(const FlatAst &, NodeId, uint32_t) {}
+
+        // After the children of `node`.
+        virtual void leave(const FlatAst &, NodeId) {}
+
+        virtual ~FlatVisitor() = default;
+    };
+
+    // Adds nodes to a FlatAst in the order a parser reduces them: a node takes
+    // the nodes added last, and not taken yet, as its children.
+    class FlatAstBuilder {
+    public:
+        explicit FlatAstBuilder(FlatAst &ast) : ast_(ast) {}
+
+        FlatAst &ast() noexcept {
+            return ast_;
+        }
+
+        // A node whose children are the last `children` nodes not taken yet.
+        NodeId reduce(NodeKind kind, const SourceRange &location, size_t children = 0, uint32_t payload = 0);
+
+        // The same, with a name and the type it has, if any, as the payload.
+        NodeId reduce(NodeKind kind, const SourceRange &location, size_t children, Name name, Name type = {}) {
+            return reduce(kind, location, children, ast_.add_names(name, type));
+        }
+
+        // A node without children, put before the last `after` nodes not taken
+        // yet: `this` where the parser makes it up for a call.
+        NodeId insert(NodeKind kind, const SourceRange &location, size_t after);
+
+        // The last `links` nodes not taken yet but one, each with all that
+        // follows it, as nest_member_access() nests them.
+        NodeId nest_member_access(size_t links);
+
+    private:
+        FlatAst &ast_;
+        std::vector<NodeId> pending_;
+    };
+
+    // Converters for the passes that still take the classes of ast.hpp. The
+    // program's nodes come from the AstArena in scope, as the parsers' do.
+
+    FlatAst flatten(const Program &program);
+
+    std::unique_ptr<Program> unflatten(const FlatAst &ast);
+}
+
+#endif //OPP_FRONTEND_FLAT_AST_HPP
@@ -8,15 +8,91 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <vector>
 #include "parser/parser.tab.hpp"
+#include "util/trace.hpp"
 
 namespace yy {
+    enum class ParserBackend {
+        Bison,
+        RecursiveDescent,
+    };
+
     class driver {
     public:
         driver();
         int parse(const std::string &filename);
+
+        // Everything parse used to dump to stdout now goes through here; off by default.
+        Trace &trace() {
+            return trace_;
+        }
+
+        // Replay tokens of unchanged files from .optok files in `directory`, and
+        // store them there on a miss. Empty, the default, lexes every time.
+        void set_token_cache(std::string directory) {
+            token_cache_ = std::move(directory);
+        }
+
+        // Lex on this many threads, cutting the file at top-level classes; 1, the
+        // default, lexes serially.
+        void set_lexer_threads(unsigned threads) {
+            lexer_threads_ = threads;
+        }
+
+        // Read the input, e.g. a pipe, through a sliding window of `window` bytes
+        // instead of all at once; 0, the default, reads it whole. Streamed input
+        // is neither cached nor lexed in parallel, both need all of the text.
+        void set_stream_window(size_t window) {
+            stream_window_ = window;
+        }
+
+        // Which of the two parsers builds the AST; both build the same one.
+        void set_parser(ParserBackend backend) {
+            parser_ = backend;
+        }
+
+        // Parse the top-level classes on this many threads, with the recursive
+        // descent parser; 1, the default, parses serially. A file that cannot be
+        // cut, or does not parse, is parsed again serially by the parser set above.
+        // Replayed, traced and streamed tokens are always parsed serially.
+        void set_parser_threads(unsigned threads) {
+            parser_threads_ = threads;
+        }
+
+        // Off, parse stops after the AST; no semantic pass runs.
+        void set_semantic_analysis(bool analysis) {
+            semantic_analysis_ = analysis;
+        }
+
+        // Skip the semantic pass `name`, as the semantic trace names it or with
+        // hyphens for its spaces, and the passes that need what it finds; false
+        // if there is no such pass.
+        bool skip_pass(std::string name);
+
+        // Have the bison parser build the FlatAst beside the AST, or flatten the
+        // AST the other parsers build, and run control flow on it.
+        void set_flat_ast(bool flat) {
+            flat_ast_ = flat;
+        }
+
+        // Run semantic passes that do not wait for each other on this many
+        // threads; 1, the default, runs them one after the other.
+        void set_semantic_threads(unsigned threads) {
+            semantic_threads_ = threads;
+        }
     private:
         yy::location location;
+        Trace trace_;
+        std::string token_cache_;
+        unsigned lexer_threads_ = 1;
+        size_t stream_window_ = 0;
+        ParserBackend parser_ = ParserBackend::Bison;
+        unsigned parser_threads_ = 1;
+        bool semantic_analysis_ = true;
+        std::vector<std::string> skipped_passes_;
+        unsigned semantic_threads_ = 1;
+        bool flat_ast_ = false;
     };
 }
 
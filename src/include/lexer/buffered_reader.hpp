@@ -6,7 +6,8 @@
 #define OPP_FRONTEND_BUFFERED_READER_HPP
 
 #include <string>
-#include <fstream>
+#include <string_view>
+#include <memory>
 #include <cstddef>
 
 namespace yy {
@@ -14,23 +15,97 @@ namespace yy {
     public:
         constexpr static char nPos = -1;
 
+        constexpr static size_t default_window = 1 << 20;
+
+        // Takes ownership of the program text.
         explicit BufferedReader(std::string buffer);
 
+        // Reads the text in place, e.g. a mapped SourceBuffer; the caller keeps it alive.
+        explicit BufferedReader(std::string_view buffer) noexcept;
+
+        // Reads `fd`, e.g. a pipe or stdin, through a window of `window` bytes that
+        // slides over the input, so memory stays flat however long the input is.
+        // Tokens must be shorter than half the window. The descriptor stays open.
+        static BufferedReader stream(int fd, size_t window = default_window);
+
+        // Streams the file at `path`, or stdin for "-".
+        static BufferedReader open_stream(const std::string &path, size_t window = default_window);
+
+        BufferedReader(BufferedReader &&other) noexcept;
+
+        BufferedReader &operator=(BufferedReader &&other) noexcept;
+
+        ~BufferedReader();
+
         size_t offset() const;
 
         char peek() const;
 
         char advance();
 
-        const std::string &content() const;
+        std::string_view content() const;
+
+        std::string_view substring(size_t start, size_t delta) const;
+
+        bool eof() const {
+            return offset_ >= buffer_.size();
+        }
 
-        std::string substring(size_t start, size_t delta) const;
+        // Raw access for the bulk scanning kernels; inline, the scanner calls these per token.
+        const char *cursor() const noexcept {
+            return buffer_.data() + offset_;
+        }
 
-        bool eof() const;
+        const char *end() const noexcept {
+            return buffer_.data() + buffer_.size();
+        }
+
+        void seek(const char *cursor) noexcept {
+            offset_ = cursor - buffer_.data();
+        }
+
+        // Where `at`, a pointer into the window, is in the whole input.
+        size_t input_offset(const char *at) const noexcept {
+            return window_offset_ + (at - buffer_.data());
+        }
+
+        bool streaming() const noexcept {
+            return stream_ != nullptr;
+        }
+
+        // Streaming: the next token may not fit into what is left of the window.
+        bool needs_refill() const noexcept {
+            return offset_ >= refill_at_;
+        }
+
+        // Moves the unread rest of the window to its front and fills it up from
+        // the input; pointers into the window are invalid afterwards.
+        void refill();
+
+        // Whether the end of the text is the end of the input.
+        bool exhausted() const noexcept;
+
+        // `text` from the window as a view that outlives it: a copy, kept once
+        // per distinct text, when streaming, `text` itself otherwise.
+        std::string_view stable(std::string_view text) {
+            if (stream_) [[unlikely]] {
+                return save(text);
+            }
+            return text;
+        }
 
     private:
+        struct Stream;
+
+        std::string_view save(std::string_view text);
+
         size_t offset_ = 0;
-        std::string buffer_{};
+        // Streaming: the bytes of the input that slid out of the window.
+        size_t window_offset_ = 0;
+        size_t refill_at_ = static_cast<size_t>(-1);
+        std::unique_ptr<const std::string> storage_{};
+        std::unique_ptr<Stream> stream_{};
+        std::string_view buffer_{};
     };
 }
 
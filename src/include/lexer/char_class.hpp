@@ -0,0 +1,89 @@
+#ifndef OPP_FRONTEND_CHAR_CLASS_HPP
+#define OPP_FRONTEND_CHAR_CLASS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace yy {
+
+    // Lexical class of a byte. The order matters: the predicates below are
+    // range checks, so specials, then whitespace, must stay contiguous.
+    enum class CharClass : uint8_t {
+        Other,
+        Lower,
+        Digit,
+        Quote,
+        Dot,
+        Colon,
+        Equals,
+        Greater,
+        LeftParen,
+        RightParen,
+        LeftBracket,
+        RightBracket,
+        Comma,
+        Space,
+        Newline,
+        // Never stored in the table; the lexer feeds it at the end of input.
+        Eof,
+    };
+
+    inline constexpr size_t char_class_count = static_cast<size_t>(CharClass::Eof) + 1;
+
+    namespace detail {
+        constexpr std::array<CharClass, 256> make_char_classes() {
+            std::array<CharClass, 256> table{};
+            for (int c = 'a'; c <= 'z'; c++) {
+                table[c] = CharClass::Lower;
+            }
+            for (int c = '0'; c <= '9'; c++) {
+                table[c] = CharClass::Digit;
+            }
+            table['\''] = CharClass::Quote;
+            table['.'] = CharClass::Dot;
+            table[':'] = CharClass::Colon;
+            table['='] = CharClass::Equals;
+            table['>'] = CharClass::Greater;
+            table['('] = CharClass::LeftParen;
+            table[')'] = CharClass::RightParen;
+            table['['] = CharClass::LeftBracket;
+            table[']'] = CharClass::RightBracket;
+            table[','] = CharClass::Comma;
+            table[' '] = CharClass::Space;
+            table['\t'] = CharClass::Space;
+            table['\r'] = CharClass::Space;
+            table['\n'] = CharClass::Newline;
+            return table;
+        }
+    }
+
+    inline constexpr std::array<CharClass, 256> char_classes = detail::make_char_classes();
+
+    constexpr CharClass char_class(char peek) noexcept {
+        return char_classes[static_cast<unsigned char>(peek)];
+    }
+
+    constexpr bool is_special(char peek) noexcept {
+        CharClass c = char_class(peek);
+        return c >= CharClass::Dot && c <= CharClass::Comma;
+    }
+
+    constexpr bool is_whitespace(char peek) noexcept {
+        CharClass c = char_class(peek);
+        return c == CharClass::Space || c == CharClass::Newline;
+    }
+
+    // Ends identifiers and keywords.
+    constexpr bool is_spliterator(char peek) noexcept {
+        CharClass c = char_class(peek);
+        return c >= CharClass::Dot && c <= CharClass::Newline;
+    }
+
+    // Ends number literals, which may contain '.'.
+    constexpr bool is_num_spliterator(char peek) noexcept {
+        CharClass c = char_class(peek);
+        return c >= CharClass::Colon && c <= CharClass::Newline;
+    }
+}
+
+#endif //OPP_FRONTEND_CHAR_CLASS_HPP
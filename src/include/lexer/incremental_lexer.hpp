@@ -0,0 +1,103 @@
+#ifndef OPP_FRONTEND_INCREMENTAL_LEXER_HPP
+#define OPP_FRONTEND_INCREMENTAL_LEXER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser/parser.tab.hpp"
+#include "lexer/source_location.hpp"
+
+namespace yy {
+
+    // A token of a buffer under edit. It refers to the text by byte offset, so it
+    // survives edits elsewhere; identifier and string values are read from there.
+    // A literal the scanner rejected is kept as S_YYerror.
+    struct LexedToken {
+        parser::symbol_kind::symbol_kind_type kind;
+        uint32_t length;
+        size_t offset;
+        SourceRange location;
+        union {
+            int integer;
+            double real;
+            bool boolean;
+        };
+    };
+
+    // Replaces `removed` bytes at `offset` with `inserted`.
+    struct TextEdit {
+        size_t offset = 0;
+        size_t removed = 0;
+        std::string_view inserted;
+    };
+
+    // Tokens [first, first + inserted) of the edited buffer replaced `removed`
+    // tokens of the previous one; the tokens behind them only moved.
+    struct TokenRange {
+        size_t first = 0;
+        size_t removed = 0;
+        size_t inserted = 0;
+        // The tokens behind moved by `delta` bytes.
+        ptrdiff_t delta = 0;
+
+        // Where a range behind the edit, e.g. of a node built from the tokens
+        // there, is now.
+        void shift(SourceRange &range) const noexcept {
+            range.begin.offset = static_cast<uint32_t>(range.begin.offset + delta);
+            range.end.offset = static_cast<uint32_t>(range.end.offset + delta);
+        }
+    };
+
+    // Keeps a buffer and its tokens in step, for editors and watch mode.
+    //
+    // An edit is lexed again from the end of the last token in front of it until
+    // a new token starts behind the edit where an old one started: the text from
+    // there on is unchanged, and so are its tokens. Those keep their kind and
+    // value and have their offsets shifted.
+    class IncrementalLexer {
+    public:
+        // Registers the buffer with the SourceManager, which reads the lines of
+        // the current text whenever a location is printed, until the lexer is
+        // destroyed.
+        IncrementalLexer(std::string text, const std::string &filename);
+
+        IncrementalLexer(const IncrementalLexer &) = delete;
+
+        IncrementalLexer &operator=(const IncrementalLexer &) = delete;
+
+        // Throws std::runtime_error, and changes nothing, if the edit runs past
+        // the end of the text.
+        TokenRange apply(const TextEdit &edit);
+
+        const std::string &text() const noexcept {
+            return text_;
+        }
+
+        uint32_t file() const noexcept {
+            return file_.id();
+        }
+
+        // Ends with the end of file token.
+        const std::vector<LexedToken> &tokens() const noexcept {
+            return tokens_;
+        }
+
+        std::string_view lexeme(const LexedToken &token) const noexcept {
+            return std::string_view(text_).substr(token.offset, token.length);
+        }
+
+        // The token as the Scanner returns it; a rejected literal throws the
+        // Scanner's syntax_error again.
+        parser::symbol_type symbol(size_t index) const;
+
+    private:
+        std::string text_;
+        SourceManager::File file_;
+        std::vector<LexedToken> tokens_;
+    };
+}
+
+#endif //OPP_FRONTEND_INCREMENTAL_LEXER_HPP
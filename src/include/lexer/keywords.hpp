@@ -0,0 +1,146 @@
+#ifndef OPP_FRONTEND_KEYWORDS_HPP
+#define OPP_FRONTEND_KEYWORDS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "parser/parser.tab.hpp"
+
+namespace yy {
+
+    struct Keyword {
+        std::string_view spelling;
+        parser::token_kind_type token;
+        bool value = false;
+    };
+
+    inline constexpr Keyword keywords[] = {
+#define KEYWORD(SPELLING, TOKEN) {#SPELLING, parser::token::TOKEN},
+#define BOOLEAN_KEYWORD(SPELLING, VALUE) {#SPELLING, parser::token::BOOLEAN_LITERAL, VALUE},
+
+#include "lexer/keywords.def"
+    };
+
+    namespace detail {
+
+        inline constexpr size_t keyword_table_size = 32;
+
+        struct KeywordHash {
+            uint32_t first_factor;
+            uint32_t last_factor;
+
+            constexpr size_t operator()(std::string_view spelling) const noexcept {
+                auto first = static_cast<unsigned char>(spelling.front());
+                auto last = static_cast<unsigned char>(spelling.back());
+                return (first * first_factor + last * last_factor + spelling.size()) % keyword_table_size;
+            }
+        };
+
+        constexpr bool is_perfect(KeywordHash hash) {
+            std::array<bool, keyword_table_size> used{};
+            for (const auto &keyword: keywords) {
+                size_t slot = hash(keyword.spelling);
+                if (used[slot]) {
+                    return false;
+                }
+                used[slot] = true;
+            }
+            return true;
+        }
+
+        // Searches the smallest factors that map every keyword to its own slot.
+        constexpr KeywordHash find_perfect_hash() {
+            for (uint32_t first = 1; first < 64; first++) {
+                for (uint32_t last = 1; last < 64; last++) {
+                    if (is_perfect({first, last})) {
+                        return {first, last};
+                    }
+                }
+            }
+            return {0, 0};
+        }
+
+        inline constexpr KeywordHash keyword_hash = find_perfect_hash();
+
+        static_assert(keyword_hash.first_factor != 0, "no perfect hash for the keyword set, grow the table");
+
+        template<size_t N>
+        constexpr uint64_t load(const char *bytes) noexcept {
+            uint64_t word = 0;
+            for (size_t i = 0; i < N; i++) {
+                word |= uint64_t(static_cast<unsigned char>(bytes[i])) << (8 * i);
+            }
+            return word;
+        }
+
+        // Identifies a spelling of known length with at most eight bytes: two possibly
+        // overlapping loads for four bytes and more, first/middle/last byte below that.
+        // Longer spellings get a fingerprint too, they are rejected by the length check.
+        constexpr uint64_t fingerprint(std::string_view spelling) noexcept {
+            const char *begin = spelling.data();
+            size_t size = spelling.size();
+            if (size >= 4) {
+                return load<4>(begin) | load<4>(begin + size - 4) << 32;
+            }
+            return load<1>(begin) | load<1>(begin + size / 2) << 8 | load<1>(begin + size - 1) << 16;
+        }
+
+        struct KeywordSlot {
+            uint64_t fingerprint = 0;
+            size_t length = 0;
+            const Keyword *keyword = nullptr;
+        };
+
+        inline constexpr auto keyword_table = [] {
+            std::array<KeywordSlot, keyword_table_size> table{};
+            for (const auto &keyword: keywords) {
+                table[keyword_hash(keyword.spelling)] = {
+                        fingerprint(keyword.spelling),
+                        keyword.spelling.size(),
+                        &keyword
+                };
+            }
+            return table;
+        }();
+
+        inline constexpr size_t max_keyword_length = [] {
+            size_t length = 0;
+            for (const auto &keyword: keywords) {
+                length = std::max(length, keyword.spelling.size());
+            }
+            return length;
+        }();
+
+        static_assert(max_keyword_length <= sizeof(uint64_t), "keywords must fit into a fingerprint");
+    }
+
+    // One hash and two integer compares per identifier, no data dependent branches
+    // apart from the fingerprint width.
+    constexpr const Keyword *find_keyword(std::string_view spelling) noexcept {
+        if (spelling.empty()) {
+            return nullptr;
+        }
+
+        const auto &slot = detail::keyword_table[detail::keyword_hash(spelling)];
+        bool match = (slot.length == spelling.size()) & (slot.fingerprint == detail::fingerprint(spelling));
+        return match ? slot.keyword : nullptr;
+    }
+
+    static_assert([] {
+        for (const auto &keyword: keywords) {
+            if (find_keyword(keyword.spelling) != &keyword) {
+                return false;
+            }
+        }
+        return true;
+    }());
+    static_assert(find_keyword("class") && find_keyword("class")->token == parser::token::CLASS);
+    static_assert(find_keyword("false") && !find_keyword("false")->value);
+    static_assert(!find_keyword("classes") && !find_keyword("Class") && !find_keyword("x"));
+}
+
+#endif //OPP_FRONTEND_KEYWORDS_HPP
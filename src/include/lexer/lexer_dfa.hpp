@@ -0,0 +1,169 @@
+#ifndef OPP_FRONTEND_LEXER_DFA_HPP
+#define OPP_FRONTEND_LEXER_DFA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "lexer/char_class.hpp"
+
+namespace yy {
+
+    // States of the token automaton. Everything from Word on is accepting and
+    // ends the run; Word, Name and String hand the rest of the token to the
+    // bulk scanning kernels.
+    enum class LexState : uint8_t {
+        Start,
+        Integer,
+        Real,
+        BadNumber,
+        Colon,
+        Equals,
+        Stray,
+
+        Word,
+        Name,
+        String,
+        End,
+        IntegerLiteral,
+        RealLiteral,
+        BadNumberLiteral,
+        ColonOperator,
+        AssignmentOperator,
+        MethodDefinition,
+        MemberAccess,
+        LeftParen,
+        RightParen,
+        LeftBracket,
+        RightBracket,
+        Comma,
+        Undefined,
+    };
+
+    inline constexpr size_t lex_state_count = static_cast<size_t>(LexState::Undefined) + 1;
+
+    constexpr bool is_accepting(LexState state) noexcept {
+        return state >= LexState::Word;
+    }
+
+    // `consume` says whether the byte that caused the transition belongs to the token.
+    struct LexStep {
+        LexState next = LexState::Undefined;
+        bool consume = true;
+    };
+
+    namespace detail {
+        using LexTable = std::array<std::array<LexStep, char_class_count>, lex_state_count>;
+
+        constexpr void set_all(LexTable &table, LexState state, LexStep step) {
+            for (auto &entry: table[static_cast<size_t>(state)]) {
+                entry = step;
+            }
+        }
+
+        constexpr void set(LexTable &table, LexState state, CharClass c, LexStep step) {
+            table[static_cast<size_t>(state)][static_cast<size_t>(c)] = step;
+        }
+
+        // A number runs until a number spliterator; every '.' moves it one state on.
+        constexpr void set_number(LexTable &table, LexState state, LexState on_dot, LexState accept) {
+            set_all(table, state, {state});
+            set(table, state, CharClass::Dot, {on_dot});
+            for (auto c = static_cast<uint8_t>(CharClass::Colon); c <= static_cast<uint8_t>(CharClass::Eof); c++) {
+                set(table, state, static_cast<CharClass>(c), {accept, false});
+            }
+        }
+
+        constexpr LexTable make_lex_table() {
+            LexTable table{};
+
+            // Whitespace is skipped before the automaton runs; should it see some
+            // anyway, it reports one undefined byte instead of looping.
+            set_all(table, LexState::Start, {LexState::Undefined});
+            set(table, LexState::Start, CharClass::Lower, {LexState::Word, false});
+            set(table, LexState::Start, CharClass::Other, {LexState::Name, false});
+            set(table, LexState::Start, CharClass::Quote, {LexState::String, false});
+            set(table, LexState::Start, CharClass::Eof, {LexState::End, false});
+            set(table, LexState::Start, CharClass::Digit, {LexState::Integer});
+            set(table, LexState::Start, CharClass::Dot, {LexState::MemberAccess});
+            set(table, LexState::Start, CharClass::Colon, {LexState::Colon});
+            set(table, LexState::Start, CharClass::Equals, {LexState::Equals});
+            set(table, LexState::Start, CharClass::Greater, {LexState::Stray});
+            set(table, LexState::Start, CharClass::LeftParen, {LexState::LeftParen});
+            set(table, LexState::Start, CharClass::RightParen, {LexState::RightParen});
+            set(table, LexState::Start, CharClass::LeftBracket, {LexState::LeftBracket});
+            set(table, LexState::Start, CharClass::RightBracket, {LexState::RightBracket});
+            set(table, LexState::Start, CharClass::Comma, {LexState::Comma});
+
+            set_number(table, LexState::Integer, LexState::Real, LexState::IntegerLiteral);
+            set_number(table, LexState::Real, LexState::BadNumber, LexState::RealLiteral);
+            set_number(table, LexState::BadNumber, LexState::BadNumber, LexState::BadNumberLiteral);
+
+            set_all(table, LexState::Colon, {LexState::ColonOperator, false});
+            set(table, LexState::Colon, CharClass::Equals, {LexState::AssignmentOperator});
+
+            // Operators that do not form a token swallow the next byte, whatever it is.
+            set_all(table, LexState::Equals, {LexState::Undefined});
+            set(table, LexState::Equals, CharClass::Greater, {LexState::MethodDefinition});
+            set(table, LexState::Equals, CharClass::Eof, {LexState::Undefined, false});
+            set_all(table, LexState::Stray, {LexState::Undefined});
+            set(table, LexState::Stray, CharClass::Eof, {LexState::Undefined, false});
+
+            return table;
+        }
+
+        inline constexpr LexTable lex_table = make_lex_table();
+
+        constexpr LexStep step(LexState state, CharClass c) noexcept {
+            return lex_table[static_cast<size_t>(state)][static_cast<size_t>(c)];
+        }
+
+        static_assert([] {
+            for (const auto &row: lex_table) {
+                for (const auto &entry: row) {
+                    if (entry.consume && entry.next == LexState::End) {
+                        return false;
+                    }
+                }
+            }
+            for (auto c = static_cast<uint8_t>(CharClass::Other); c < static_cast<uint8_t>(CharClass::Eof); c++) {
+                if (step(LexState::Start, static_cast<CharClass>(c)).next == LexState::Start) {
+                    return false;
+                }
+            }
+            return true;
+        }(), "the automaton must make progress and never consume past the end");
+    }
+
+    // Runs the automaton from `cursor` to the first accepting state and leaves
+    // `cursor` past the bytes that belong to the token. One table load per byte.
+    constexpr LexState run_lexer_dfa(const char *&cursor, const char *end) noexcept {
+        LexState state = LexState::Start;
+        do {
+            CharClass c = cursor == end ? CharClass::Eof : char_class(*cursor);
+            LexStep step = detail::step(state, c);
+            cursor += step.consume;
+            state = step.next;
+        } while (!is_accepting(state));
+        return state;
+    }
+
+    static_assert([] {
+        constexpr auto lexes = [](std::string_view text, LexState expected, size_t length) {
+            const char *cursor = text.data();
+            LexState state = run_lexer_dfa(cursor, text.data() + text.size());
+            return state == expected && cursor == text.data() + length;
+        };
+        return lexes(":=", LexState::AssignmentOperator, 2)
+               && lexes(":x", LexState::ColonOperator, 1)
+               && lexes("=>", LexState::MethodDefinition, 2)
+               && lexes("=", LexState::Undefined, 1)
+               && lexes("12)", LexState::IntegerLiteral, 2)
+               && lexes("1.5.", LexState::BadNumberLiteral, 4)
+               && lexes("3.25 ", LexState::RealLiteral, 4)
+               && lexes("abc", LexState::Word, 0);
+    }());
+}
+
+#endif //OPP_FRONTEND_LEXER_DFA_HPP
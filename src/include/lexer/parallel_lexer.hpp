@@ -0,0 +1,107 @@
+#ifndef OPP_FRONTEND_PARALLEL_LEXER_HPP
+#define OPP_FRONTEND_PARALLEL_LEXER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser/parser.tab.hpp"
+#include "lexer/token_source.hpp"
+
+namespace llvm {
+    class ThreadPool;
+}
+
+namespace yy {
+
+    // Offsets where `source` may be cut for parallel lexing: in front of a `class`
+    // keyword that starts a line, at least `chunk_size` bytes apart.
+    std::vector<size_t> find_split_points(std::string_view source, size_t chunk_size);
+
+    // Lexes a large source on a pool of worker threads.
+    //
+    // The text is cut at find_split_points into chunks, and every chunk is lexed by
+    // its own Scanner with offsets counted from the start of the text. The parser
+    // gets the chunk streams in source order, which is the stream one serial
+    // Scanner would produce, lexical errors included.
+    //
+    // A cut is safe unless it falls into a string literal, which may span lines,
+    // and that is only known once the chunk in front of it has been lexed: a chunk
+    // stops at the first token that starts at or past its end, so a string running
+    // over the cut ends past it. The chunk behind is then lexed again, on the
+    // consuming thread, from where that string ended.
+    //
+    // Only a few chunks per thread are lexed ahead of the parser, so memory stays
+    // bounded by the chunk size rather than the file size.
+    class ParallelLexer : public TokenSource {
+    public:
+        static constexpr size_t default_chunk_size = 1 << 20;
+
+        // `source` must outlive the lexer; tokens point into it.
+        ParallelLexer(
+                std::string_view source,
+                unsigned threads,
+                size_t chunk_size = default_chunk_size
+        );
+
+        ~ParallelLexer() override;
+
+        parser::symbol_type next(uint32_t file) override;
+
+        size_t chunk_count() const noexcept {
+            return chunks_.size();
+        }
+
+    private:
+        // A lexed token, smaller than a symbol_type, which is only built when the
+        // token is handed out. S_YYerror marks where the next of the chunk's errors
+        // was thrown.
+        struct Lexeme {
+            parser::symbol_kind::symbol_kind_type kind;
+            uint32_t length;
+            uint32_t begin;
+            uint32_t end;
+            union {
+                const char *text;
+                int integer;
+                double real;
+                bool boolean;
+            };
+        };
+
+        struct Chunk {
+            size_t begin = 0;
+            size_t stop = 0;
+            std::vector<Lexeme> lexemes;
+            size_t next_lexeme = 0;
+            // Located in no file until handed out.
+            std::deque<parser::syntax_error> errors;
+            // Past the last lexeme, which may lie beyond `stop`.
+            size_t end = 0;
+            std::shared_future<void> done;
+        };
+
+        // Lexes the tokens starting in [begin, stop).
+        void lex(Chunk &chunk) const;
+
+        void submit(size_t index);
+
+        // Moves on to the next chunk, lexing it again if the last one ran into it.
+        void advance();
+
+        std::string_view source_;
+        std::vector<Chunk> chunks_;
+        size_t current_ = 0;
+        size_t window_;
+        std::atomic<bool> cancelled_{false};
+        std::unique_ptr<llvm::ThreadPool> pool_;
+    };
+}
+
+#endif //OPP_FRONTEND_PARALLEL_LEXER_HPP
@@ -0,0 +1,38 @@
+#ifndef OPP_FRONTEND_SCAN_KERNELS_HPP
+#define OPP_FRONTEND_SCAN_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yy {
+
+    // Bulk scanners for the runs that dominate O++ sources. Each returns the first
+    // byte in [begin, end) that ends the run, or `end`.
+    struct ScanKernels {
+        const char *name;
+
+        // First byte that is not whitespace.
+        const char *(*skip_whitespace)(const char *begin, const char *end);
+
+        // First whitespace or special byte, i.e. the end of an identifier or keyword.
+        const char *(*find_spliterator)(const char *begin, const char *end);
+
+        // First single quote, i.e. the end of a string literal body.
+        const char *(*find_quote)(const char *begin, const char *end);
+
+        // Appends where every line behind a newline in [begin, end) starts, for
+        // SourceManager's line tables; `begin` is at `offset` in its file.
+        void (*find_line_starts)(const char *begin, const char *end, uint32_t offset, std::vector<uint32_t> &starts);
+    };
+
+    const ScanKernels &scalar_scan_kernels() noexcept;
+
+    // The widest kernels the running CPU supports; chosen once on first use.
+    const ScanKernels &default_scan_kernels() noexcept;
+
+    // Every kernel set usable on this CPU, scalar first.
+    std::vector<const ScanKernels *> available_scan_kernels();
+}
+
+#endif //OPP_FRONTEND_SCAN_KERNELS_HPP
@@ -5,41 +5,144 @@
 #ifndef OPP_FRONTEND_SCANNER_HPP
 #define OPP_FRONTEND_SCANNER_HPP
 
+#include <string_view>
+
 #include "parser/parser.tab.hpp"
 #include "lexer/buffered_reader.hpp"
+#include "lexer/lexer_dfa.hpp"
+#include "lexer/scan_kernels.hpp"
+#include "lexer/source_location.hpp"
+#include "lexer/token_cache.hpp"
+#include "lexer/token_source.hpp"
+#include "util/trace.hpp"
 
 namespace yy {
 
+    // Turns the text into tokens, located by byte offset; lines are only counted
+    // once a location is printed, see SourceManager.
     class Scanner {
     public:
-        Scanner(BufferedReader reader, const std::string &filename);
+        // Registers the file with the SourceManager, for as long as the
+        // scanner lives.
+        Scanner(
+                BufferedReader reader,
+                const std::string &filename,
+                const ScanKernels &kernels = default_scan_kernels()
+        );
+
+        // Lexes a part of a file registered before, whose text starts at `start`.
+        Scanner(
+                BufferedReader reader,
+                SourceLoc start,
+                const ScanKernels &kernels = default_scan_kernels()
+        );
+
+        uint32_t file() const noexcept {
+            return file_;
+        }
 
         parser::symbol_type get_token();
 
+        // Hands out the tokens of `source`, e.g. a token cache, instead of lexing the text.
+        void replay_from(TokenSource *source) noexcept {
+            replay_ = source;
+        }
+
+        // Records every token handed out, so the stream can be cached.
+        void record_to(TokenCacheWriter *cache) noexcept {
+            recorder_ = cache;
+        }
+
+        // Where yylex reports tokens; none by default.
+        Trace *trace() const noexcept {
+            return trace_;
+        }
+
+        void set_trace(Trace *trace) noexcept {
+            trace_ = trace;
+        }
+
+        // Where the last lexed token, or the end of file, began in the text.
+        const char *token_start() const noexcept {
+            return token_start_;
+        }
+
+        const char *cursor() const noexcept {
+            return reader_.cursor();
+        }
+
     private:
+        static constexpr ptrdiff_t short_run_length = 16;
+
+        parser::symbol_type next_token();
+
+        parser::symbol_type scan_token();
+
+        parser::symbol_type record_token();
+
         yy::parser::symbol_type get_literal_identifier_or_keyword();
 
         yy::parser::symbol_type get_string_literal();
 
-        yy::parser::symbol_type get_num_literal();
+        yy::parser::symbol_type get_num_literal(LexState state, std::string_view s);
 
-        yy::parser::symbol_type get_special();
+        yy::parser::symbol_type get_special(LexState state);
 
         yy::parser::symbol_type get_identifier_or_undef();
 
-        char peek() const;
-
         char advance();
 
-        void begin_token();
+        // Most whitespace runs and identifiers end within a few bytes, where the class
+        // table beats a kernel call; the kernels take over runs longer than short_run_length.
+        const char *skip_whitespace(const char *begin) const;
+
+        const char *find_word_end(const char *begin) const;
+
+        // Streaming: refills the window until the next token fits into it whole.
+        void fill_window();
+
+        // Streaming: a token that runs to the end of the window is longer than the
+        // window guarantees, and may go on in the input.
+        void check_window(const char *token_end) {
+            if (token_end == reader_.end() && !reader_.exhausted()) [[unlikely]] {
+                throw parser::syntax_error(end_token(), "token longer than half the input window");
+            }
+        }
 
-        yy::location end_token();
+        void skip_to(const char *target) noexcept {
+            reader_.seek(target);
+        }
+
+        uint32_t offset(const char *at) const noexcept {
+            return start_ + static_cast<uint32_t>(reader_.input_offset(at));
+        }
+
+        // Text from `start` up to the cursor; a view into the source, never a copy.
+        std::string_view lexeme(const char *start) const;
+
+        // The lexeme as a token value, which has to outlive a streaming window.
+        std::string_view value(const char *start) {
+            return reader_.stable(lexeme(start));
+        }
+
+        void begin_token();
 
-        yy::position begin_{};
-        int lines_ = 0;
-        int lineOffset_ = 0;
-        std::string filename_;
+        SourceRange end_token();
+
+        // Only if the scanner registered the file.
+        SourceManager::File registration_;
+        uint32_t file_ = 0;
+        // Where the reader's text starts in the file.
+        uint32_t start_ = 0;
+        uint32_t token_begin_ = 0;
+        const char *token_start_ = nullptr;
+        // Streaming: the line starts of the file are recorded up to here.
+        size_t indexed_ = 0;
         BufferedReader reader_;
+        const ScanKernels &kernels_;
+        Trace *trace_ = nullptr;
+        TokenSource *replay_ = nullptr;
+        TokenCacheWriter *recorder_ = nullptr;
     };
 }
 
@@ -0,0 +1,36 @@
+#ifndef OPP_FRONTEND_SOURCE_BUFFER_HPP
+#define OPP_FRONTEND_SOURCE_BUFFER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace llvm {
+    class MemoryBuffer;
+}
+
+namespace yy {
+
+    // Read-only view of a whole source file. Regular files are mapped into memory,
+    // pipes and stdin ("-") are read into a heap buffer once. The view stays valid
+    // for the lifetime of the SourceBuffer, so tokens and AST may point into it.
+    class SourceBuffer {
+    public:
+        static SourceBuffer open(const std::string &filename);
+
+        SourceBuffer(SourceBuffer &&other) noexcept;
+
+        SourceBuffer &operator=(SourceBuffer &&other) noexcept;
+
+        std::string_view view() const noexcept;
+
+        ~SourceBuffer();
+
+    private:
+        explicit SourceBuffer(std::unique_ptr<llvm::MemoryBuffer> buffer) noexcept;
+
+        std::unique_ptr<llvm::MemoryBuffer> buffer_;
+    };
+}
+
+#endif //OPP_FRONTEND_SOURCE_BUFFER_HPP
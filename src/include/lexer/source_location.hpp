@@ -0,0 +1,114 @@
+#ifndef OPP_FRONTEND_SOURCE_LOCATION_HPP
+#define OPP_FRONTEND_SOURCE_LOCATION_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace yy {
+
+    // A byte in a source file: the file's id with the SourceManager and the
+    // byte's offset in it. File 0 is no file, where bison starts its stack.
+    struct SourceLoc {
+        uint32_t file = 0;
+        uint32_t offset = 0;
+
+        friend bool operator==(const SourceLoc &, const SourceLoc &) noexcept = default;
+    };
+
+    // What tokens and nodes are located by, the parser's location type: the
+    // bytes [begin, end) of one file.
+    struct SourceRange {
+        SourceLoc begin;
+        SourceLoc end;
+
+        friend bool operator==(const SourceRange &, const SourceRange &) noexcept = default;
+    };
+
+    // A SourceLoc as line and column, both counted from 0, for diagnostics. No
+    // file is at line 1, column 1, as in bison's own positions.
+    struct position {
+        explicit position(const std::string *filename = nullptr, int line = 1, int column = 1) noexcept
+                : filename(filename), line(line), column(column) {}
+
+        const std::string *filename;
+        int line;
+        int column;
+    };
+
+    struct location {
+        location() noexcept = default;
+
+        location(const position &begin, const position &end) noexcept: begin(begin), end(end) {}
+
+        position begin;
+        position end;
+    };
+
+    // Printed as bison prints its locations: file:line.column, then the last
+    // column, or line and column, of the range.
+    std::ostream &operator<<(std::ostream &out, const position &position);
+
+    std::ostream &operator<<(std::ostream &out, const location &location);
+
+    // Resolves the range first.
+    std::ostream &operator<<(std::ostream &out, const SourceRange &range);
+
+    // The source files of the process, and where their lines start.
+    //
+    // Tokens and nodes only carry byte offsets; a file's line table is built
+    // the first time a location in it is resolved, which is when a diagnostic
+    // or a trace is printed, so the scanner never counts lines. A file stays
+    // registered as long as the File handed out for it, whose owner also keeps
+    // the text; any thread may resolve.
+    class SourceManager {
+    public:
+        // A registered file, which is dropped with the handle. Its id may then
+        // be handed out again: locations in it resolve to no file, or to the
+        // next one, and are not to be resolved any more.
+        class File {
+        public:
+            File() noexcept = default;
+
+            File(File &&other) noexcept: id_(other.id_) {
+                other.id_ = 0;
+            }
+
+            File &operator=(File &&other) noexcept;
+
+            ~File();
+
+            uint32_t id() const noexcept {
+                return id_;
+            }
+
+        private:
+            friend class SourceManager;
+
+            explicit File(uint32_t id) noexcept: id_(id) {}
+
+            uint32_t id_ = 0;
+        };
+
+        // A file read in place; `text` must be alive whenever a location in it
+        // is resolved.
+        static File add(const std::string &name, std::string_view text);
+
+        // A file read as a stream, whose text is gone by the time a location is
+        // resolved: the scanner records the line starts of every window it reads.
+        static File add_stream(const std::string &name);
+
+        // Streams: `text` was read at `offset`, following what was recorded before.
+        static void record_lines(uint32_t file, std::string_view text, uint32_t offset);
+
+        // The text of `file` changed, e.g. in an editor; lines are counted anew.
+        static void replace_text(uint32_t file, std::string_view text);
+
+        static position resolve(SourceLoc loc);
+
+        static location resolve(const SourceRange &range);
+    };
+}
+
+#endif //OPP_FRONTEND_SOURCE_LOCATION_HPP
@@ -0,0 +1,93 @@
+#ifndef OPP_FRONTEND_TOKEN_CACHE_HPP
+#define OPP_FRONTEND_TOKEN_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+
+#include "parser/parser.tab.hpp"
+#include "lexer/token_source.hpp"
+
+namespace llvm {
+    class MemoryBuffer;
+}
+
+namespace yy {
+
+    // Pre-tokenized source files (.optok), so unchanged files are not lexed again.
+    //
+    // A cache file is named after the xxHash64 of the source text and holds:
+    //   header   magic "OPTOK", format version, source hash and size, payload hash,
+    //            string and token counts, all fixed width little endian
+    //   strings  every distinct identifier and string literal, ULEB128 length + bytes
+    //   tokens   kind byte, then the location as ULEB128 byte distance from the
+    //            previous token's end to the token's begin and the token's length;
+    //            then the value: a string index, a zigzag ULEB128 integer, eight
+    //            raw bytes of a real or one byte of a boolean
+    //
+    // The payload hash is checked when a file is opened, so a torn or foreign file
+    // reads as a miss rather than as garbage tokens.
+
+    uint64_t source_hash(std::string_view source) noexcept;
+
+    // Where the tokens of `source` are cached inside `directory`.
+    std::string token_cache_path(const std::string &directory, std::string_view source);
+
+    class TokenCacheWriter {
+    public:
+        void record(const parser::symbol_type &token);
+
+        // The scanner could not lex the whole file; nothing will be written.
+        void abandon() noexcept;
+
+        // True once the end of file token was recorded and nothing failed.
+        bool complete() const noexcept;
+
+        // Writes the recorded stream for `source` through a temporary file and a
+        // rename, so concurrent compiles never see half a cache file.
+        bool write(const std::string &path, std::string_view source) const;
+
+    private:
+        uint32_t intern(std::string_view text);
+
+        std::string tokens_;
+        llvm::DenseMap<llvm::StringRef, uint32_t> string_ids_;
+        std::vector<std::string_view> strings_;
+        uint32_t token_count_ = 0;
+        uint32_t end_ = 0;
+        bool complete_ = false;
+        bool abandoned_ = false;
+    };
+
+    class TokenCacheReader : public TokenSource {
+    public:
+        // Maps the cache file at `path`; nullptr unless it holds the tokens of `source`.
+        static std::unique_ptr<TokenCacheReader> open(const std::string &path, std::string_view source);
+
+        ~TokenCacheReader() override;
+
+        // Identifier and string values point into the mapping, which lives as long as the reader.
+        parser::symbol_type next(uint32_t file) override;
+
+    private:
+        explicit TokenCacheReader(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+        bool load(std::string_view source);
+
+        std::unique_ptr<llvm::MemoryBuffer> buffer_;
+        std::vector<std::string_view> strings_;
+        const int *token_numbers_;
+        const uint8_t *cursor_ = nullptr;
+        const uint8_t *end_ = nullptr;
+        uint32_t remaining_ = 0;
+        // Where the last token ended in the source.
+        uint32_t source_end_ = 0;
+    };
+}
+
+#endif //OPP_FRONTEND_TOKEN_CACHE_HPP
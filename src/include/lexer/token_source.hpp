@@ -0,0 +1,22 @@
+#ifndef OPP_FRONTEND_TOKEN_SOURCE_HPP
+#define OPP_FRONTEND_TOKEN_SOURCE_HPP
+
+#include <cstdint>
+
+#include "parser/parser.tab.hpp"
+
+namespace yy {
+
+    // Tokens a Scanner hands out instead of lexing the text itself, such as a
+    // token cache or the chunks of a parallel lex. The stream must be exactly
+    // what the scanner would have produced, lexical errors included.
+    class TokenSource {
+    public:
+        virtual ~TokenSource() = default;
+
+        // Tokens of `file`, the scanner's.
+        virtual parser::symbol_type next(uint32_t file) = 0;
+    };
+}
+
+#endif //OPP_FRONTEND_TOKEN_SOURCE_HPP
@@ -0,0 +1,78 @@
+#ifndef OPP_FRONTEND_INCREMENTAL_PARSER_HPP
+#define OPP_FRONTEND_INCREMENTAL_PARSER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "lexer/incremental_lexer.hpp"
+
+namespace yy {
+
+    class Scanner;
+
+    // Keeps the AST of a buffer under edit in step with its text.
+    //
+    // The tokens come from an IncrementalLexer. An edit whose damaged tokens lie
+    // within one class is parsed again from that class's `class` keyword, and
+    // the class must end where it ended before, shifted by the edit; an edit in
+    // the main class expression parses that expression again. The other classes
+    // are kept, and those behind the edit have their locations shifted. Any other
+    // edit, and any that does not parse, parses the whole buffer again, which
+    // reports syntax errors as the driver's parsers do.
+    //
+    // The nodes are always built on the heap, not in an AstArena in scope: the
+    // classes an edit replaces are freed as they go.
+    class IncrementalParser {
+    public:
+        IncrementalParser(std::string text, const std::string &filename);
+
+        IncrementalParser(const IncrementalParser &) = delete;
+
+        IncrementalParser &operator=(const IncrementalParser &) = delete;
+
+        ~IncrementalParser();
+
+        // 0 on success, 1 after a syntax error, which has then been reported.
+        // An edit past the end of the text throws, as IncrementalLexer::apply()
+        // does.
+        int apply(const TextEdit &edit);
+
+        const std::string &text() const noexcept {
+            return lexer_.text();
+        }
+
+        // Null while the text does not parse.
+        const Program *program() const noexcept {
+            return program_.get();
+        }
+
+        // How many classes the last parse built; all of them after a full parse.
+        size_t parsed_classes() const noexcept {
+            return parsed_classes_;
+        }
+
+    private:
+        class LexedTokens;
+
+        int parse_all();
+
+        // Parses class `index` again, or the main class expression past the last
+        // class; false if the edit does not stay within it.
+        bool reparse(size_t index, const TokenRange &range);
+
+        void rebuild(std::vector<std::unique_ptr<ProgramDeclarationExpr>> &&classes, std::unique_ptr<Expr> &&main_class);
+
+        IncrementalLexer lexer_;
+        std::unique_ptr<LexedTokens> tokens_;
+        std::unique_ptr<Scanner> scanner_;
+        std::unique_ptr<Program> program_;
+        // The token every class starts at, then the one the main class expression does.
+        std::vector<size_t> starts_;
+        size_t parsed_classes_ = 0;
+    };
+}
+
+#endif //OPP_FRONTEND_INCREMENTAL_PARSER_HPP
@@ -0,0 +1,81 @@
+#ifndef OPP_FRONTEND_PARALLEL_PARSER_HPP
+#define OPP_FRONTEND_PARALLEL_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "ast/ast_arena.hpp"
+#include "lexer/source_location.hpp"
+
+namespace yy {
+
+    class Scanner;
+
+    // Parses the classes of a large source on a pool of worker threads.
+    //
+    // Every `class ... end` is a grammar of its own, so the text is cut at
+    // find_split_points and every chunk is lexed and parsed by its own Scanner
+    // and RecursiveDescentParser, with offsets counted from where the chunk starts.
+    // The classes are put together in source order into the ProgramDeclaration,
+    // located as bison locates it, and the main class expression is parsed last,
+    // by the final chunk.
+    //
+    // A chunk has to stop in front of the `class` the next one starts with. It
+    // does not if a string literal runs over the cut, or if the file does not
+    // parse; the cut is then of no use, and parse() leaves the file to the serial
+    // parser, which also reports the syntax error as it always has. So does a
+    // chunk whose calls nest deeper than RecursiveDescentParser takes them: the
+    // serial parser is the one the driver was asked for, which may be bison.
+    class ParallelParser {
+    public:
+        static constexpr size_t min_chunk_size = 64 << 10;
+
+        // `source` must outlive the AST, which is located in it as a file of its
+        // own, and the parser the AST, whose classes live in its arenas. A chunk
+        // size of 0 cuts the text into a few chunks per thread.
+        ParallelParser(
+                std::string_view source,
+                const std::string &filename,
+                unsigned threads,
+                size_t chunk_size = 0
+        );
+
+        ~ParallelParser();
+
+        // The program, or nullptr if it has to be parsed serially.
+        std::unique_ptr<Program> parse();
+
+        size_t chunk_count() const noexcept {
+            return chunks_.size();
+        }
+
+    private:
+        struct Chunk {
+            size_t begin = 0;
+            size_t stop = 0;
+            std::unique_ptr<Scanner> scanner;
+            // The chunk's classes are built on a worker thread.
+            AstArena arena;
+            std::vector<std::unique_ptr<ProgramDeclarationExpr>> classes;
+            // Only parsed by the last chunk.
+            std::unique_ptr<Expr> main_class;
+            // Stopped in front of the `class` at `stop`, or at the end of file
+            // after the main class expression.
+            bool complete = false;
+        };
+
+        void parse(Chunk &chunk, bool last);
+
+        std::string_view source_;
+        SourceManager::File file_;
+        std::vector<Chunk> chunks_;
+        unsigned threads_;
+    };
+}
+
+#endif //OPP_FRONTEND_PARALLEL_PARSER_HPP
@@ -0,0 +1,142 @@
+#ifndef OPP_FRONTEND_RECURSIVE_DESCENT_PARSER_HPP
+#define OPP_FRONTEND_RECURSIVE_DESCENT_PARSER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "parser/parser.tab.hpp"
+
+namespace yy {
+
+    class Scanner;
+
+    // A hand-written parser for the grammar of parser.ypp, a drop-in for
+    // yy::parser. It builds the same AST with the same locations, down to those
+    // bison gives empty lists, reads the same tokens from the Scanner, and stops
+    // with the same message at the same token on a syntax error.
+    //
+    // One token of lookahead decides every production. The exceptions are an
+    // identifier, which starts an assignment, a call, a field or a chain, and
+    // is taken before the token behind it is looked at; and a member access
+    // chain, which is collected in a loop, so neither the call stack nor the
+    // heap grows with its length beyond the links themselves.
+    //
+    // Nor does the call stack grow with how deep while loops and ifs nest: the
+    // bodies around the statement being parsed are kept in a list. Calls in the
+    // arguments of calls do recurse, and more than max_call_depth of them are a
+    // syntax error rather than a stack overflow.
+    class RecursiveDescentParser {
+    public:
+        static constexpr size_t max_call_depth = 1000;
+
+        RecursiveDescentParser(Scanner &scanner, std::unique_ptr<Program> &root);
+
+        // 0 on success, 1 after a syntax error, which has then been reported.
+        int parse();
+
+        int operator()() {
+            return parse();
+        }
+
+        // The two halves of parse() for ParallelParser, which runs a parser on
+        // every slice of a file. Both throw the syntax_error parse() would report.
+
+        // Parses class declarations into `classes` as long as the next token is
+        // `class` and starts before `stop`. Returns where the `class` it stopped
+        // in front of starts, or nullptr if it stopped at another token.
+        const char *parse_classes(std::vector<std::unique_ptr<ProgramDeclarationExpr>> &classes, const char *stop);
+
+        // The main class expression and the end of file behind it.
+        std::unique_ptr<Expr> parse_main_expression();
+
+        // One class declaration, for IncrementalParser, which parses the class an
+        // edit falls into again. Throws like the two above.
+        std::unique_ptr<ProgramDeclarationExpr> parse_class();
+
+    private:
+        using Kind = parser::symbol_kind::symbol_kind_type;
+
+        // A scanned token without the variant around its value.
+        struct Token {
+            Kind kind;
+            yy::SourceRange location;
+            std::string_view text;
+            union {
+                int integer;
+                double real;
+                bool boolean;
+            };
+        };
+
+        Kind peek();
+
+        Token take();
+
+        // Takes a token of the given kind, or fails on the one there.
+        Token expect(Kind kind);
+
+        [[noreturn]] void fail();
+
+        std::unique_ptr<ProgramDeclarationExpr> class_declaration();
+
+        std::unique_ptr<MemberDeclarationExpr> method_declaration();
+
+        std::unique_ptr<ConstructorDefinition> constructor_declaration();
+
+        std::unique_ptr<VariableDeclaration> variable_declaration();
+
+        std::vector<std::unique_ptr<ParameterDeclaration>> parameters();
+
+        // `is body end` or `=> expression`, whose location starts at `is` or `=>`.
+        std::unique_ptr<Body> method_body();
+
+        // A body under construction: the statement it belongs to, S_WHILE,
+        // S_IF or S_ELSE for the else branch, or S_YYEOF for the one asked for.
+        struct OpenBody {
+            Kind statement;
+            Token keyword;
+            std::unique_ptr<Expr> condition;
+            std::unique_ptr<Body> then_body;
+            SourceLoc begin;
+            std::vector<std::unique_ptr<BodyExpr>> expressions;
+        };
+
+        // The statements up to a token that cannot start one, as a Body located
+        // like bison locates the (possibly empty) body_list.
+        std::unique_ptr<Body> body_list();
+
+        // A statement other than a while loop or an if.
+        std::unique_ptr<BodyExpr> body();
+
+        std::unique_ptr<ReturnStmt> return_statement();
+
+        std::unique_ptr<Expr> expression();
+
+        // An expression whose leading identifier has been taken already.
+        std::unique_ptr<Expr> expression(Token &&identifier);
+
+        std::unique_ptr<MethodCallExpr> function_call(Token &&identifier);
+
+        std::unique_ptr<PrimaryExpr> primary(Token &&token);
+
+        // The rest of `first.link.link...`, with the lookahead on the first dot.
+        std::unique_ptr<MemberAccess> member_access_chain(std::unique_ptr<Expr> &&first);
+
+        static bool starts_primary(Kind kind);
+
+        Scanner &scanner_;
+        std::unique_ptr<Program> &root_;
+        Token lookahead_{};
+        bool has_lookahead_ = false;
+        // Where the last token taken ends; bison locates an empty list there.
+        yy::SourceLoc last_end_;
+        // The calls whose arguments are being parsed.
+        size_t call_depth_ = 0;
+    };
+}
+
+#endif //OPP_FRONTEND_RECURSIVE_DESCENT_PARSER_HPP
@@ -6,31 +6,74 @@
 #define SDK_CFA_VISITOR_HPP
 
 
-#include "visitor/recursive_visitor.hpp"
+#include "ast/flat_ast.hpp"
+#include "visitor/iterative_visitor.hpp"
 #include "symbol_table.hpp"
 #include "symbol_table_index.hpp"
 #include "semantic_error.hpp"
 
 namespace yy {
 
-    class CFAVisitor : public RecursiveVisitor<size_t> {
+    class CFAVisitor : public IterativeVisitor<CFAVisitor> {
     public:
         CFAVisitor(
                 std::vector<SemanticError> &semantic_errors
-        ) : RecursiveVisitor(),
-            semantic_errors_(semantic_errors) {}
+        ) : semantic_errors_(semantic_errors) {}
 
-        void operator()(const ReturnStmt &return_stmt) override;
+        using IterativeVisitor::enter;
+        using IterativeVisitor::after;
+        using IterativeVisitor::leave;
 
-        void operator()(const IfStmt &if_stmt) override;
+        // Expressions hold no statements.
+        bool enter(const MethodCallExpr &method_call_expr);
 
-        void operator()(const ConstructorDefinition &constructor_definition) override;
+        bool enter(const MemberAccess &member_access);
 
-        void operator()(const MethodDefinition &method_definition) override;
+        bool enter(const ReturnStmt &return_stmt);
 
-        ~CFAVisitor() override = default;
+        bool enter(const IfStmt &if_stmt);
+
+        void after(const IfStmt &if_stmt, size_t child);
+
+        void leave(const IfStmt &if_stmt);
+
+        bool enter(const ConstructorDefinition &constructor_definition);
+
+        bool enter(const MethodDefinition &method_definition);
+
+        void leave(const MethodDefinition &method_definition);
+
+    private:
+        // 1 once every path through the body so far returns.
+        size_t result_ = 0;
+        // What it was before each if being walked, and after its then branch.
+        std::vector<size_t> saved_;
+        std::vector<SemanticError> &semantic_errors_;
+    };
+
+    // The same analysis over the FlatAst the parser built beside the program,
+    // reporting the same errors in the same order.
+    class FlatCFAVisitor : public FlatVisitor {
+    public:
+        FlatCFAVisitor(
+                const FlatAst &ast,
+                std::vector<SemanticError> &semantic_errors
+        ) : ast_(ast), semantic_errors_(semantic_errors) {}
+
+        const FlatAst &ast() const noexcept {
+            return ast_;
+        }
+
+        bool enter(const FlatAst &ast, NodeId node) override;
+
+        void after(const FlatAst &ast, NodeId node, uint32_t child) override;
+
+        void leave(const FlatAst &ast, NodeId node) override;
 
     private:
+        const FlatAst &ast_;
+        size_t result_ = 0;
+        std::vector<size_t> saved_;
         std::vector<SemanticError> &semantic_errors_;
     };
 }
@@ -21,21 +21,26 @@ namespace yy {
                 : symbol_table_index_(symbolTableIndex), semantic_errors_(semanticErrors) {}
 
         void operator()(const Program &program) override {
-            auto constructor_chain = dynamic_cast<const MemberAccess *>(program.main_class());
+            leave(program);
+        }
+
+        // The check, for a PassManager: it looks at the program's node only.
+        void leave(const Program &program) {
+            auto constructor_chain = llvm::dyn_cast_or_null<MemberAccess>(program.main_class());
 
             if (!constructor_chain) {
                 expect_constructor_call(program);
                 return;
             }
 
-            auto this_call = dynamic_cast<const ThisExpr *>(constructor_chain->lhs());
+            auto this_call = llvm::dyn_cast_or_null<ThisExpr>(constructor_chain->lhs());
 
             if (!this_call) {
                 expect_constructor_call(program);
                 return;
             }
 
-            auto method_call = dynamic_cast<const MethodCallExpr *>(constructor_chain->rhs());
+            auto method_call = llvm::dyn_cast_or_null<MethodCallExpr>(constructor_chain->rhs());
 
             if (!method_call) {
                 expect_constructor_call(program);
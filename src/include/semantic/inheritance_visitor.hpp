@@ -6,27 +6,26 @@
 #define OPP_FRONTEND_INHERITANCE_VISITOR_HPP
 
 
-#include "visitor/recursive_visitor.hpp"
+#include "visitor/iterative_visitor.hpp"
 #include "symbol_table.hpp"
 #include "symbol_table_index.hpp"
 #include "semantic_error.hpp"
 
 namespace yy {
 
-    class InheritanceVisitor : public RecursiveVisitor<Symbol *> {
+    class InheritanceVisitor : public IterativeVisitor<InheritanceVisitor> {
     public:
         InheritanceVisitor(
                 SymbolTableIndex *symbol_table_index,
                 std::vector<SemanticError> &semantic_errors
-        ) : RecursiveVisitor(),
-            symbol_table_index_(symbol_table_index),
+        ) : symbol_table_index_(symbol_table_index),
             semantic_errors_(semantic_errors) {}
 
-        void operator()(const VariableDeclaration &variable_declaration) override;
+        using IterativeVisitor::enter;
 
-        void operator()(const ClassDeclaration &class_declaration) override;
+        bool enter(const VariableDeclaration &variable_declaration);
 
-        ~InheritanceVisitor() override = default;
+        bool enter(const ClassDeclaration &class_declaration);
 
     private:
         SymbolTableIndex *symbol_table_index_;
@@ -11,7 +11,7 @@
 constexpr std::string mangling_delimiter = "$$";
 
 std::string transform_to_mangling_name(
-        const std::string &method_name,
+        yy::Name method_name,
         const std::vector<ClassSymbol *> &parameters
 );
 
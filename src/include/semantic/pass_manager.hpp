@@ -0,0 +1,246 @@
+#ifndef OPP_FRONTEND_PASS_MANAGER_HPP
+#define OPP_FRONTEND_PASS_MANAGER_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "ast/flat_ast.hpp"
+#include "semantic/semantic_error.hpp"
+#include "semantic/symbol_table.hpp"
+#include "semantic/symbol_table_index.hpp"
+#include "visitor/iterative_visitor.hpp"
+
+namespace yy {
+
+    // A semantic pass as a PassManager runs it: the program's node on the way
+    // down, every class, then the program's node on the way up, which visits the
+    // main class expression.
+    class FusedPass {
+    public:
+        virtual void enter(const Program &program) = 0;
+
+        virtual void visit(const ProgramDeclarationExpr &clazz) = 0;
+
+        virtual void leave(const Program &program) = 0;
+
+        virtual ~FusedPass() = default;
+    };
+
+    // A recursive or an iterative visitor as a FusedPass. A recursive visitor
+    // that does work on the program's node itself has enter() or leave() for
+    // it; an iterative one is walked through the program's node and the class
+    // list around the classes, as its own walk of the program would, but for
+    // the after() calls of the two.
+    template<class PassVisitor>
+    class VisitorPass : public FusedPass {
+    public:
+        template<class Make>
+        explicit VisitorPass(Make &&make, std::vector<SemanticError> &errors) : visitor_(make(errors)) {}
+
+        void enter(const Program &program) override {
+            if constexpr (iterative) {
+                visitor_.enter(program);
+                visitor_.enter(*program.class_declarations());
+            } else if constexpr (requires { visitor_.enter(program); }) {
+                visitor_.enter(program);
+            }
+        }
+
+        void visit(const ProgramDeclarationExpr &clazz) override {
+            accept(clazz);
+        }
+
+        void leave(const Program &program) override {
+            if constexpr (iterative) {
+                visitor_.leave(*program.class_declarations());
+                accept(*program.main_class());
+                visitor_.leave(program);
+            } else if constexpr (requires { visitor_.leave(program); }) {
+                visitor_.leave(program);
+            } else {
+                accept(*program.main_class());
+            }
+        }
+
+    private:
+        static constexpr bool iterative = std::is_base_of_v<IterativeVisitor<PassVisitor>, PassVisitor>;
+
+        PassVisitor visitor_;
+
+        template<class Node>
+        void accept(const Node &node) {
+            if constexpr (iterative) {
+                visitor_.visit(node);
+            } else {
+                node.accept(visitor_);
+            }
+        }
+    };
+
+    // A FlatVisitor as a FusedPass: each class, then the main class expression,
+    // is walked in the FlatAst the visitor holds, which is that of the program
+    // run. The store keeps the classes in the program's order.
+    template<class PassVisitor>
+    class FlatVisitorPass : public FusedPass {
+    public:
+        template<class Make>
+        explicit FlatVisitorPass(Make &&make, std::vector<SemanticError> &errors) : visitor_(make(errors)) {}
+
+        void enter(const Program &) override {
+            clazz_ = 0;
+        }
+
+        void visit(const ProgramDeclarationExpr &) override {
+            const FlatAst &ast = visitor_.ast();
+            ast.walk(visitor_, ast.child(ast.child(ast.root(), 0), clazz_++));
+        }
+
+        void leave(const Program &) override {
+            const FlatAst &ast = visitor_.ast();
+            ast.walk(visitor_, ast.child(ast.root(), 1));
+        }
+
+    private:
+        PassVisitor visitor_;
+        uint32_t clazz_ = 0;
+    };
+
+    // What the passes hand each other besides the AST, which none of them
+    // changes.
+    enum class PassData : uint8_t {
+        // The class symbols.
+        Classes,
+        // The method and field symbols.
+        Members,
+        // The scopes of methods and bodies, and the SymbolTableIndex into them.
+        Scopes,
+        // The types of fields and variables.
+        Types,
+    };
+
+    // What a pass needs of the data it reads: what was written for the class
+    // being visited, or for every class of the program.
+    enum class PassNeeds {
+        SameClass,
+        WholeProgram,
+    };
+
+    struct PassInput {
+        PassData data;
+        PassNeeds needs = PassNeeds::WholeProgram;
+    };
+
+    // Runs semantic passes over a program, as few times over it and on as many
+    // threads as the data they read and write allow.
+    //
+    // Passes are added in the order they would run one after the other; a pass
+    // waits for the last one in front of it that writes what it reads, and
+    // a pass that writes waits for those in front of it that read or write the
+    // same. Passes are fused into walks: a pass joins the walk of the one in
+    // front of it, on more than one thread the walk of the last one it waits
+    // for, if it needs nothing of a pass in that walk for the whole program.
+    // A walk takes each class in turn through all of its passes, so the class
+    // is still in the cache for the second pass and on. Walks run as soon as
+    // the ones they wait for are done.
+    //
+    // Every pass reports into errors of its own, which are merged in the order
+    // the passes were added: the diagnostics are those of the passes run one
+    // after the other.
+    class PassManager {
+    public:
+        // `make` builds the pass's visitor from the errors it reports into; a
+        // FlatVisitor walks its FlatAst instead of the program.
+        template<class Make>
+        void add(
+                const std::string &name,
+                Make &&make,
+                std::initializer_list<PassInput> inputs = {},
+                std::initializer_list<PassData> outputs = {}
+        ) {
+            using PassVisitor = std::remove_cvref_t<decltype(make(std::declval<std::vector<SemanticError> &>()))>;
+            auto errors = std::make_unique<std::vector<SemanticError>>();
+            using Pass = std::conditional_t<std::is_base_of_v<FlatVisitor, PassVisitor>,
+                    FlatVisitorPass<PassVisitor>, VisitorPass<PassVisitor>>;
+            auto pass = std::make_unique<Pass>(std::forward<Make>(make), *errors);
+            add(name, std::move(pass), std::move(errors), inputs, outputs);
+        }
+
+        // Skips the pass, and every pass that reads what it writes.
+        void disable(const std::string &name);
+
+        // Off, every pass walks the program on its own.
+        void set_fusion(bool fusion) {
+            fusion_ = fusion;
+        }
+
+        // Walks that wait for nothing of each other run on this many threads;
+        // 1, the default, runs them one after the other.
+        void set_threads(unsigned threads) {
+            threads_ = threads;
+        }
+
+        // The passes run() runs, in order.
+        std::vector<std::string> passes() const;
+
+        // How many times run() walks the program.
+        size_t walks() const;
+
+        // Appends the diagnostics of the passes to `errors`.
+        void run(const Program &program, std::vector<SemanticError> &errors);
+
+    private:
+        struct Dependency {
+            size_t pass;
+            PassNeeds needs;
+        };
+
+        struct Entry {
+            std::string name;
+            std::unique_ptr<FusedPass> pass;
+            std::unique_ptr<std::vector<SemanticError>> errors;
+            std::vector<PassInput> inputs;
+            std::vector<PassData> outputs;
+            std::vector<Dependency> dependencies;
+            bool disabled = false;
+        };
+
+        // Passes run together in one walk, and the walks to wait for.
+        struct Walk {
+            std::vector<size_t> passes;
+            std::vector<size_t> dependencies;
+        };
+
+        std::vector<Entry> entries_;
+        bool fusion_ = true;
+        unsigned threads_ = 1;
+
+        void add(
+                const std::string &name,
+                std::unique_ptr<FusedPass> pass,
+                std::unique_ptr<std::vector<SemanticError>> errors,
+                std::initializer_list<PassInput> inputs,
+                std::initializer_list<PassData> outputs
+        );
+
+        std::vector<bool> enabled() const;
+
+        // In an order they may run in, one after the other.
+        std::vector<Walk> plan() const;
+
+        void run(const Program &program, const Walk &walk);
+    };
+
+    // The driver's analysis: class collector, method collector, symbol table,
+    // entrypoint, type checker, control flow and inheritance. Given the FlatAst
+    // of the program to run, control flow walks that instead.
+    void add_semantic_passes(PassManager &passes, SymbolTable *symbol_table, SymbolTableIndex *symbol_table_index,
+                             const FlatAst *flat_ast = nullptr);
+}
+
+#endif //OPP_FRONTEND_PASS_MANAGER_HPP
@@ -7,13 +7,13 @@
 
 #include <string>
 #include <ostream>
-#include "parser/location.hh"
+#include "lexer/source_location.hpp"
 
 class SemanticError {
 public:
     SemanticError(
             const std::string &message,
-            const yy::location &location,
+            const yy::SourceRange &location,
             bool fatal = false
     ) : message_(message), location_(location), fatal_(fatal) {}
 
@@ -21,7 +21,7 @@ public:
         return message_;
     }
 
-    const yy::location &location() const {
+    const yy::SourceRange &location() const {
         return location_;
     }
 
@@ -41,7 +41,7 @@ public:
 private:
     bool fatal_;
     std::string message_;
-    yy::location location_;
+    yy::SourceRange location_;
 };
 
 #endif //OPP_FRONTEND_SEMANTIC_ERROR_HPP
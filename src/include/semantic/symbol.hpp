@@ -9,9 +9,20 @@
 #include <string>
 #include <vector>
 
+// The concrete class of a Symbol, for llvm::isa and llvm::dyn_cast.
+enum class SymbolKind : uint8_t {
+    Instance,
+    Method,
+    Class
+};
+
 class Symbol {
 public:
-    const std::string &name() const noexcept;
+    SymbolKind symbol_kind() const noexcept {
+        return symbol_kind_;
+    }
+
+    yy::Name name() const noexcept;
 
     virtual const NodeBase *declaredNode() const noexcept;
 
@@ -20,11 +31,12 @@ public:
     virtual ~Symbol() {}
 
 protected:
-    Symbol(const std::string &name, const NodeBase *declaredNode);
+    Symbol(SymbolKind symbol_kind, yy::Name name, const NodeBase *declaredNode);
 
 private:
-    std::string name_;
+    yy::Name name_;
     const NodeBase *declaredNode_;
+    SymbolKind symbol_kind_;
 };
 
 class ClassSymbol;
@@ -40,12 +52,16 @@ public:
     InstanceSymbol(
             InstanceSymbolKind kind,
             const ClassSymbol *clazz,
-            const std::string &name,
+            yy::Name name,
             const NodeBase *declaredNode
     );
 
     void setClazz(const ClassSymbol *clazz);
 
+    static bool classof(const Symbol *symbol) noexcept {
+        return symbol->symbol_kind() == SymbolKind::Instance;
+    }
+
     InstanceSymbolKind kind() const;
 
     const ClassSymbol *clazz() const noexcept;
@@ -71,10 +87,14 @@ public:
             const ClassSymbol *clazz,
             std::vector<ClassSymbol *> &&parameters,
             const ClassSymbol *returnType,
-            const std::string &name,
+            yy::Name name,
             const NodeBase *declaredNode
     );
 
+    static bool classof(const Symbol *symbol) noexcept {
+        return symbol->symbol_kind() == SymbolKind::Method;
+    }
+
     MethodSymbolKind kind() const;
 
     const MethodDefinition *declaredNode() const noexcept override;
@@ -96,7 +116,11 @@ private:
 
 class ClassSymbol : public Symbol {
 public:
-    ClassSymbol(const std::string &name, const NodeBase *declaredNode);
+    ClassSymbol(yy::Name name, const NodeBase *declaredNode);
+
+    static bool classof(const Symbol *symbol) noexcept {
+        return symbol->symbol_kind() == SymbolKind::Class;
+    }
 
     const ClassDefinition *declaredNode() const noexcept override;
 
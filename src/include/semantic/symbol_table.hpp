@@ -5,46 +5,110 @@
 #ifndef OPP_FRONTEND_SYMBOL_TABLE_HPP
 #define OPP_FRONTEND_SYMBOL_TABLE_HPP
 
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "semantic/symbol.hpp"
 
+// A scope: the symbol it was opened for, if any, and the scopes opened for the
+// names declared in it. A name is looked up in the scope, then in the ones
+// around it.
+//
+// The root scope keeps every scope below it in an arena: records of one size,
+// in chunks that never move, which name the scope around them by index. The
+// first few names declared in a scope are kept in its record and found by
+// comparing handles; a scope with more, a class or the root, gets a hash
+// table of them in the arena.
+//
+// A name nothing below the root is declared as, a class or a builtin, is
+// looked up in the root directly, and `this` and the method by the scopes
+// opened for classes and methods only, so neither walks the bodies between.
 class SymbolTable {
 public:
-    SymbolTable(SymbolTable *parent = nullptr, std::unique_ptr<Symbol> &&symbol = {});
+    // The root scope.
+    explicit SymbolTable(std::unique_ptr<Symbol> &&symbol = {});
+
+    SymbolTable(const SymbolTable &) = delete;
+
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    ~SymbolTable();
 
-    SymbolTable *add_symbol(const std::string &name, std::unique_ptr<Symbol> &&symbol);
+    SymbolTable *add_symbol(yy::Name name, std::unique_ptr<Symbol> &&symbol);
 
     SymbolTable *add_child();
 
     Symbol *get_symbol();
 
-    SymbolTable *resolve_symbol(const std::string &name) const noexcept;
+    SymbolTable *resolve_symbol(yy::Name name) const noexcept;
 
-    ClassSymbol *resolve_class(const std::string &name) const noexcept;
+    ClassSymbol *resolve_class(yy::Name name) const noexcept;
 
     ClassSymbol *resolve_this() const noexcept;
 
-    InstanceSymbol *resolve_field(const std::string &class_name, const std::string &field_name) const noexcept;
+    InstanceSymbol *resolve_field(yy::Name class_name, yy::Name field_name) const noexcept;
 
     MethodSymbol *resolve_method(
-            const std::string &class_name,
-            const std::string &method_name,
+            yy::Name class_name,
+            yy::Name method_name,
             const std::vector<ClassSymbol *> &args
     ) const noexcept;
 
     MethodSymbol *method_scope();
 
-    InstanceSymbol *resolve_local(const std::string &name) const noexcept;
+    InstanceSymbol *resolve_local(yy::Name name) const noexcept;
 
     std::string print_debug_info(size_t offset = 0) const;
 
 private:
+    class Arena;
+
+    // A name declared in the scope, and the scope opened for it.
+    struct Entry {
+        yy::Name name;
+        uint32_t scope;
+    };
+
+    // Where a hash table of names is in the arena's storage for them.
+    struct Table {
+        uint32_t offset;
+        uint32_t capacity;
+    };
+
+    static constexpr uint32_t inline_entries = 3;
+
+    SymbolTable(Arena *arena, uint32_t index, uint32_t parent, yy::Name name, std::unique_ptr<Symbol> &&symbol);
+
+    Arena *arena_;
     std::unique_ptr<Symbol> symbol_;
-    std::unordered_map<std::string, std::unique_ptr<SymbolTable>> symbols_;
-    SymbolTable *parent_;
-    std::vector<std::unique_ptr<SymbolTable>> children_;
+    uint32_t index_;
+    uint32_t parent_;
+    // The nearest scope around it, or itself, opened for a class or a method;
+    // none at the root.
+    uint32_t owner_;
+    // What the scope around it declared it as; empty for add_child().
+    yy::Name name_;
+    // symbol_'s, so that a lookup passing by does not load the symbol.
+    yy::Name symbol_name_;
+    // How many names are declared in it: up to inline_entries in entries_,
+    // then in the arena's table at table_.
+    uint32_t size_ = 0;
+    union {
+        Entry entries_[inline_entries];
+        Table table_;
+    };
+
+    // The scope declared as `name` in this one, not around it.
+    SymbolTable *find(yy::Name name) const noexcept;
+
+    static void insert(Entry *table, uint32_t capacity, Entry entry) noexcept;
+
+    const SymbolTable *parent() const noexcept;
+
+    void print_debug_info(std::ostream &out, size_t offset, const std::vector<std::vector<uint32_t>> &below) const;
 };
 
 
@@ -5,7 +5,8 @@
 #ifndef OPP_FRONTEND_SYMBOL_TABLE_INDEX_HPP
 #define OPP_FRONTEND_SYMBOL_TABLE_INDEX_HPP
 
-#include <unordered_map>
+#include <llvm/ADT/DenseMap.h>
+
 #include "semantic/symbol_table.hpp"
 
 
@@ -18,7 +19,9 @@ public:
     SymbolTable &restore(const NodeBase *location);
 
 private:
-    std::unordered_map<const NodeBase *, SymbolTable *> index_;
+    // Open addressing on the node's address: the passes look a scope up for
+    // nearly every node they visit.
+    llvm::DenseMap<const NodeBase *, SymbolTable *> index_;
 };
 
 #endif //OPP_FRONTEND_SYMBOL_TABLE_INDEX_HPP
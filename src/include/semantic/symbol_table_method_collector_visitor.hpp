@@ -44,7 +44,7 @@ namespace yy {
 
         void add_method(
                 MethodSymbolKind kind,
-                const std::string &method_name,
+                yy::Name method_name,
                 const std::vector<std::unique_ptr<ParameterDeclaration>> &parameters,
                 const ClassSymbol *return_type,
                 const NodeBase *node
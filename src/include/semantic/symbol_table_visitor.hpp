@@ -6,81 +6,110 @@
 #define SDK_SYMBOL_TABLE_VISITOR_HPP
 
 
-#include "visitor/recursive_visitor.hpp"
+#include "visitor/iterative_visitor.hpp"
 #include "symbol_table.hpp"
 #include "symbol_table_index.hpp"
 #include "semantic_error.hpp"
 
 namespace yy {
 
-    class SymbolTableVisitor : public RecursiveVisitor<SymbolTable *> {
+    class SymbolTableVisitor : public IterativeVisitor<SymbolTableVisitor> {
     public:
         SymbolTableVisitor(
                 SymbolTable *scope_symbol_table,
                 SymbolTableIndex *symbol_table_index,
                 std::vector<SemanticError> &semantic_errors
-        ) : RecursiveVisitor(),
-            scope_symbol_table_(scope_symbol_table),
+        ) : scope_symbol_table_(scope_symbol_table),
             symbol_table_index_(symbol_table_index),
             semantic_errors_(semantic_errors) {}
 
-        void operator()(const BooleanLiteralExpr &boolean_literal_expr) override;
+        using IterativeVisitor::after;
+        using IterativeVisitor::leave;
 
-        void operator()(const IntegerLiteralExpr &integer_literal_expr) override;
+        bool enter(const BooleanLiteralExpr &boolean_literal_expr);
 
-        void operator()(const RealLiteralExpr &real_literal_expr) override;
+        bool enter(const IntegerLiteralExpr &integer_literal_expr);
 
-        void operator()(const StringLiteralExpr &string_literal_expr) override;
+        bool enter(const RealLiteralExpr &real_literal_expr);
 
-        void operator()(const ThisExpr &this_expr) override;
+        bool enter(const StringLiteralExpr &string_literal_expr);
 
-        void operator()(const FieldAccessExpr &field_access_expr) override;
+        bool enter(const ThisExpr &this_expr);
 
-        void operator()(const MethodCallExpr &method_call_expr) override;
+        bool enter(const FieldAccessExpr &field_access_expr);
 
-        void operator()(const MemberAccess &member_access) override;
+        bool enter(const MethodCallExpr &method_call_expr);
 
-        void operator()(const Body &body) override;
+        bool enter(const MemberAccess &member_access);
 
-        void operator()(const ReturnStmt &return_stmt) override;
+        bool enter(const Body &body);
 
-        void operator()(const AssignmentStmt &assignment_stmt) override;
+        void after(const Body &body, size_t child);
 
-        void operator()(const IfStmt &if_stmt) override;
+        void leave(const Body &body);
 
-        void operator()(const WhileStmt &while_stmt) override;
+        bool enter(const ReturnStmt &return_stmt);
 
-        void operator()(const MemberDeclaration &member_declaration) override;
+        bool enter(const AssignmentStmt &assignment_stmt);
 
-        void operator()(const ParameterDeclaration &parameter_declaration) override;
+        bool enter(const IfStmt &if_stmt);
 
-        void operator()(const VariableDeclaration &variable_declaration) override;
+        bool enter(const WhileStmt &while_stmt);
 
-        void operator()(const ConstructorDeclaration &constructor_declaration) override;
+        bool enter(const MemberDeclaration &member_declaration);
 
-        void operator()(const ConstructorDefinition &constructor_definition) override;
+        bool enter(const ParameterDeclaration &parameter_declaration);
 
-        void operator()(const MethodDeclaration &method_declaration) override;
+        bool enter(const VariableDeclaration &variable_declaration);
 
-        void operator()(const MethodDefinition &method_definition) override;
+        void leave(const VariableDeclaration &variable_declaration);
 
-        void operator()(const ProgramDeclaration &program_declaration) override;
+        bool enter(const ConstructorDeclaration &constructor_declaration);
 
-        void operator()(const ClassDeclaration &class_declaration) override;
+        void after(const ConstructorDeclaration &constructor_declaration, size_t child);
 
-        void operator()(const ClassDefinition &class_definition) override;
+        void leave(const ConstructorDeclaration &constructor_declaration);
 
-        void operator()(const Program &program) override;
+        bool enter(const ConstructorDefinition &constructor_definition);
 
-        ~SymbolTableVisitor() override = default;
+        void after(const ConstructorDefinition &constructor_definition, size_t child);
+
+        void leave(const ConstructorDefinition &constructor_definition);
+
+        bool enter(const MethodDeclaration &method_declaration);
+
+        void after(const MethodDeclaration &method_declaration, size_t child);
+
+        void leave(const MethodDeclaration &method_declaration);
+
+        bool enter(const MethodDefinition &method_definition);
+
+        void after(const MethodDefinition &method_definition, size_t child);
+
+        void leave(const MethodDefinition &method_definition);
+
+        bool enter(const ProgramDeclaration &program_declaration);
+
+        bool enter(const ClassDeclaration &class_declaration);
+
+        bool enter(const ClassDefinition &class_definition);
+
+        void leave(const ClassDefinition &class_definition);
+
+        bool enter(const Program &program);
 
     private:
         SymbolTable *scope_symbol_table_;
+        // The scope a declaration opened, for the statements behind it.
+        SymbolTable *result_ = nullptr;
+        // The scopes to go back to when the bodies, methods and classes being
+        // walked are left, and the scopes of the variables being walked.
+        std::vector<SymbolTable *> scopes_;
         SymbolTableIndex *symbol_table_index_;
         std::vector<SemanticError> &semantic_errors_;
 
         SymbolTable *resolve_method(
-                const std::string &method_name,
+                yy::Name method_name,
                 const std::vector<std::unique_ptr<ParameterDeclaration>> &parameters
         );
     };
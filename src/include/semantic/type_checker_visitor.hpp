@@ -7,54 +7,77 @@
 
 
 
-#include "visitor/recursive_visitor.hpp"
+#include "visitor/iterative_visitor.hpp"
 #include "symbol_table.hpp"
 #include "symbol_table_index.hpp"
 #include "semantic_error.hpp"
 
 namespace yy {
 
-    class TypeCheckerVisitor : public RecursiveVisitor<Symbol *> {
+    class TypeCheckerVisitor : public IterativeVisitor<TypeCheckerVisitor> {
     public:
         TypeCheckerVisitor(
                 SymbolTableIndex *symbol_table_index,
                 std::vector<SemanticError> &semantic_errors
-        ) : RecursiveVisitor(),
-            symbol_table_index_(symbol_table_index),
+        ) : symbol_table_index_(symbol_table_index),
             semantic_errors_(semantic_errors) {}
 
-        void operator()(const BooleanLiteralExpr &boolean_literal_expr) override;
+        using IterativeVisitor::enter;
+        using IterativeVisitor::after;
+        using IterativeVisitor::leave;
 
-        void operator()(const IntegerLiteralExpr &integer_literal_expr) override;
+        bool enter(const BooleanLiteralExpr &boolean_literal_expr);
 
-        void operator()(const RealLiteralExpr &real_literal_expr) override;
+        bool enter(const IntegerLiteralExpr &integer_literal_expr);
 
-        void operator()(const StringLiteralExpr &string_literal_expr) override;
+        bool enter(const RealLiteralExpr &real_literal_expr);
 
-        void operator()(const ThisExpr &this_expr) override;
+        bool enter(const StringLiteralExpr &string_literal_expr);
 
-        void operator()(const FieldAccessExpr &field_access_expr) override;
+        bool enter(const ThisExpr &this_expr);
 
-        void operator()(const MethodCallExpr &method_call_expr) override;
+        bool enter(const FieldAccessExpr &field_access_expr);
 
-        void operator()(const MemberAccess &member_access) override;
+        bool enter(const MethodCallExpr &method_call_expr);
 
-        void operator()(const ReturnStmt &return_stmt) override;
+        void after(const MethodCallExpr &method_call_expr, size_t child);
 
-        void operator()(const AssignmentStmt &assignment_stmt) override;
+        void leave(const MethodCallExpr &method_call_expr);
 
-        void operator()(const IfStmt &if_stmt) override;
+        void after(const MemberAccess &member_access, size_t child);
 
-        void operator()(const WhileStmt &while_stmt) override;
+        void leave(const MemberAccess &member_access);
 
-        void operator()(const ParameterDeclaration &parameter_declaration) override;
+        bool enter(const ReturnStmt &return_stmt);
 
-        void operator()(const VariableDeclaration &variable_declaration) override;
+        void leave(const ReturnStmt &return_stmt);
 
-        ~TypeCheckerVisitor() override = default;
+        bool enter(const AssignmentStmt &assignment_stmt);
+
+        void leave(const AssignmentStmt &assignment_stmt);
+
+        void after(const IfStmt &if_stmt, size_t child);
+
+        void after(const WhileStmt &while_stmt, size_t child);
+
+        bool enter(const ParameterDeclaration &parameter_declaration);
+
+        bool enter(const VariableDeclaration &variable_declaration);
+
+        void leave(const VariableDeclaration &variable_declaration);
 
     private:
+        // The type of the expression walked last.
+        Symbol *result_ = nullptr;
         Symbol* callee_ = nullptr;
+        // The argument types of the calls being walked, one behind the other.
+        std::vector<ClassSymbol *> arguments_;
+        // Where the arguments of each call start, and whether one had no type.
+        std::vector<std::pair<size_t, bool>> calls_;
+        // What enter() looked up for the assignments and variables, and the
+        // returns, being walked.
+        std::vector<InstanceSymbol *> locals_;
+        std::vector<MethodSymbol *> methods_;
         SymbolTableIndex *symbol_table_index_;
         std::vector<SemanticError> &semantic_errors_;
     };
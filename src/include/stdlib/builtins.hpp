@@ -6,13 +6,12 @@
 #define OPP_FRONTEND_BUILTINS_HPP
 
 #include "semantic/symbol_table.hpp"
-#include <string>
 
 namespace oppstd {
-    inline constexpr std::string string_class = "String";
-    inline constexpr std::string integer_class = "Integer";
-    inline constexpr std::string real_class = "Real";
-    inline constexpr std::string bool_class = "Boolean";
+    inline const yy::Name string_class{"String"};
+    inline const yy::Name integer_class{"Integer"};
+    inline const yy::Name real_class{"Real"};
+    inline const yy::Name bool_class{"Boolean"};
 
     void register_builtins(SymbolTable* root_table);
 }
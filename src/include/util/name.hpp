@@ -0,0 +1,59 @@
+#ifndef OPP_FRONTEND_NAME_HPP
+#define OPP_FRONTEND_NAME_HPP
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace yy {
+
+    // An identifier, class name or mangled name, interned: a 32 bit handle into
+    // a pool that holds every distinct string once. Equal names have equal
+    // handles, so comparing or hashing names never looks at their characters.
+    //
+    // The pool is shared by all threads and keeps its strings until the process
+    // ends; a program has a few thousand distinct names.
+    class Name {
+    public:
+        // The empty name.
+        constexpr Name() noexcept = default;
+
+        explicit Name(std::string_view text);
+
+        // The name `text` was interned as, or the empty name if it never was;
+        // for lookups, which should not grow the pool.
+        static Name find(std::string_view text);
+
+        const std::string &str() const noexcept;
+
+        uint32_t id() const noexcept {
+            return id_;
+        }
+
+        bool empty() const noexcept {
+            return id_ == 0;
+        }
+
+        friend bool operator==(Name, Name) noexcept = default;
+
+    private:
+        explicit constexpr Name(uint32_t id) noexcept: id_(id) {}
+
+        uint32_t id_ = 0;
+    };
+
+    inline std::ostream &operator<<(std::ostream &out, Name name) {
+        return out << name.str();
+    }
+}
+
+template<>
+struct std::hash<yy::Name> {
+    size_t operator()(yy::Name name) const noexcept {
+        return name.id();
+    }
+};
+
+#endif //OPP_FRONTEND_NAME_HPP
@@ -0,0 +1,34 @@
+#ifndef OPP_FRONTEND_PROGRAM_GENERATOR_HPP
+#define OPP_FRONTEND_PROGRAM_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace yy {
+
+    // The knobs of a generated program. The same shape always gives the same text.
+    struct ProgramShape {
+        size_t classes = 100;
+        size_t methods_per_class = 10;
+        // Levels of while and if statements nested in a method body.
+        size_t body_depth = 2;
+        // Links of a member access such as `this.m1(2).m0().f1`.
+        size_t chain_length = 3;
+        // Relative weights of the literal kinds; a zero weight leaves the kind out.
+        unsigned integer_literals = 4;
+        unsigned real_literals = 2;
+        unsigned string_literals = 1;
+        unsigned boolean_literals = 1;
+        uint32_t seed = 1;
+    };
+
+    // A syntactically valid O++ program of the given shape, ending in a Main class
+    // and its constructor call. Classes C0, C1, ... may extend an earlier class,
+    // and every class has fields f0, f1, f2, a constructor and methods m0, m1, ...
+    // Method mK has K % 4 parameters, so calls agree with the declarations, but
+    // member access chains are not type checked and draw semantic errors.
+    std::string generate_program(const ProgramShape &shape);
+}
+
+#endif //OPP_FRONTEND_PROGRAM_GENERATOR_HPP
@@ -5,10 +5,15 @@
 #ifndef OPP_FRONTEND_TOKEN_UTILS_HPP
 #define OPP_FRONTEND_TOKEN_UTILS_HPP
 
+#include <array>
 #include <string>
 #include "parser/parser.tab.hpp"
 
 namespace yy {
     std::string token_to_string(yy::parser::symbol_kind::symbol_kind_type token);
+
+    // symbol_type can only be built from external token numbers; the token number
+    // of every symbol kind, inverting the parser's translation.
+    const std::array<int, yy::parser::symbol_kind::YYNTOKENS> &token_numbers();
 }
 #endif //OPP_FRONTEND_TOKEN_UTILS_HPP
@@ -0,0 +1,82 @@
+#ifndef OPP_FRONTEND_TRACE_HPP
+#define OPP_FRONTEND_TRACE_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace llvm {
+    class raw_ostream;
+}
+
+namespace yy {
+
+    enum class TraceChannel : uint8_t {
+        Tokens,
+        Ast,
+        Symbols,
+        Semantic,
+    };
+
+    inline constexpr size_t trace_channel_count = static_cast<size_t>(TraceChannel::Semantic) + 1;
+
+    // Info is what the frontend used to print unconditionally, Debug adds
+    // locations and per pass progress.
+    enum class TraceLevel : uint8_t {
+        Off,
+        Info,
+        Debug,
+    };
+
+    // Compiler traces, grouped in channels that are switched on one by one. Every
+    // channel is off by default, and checking a disabled one is a single byte
+    // compare, so call sites guard their formatting with enabled().
+    //
+    // Output goes to one buffered sink: stdout unless redirected to a file, a file
+    // descriptor or a string. Diagnostics such as semantic errors are not traces
+    // and keep going to stderr.
+    class Trace {
+    public:
+        Trace();
+
+        Trace(const Trace &) = delete;
+
+        Trace &operator=(const Trace &) = delete;
+
+        ~Trace();
+
+        bool enabled(TraceChannel channel, TraceLevel level = TraceLevel::Info) const noexcept {
+            return levels_[static_cast<size_t>(channel)] >= level;
+        }
+
+        void enable(TraceChannel channel, TraceLevel level = TraceLevel::Info) noexcept;
+
+        // Parses a comma separated list of `channel[:level]`, where channel is one of
+        // tokens, ast, symbols, semantic or all, and level is off, info or debug.
+        // Returns false and changes nothing on a malformed spec.
+        bool configure(std::string_view spec);
+
+        // Throws std::runtime_error if the file cannot be created.
+        void to_file(const std::string &path);
+
+        // The descriptor is not closed by the trace.
+        void to_fd(int fd);
+
+        // Appends to `buffer`, which must outlive the trace or the next redirect.
+        void to_string(std::string &buffer);
+
+        llvm::raw_ostream &stream();
+
+        void flush();
+
+    private:
+        std::array<TraceLevel, trace_channel_count> levels_{};
+        std::unique_ptr<llvm::raw_ostream> sink_;
+    };
+
+    std::string_view trace_channel_name(TraceChannel channel);
+}
+
+#endif //OPP_FRONTEND_TRACE_HPP
@@ -0,0 +1,414 @@
+#ifndef OPP_FRONTEND_ITERATIVE_VISITOR_HPP
+#define OPP_FRONTEND_ITERATIVE_VISITOR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ast/ast.hpp"
+
+namespace yy {
+
+    // A traversal whose depth is limited only by memory: it recurses while the
+    // nodes nest no deeper than real programs do, which is quicker, and keeps
+    // the work left below that on the heap rather than on the call stack, so
+    // bodies and member access chains may nest as deep as a generator likes.
+    //
+    // Derived is called around every node, for the node's class and without
+    // virtual calls:
+    //
+    //     bool enter(const Node &node);               before the children;
+    //                                                 false skips them and leave()
+    //     void after(const Node &node, size_t child); once child number `child`
+    //                                                 is done, entered or not
+    //     void leave(const Node &node);               after the children
+    //
+    // and pulls in the defaults for the other classes with using declarations.
+    // The defaults return Default, and the walk leaves them out: a pass pays
+    // only for the calls it has. A root that is not const is walked as it is:
+    // the hooks may take `Node &` and change the nodes, e.g. move them.
+    //
+    // Children come in the order of RecursiveVisitor's traversal, so a pass
+    // that does in enter() what its operator() did before visiting the
+    // children, in after() what it did in between and in leave() what it did
+    // last does what it did before, in the same order.
+    template<class Derived>
+    class IterativeVisitor {
+    public:
+        struct Default {
+        };
+
+        // How deep the walk recurses before it goes on on the heap.
+        static constexpr size_t recursion_limit = 256;
+
+        // Walks `root` and everything below it.
+        template<class Node>
+        void visit(Node &root) {
+            static_assert(!is<Node, NodeBase>, "NodeBase is an ambiguous base of VariableDeclaration");
+            descend(root, 0);
+        }
+
+        template<class Node>
+        Default enter(const Node &) {
+            return {};
+        }
+
+        template<class Node>
+        Default after(const Node &, size_t) {
+            return {};
+        }
+
+        template<class Node>
+        Default leave(const Node &) {
+            return {};
+        }
+
+    private:
+        enum class Action : uint8_t {
+            Enter,
+            After,
+            Leave,
+        };
+
+        // `Node` is `Class`, const or not.
+        template<class Node, class Class>
+        static constexpr bool is = std::is_same_v<std::remove_const_t<Node>, Class>;
+
+        // `Class`, const if `Node` is.
+        template<class Node, class Class>
+        using Like = std::conditional_t<std::is_const_v<Node>, const Class, Class>;
+
+        // What is left to do with a node. A variable is kept as the NodeBase
+        // of the member or of the statement it is stored as.
+        template<class Base>
+        struct Step {
+            Base *node;
+            uint32_t child;
+            NodeKind kind;
+            Action action;
+            bool member;
+        };
+
+        // The work left of walks of const nodes, and of the others.
+        std::vector<Step<const NodeBase>> work_;
+        std::vector<Step<NodeBase>> mutable_work_;
+
+        template<class Base>
+        std::vector<Step<Base>> &work() {
+            if constexpr (std::is_const_v<Base>) {
+                return work_;
+            } else {
+                return mutable_work_;
+            }
+        }
+
+        template<class Node>
+        static constexpr bool enters = !std::is_same_v<
+                decltype(std::declval<Derived &>().enter(std::declval<Node &>())), Default>;
+
+        template<class Node>
+        static constexpr bool afters = !std::is_same_v<
+                decltype(std::declval<Derived &>().after(std::declval<Node &>(), size_t{})), Default>;
+
+        template<class Node>
+        static constexpr bool leaves = !std::is_same_v<
+                decltype(std::declval<Derived &>().leave(std::declval<Node &>())), Default>;
+
+        Derived &derived() {
+            return static_cast<Derived &>(*this);
+        }
+
+        template<class Node>
+        void descend(Node &node, size_t depth) {
+            if (depth == recursion_limit) {
+                walk(node);
+                return;
+            }
+            with_node(node, [&](auto &concrete) {
+                using Concrete = std::remove_reference_t<decltype(concrete)>;
+                if constexpr (enters<Concrete>) {
+                    if (!derived().enter(concrete)) {
+                        return;
+                    }
+                }
+                children(concrete, [&](uint32_t index, auto &child) {
+                    descend(child, depth + 1);
+                    if constexpr (afters<Concrete>) {
+                        derived().after(concrete, index);
+                    }
+                });
+                if constexpr (leaves<Concrete>) {
+                    derived().leave(concrete);
+                }
+            });
+        }
+
+        // The same on the heap: the work left is taken from the back of work_.
+        template<class Node>
+        void walk(Node &root) {
+            using Base = Like<Node, NodeBase>;
+            auto &work = this->work<Base>();
+            const size_t bottom = work.size();
+            push(root, Action::Enter);
+            while (work.size() > bottom) {
+                const Step<Base> step = work.back();
+                work.pop_back();
+                with_node(step, [&](auto &node) {
+                    take(node, step);
+                });
+            }
+        }
+
+        template<class Node, class Base>
+        void take(Node &node, const Step<Base> &step) {
+            if (step.action == Action::Enter) {
+                if constexpr (enters<Node>) {
+                    if (!derived().enter(node)) {
+                        return;
+                    }
+                }
+                if constexpr (leaves<Node>) {
+                    push(node, Action::Leave);
+                }
+                // Each child with the after() that follows it, last first.
+                auto &work = this->work<Base>();
+                const size_t first = work.size();
+                children(node, [&](uint32_t index, auto &child) {
+                    push(child, Action::Enter);
+                    if constexpr (afters<Node>) {
+                        push(node, Action::After, index);
+                    }
+                });
+                std::reverse(work.begin() + first, work.end());
+            } else if (step.action == Action::After) {
+                if constexpr (afters<Node>) {
+                    derived().after(node, step.child);
+                }
+            } else {
+                if constexpr (leaves<Node>) {
+                    derived().leave(node);
+                }
+            }
+        }
+
+        template<class Node>
+        void push(Node &node, Action action, uint32_t child = 0) {
+            auto &work = this->work<Like<Node, NodeBase>>();
+            if constexpr (is<Node, VariableDeclaration>) {
+                work.push_back({static_cast<Like<Node, BodyExpr> *>(&node), child, NodeKind::Variable, action, false});
+            } else {
+                work.push_back({&node, child, node.kind(), action,
+                                std::is_base_of_v<MemberDeclarationExpr, std::remove_const_t<Node>>});
+            }
+        }
+
+        // The children in `nodes` of `Parent`, as const as it is.
+        template<class Parent, class Node, class Call>
+        static void each(const std::vector<std::unique_ptr<Node>> &nodes, Call &&call) {
+            for (size_t index = 0; index < nodes.size(); index++) {
+                call(static_cast<uint32_t>(index), static_cast<Like<Parent, Node> &>(*nodes[index]));
+            }
+        }
+
+        // Calls `call` with the number and node of every child, in order. The
+        // leaves have none.
+        template<class Node, class Call>
+        static void children(Node &, Call &&) {}
+
+        template<class Node, class Call> requires is<Node, MethodCallExpr>
+        static void children(Node &node, Call &&call) {
+            each<Node>(node.arguments(), call);
+        }
+
+        template<class Node, class Call> requires is<Node, MemberAccess>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.lhs());
+            call(1, *node.rhs());
+        }
+
+        template<class Node, class Call> requires is<Node, Body>
+        static void children(Node &node, Call &&call) {
+            each<Node>(node.expressions(), call);
+        }
+
+        template<class Node, class Call> requires is<Node, ReturnStmt>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.expression());
+        }
+
+        template<class Node, class Call> requires is<Node, AssignmentStmt>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.expression());
+        }
+
+        template<class Node, class Call> requires is<Node, IfStmt>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.condition());
+            call(1, *node.then_body());
+            if (node.else_body()) {
+                call(2, *node.else_body());
+            }
+        }
+
+        template<class Node, class Call> requires is<Node, WhileStmt>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.condition());
+            call(1, *node.loop_body());
+        }
+
+        template<class Node, class Call> requires is<Node, MemberDeclaration>
+        static void children(Node &node, Call &&call) {
+            each<Node>(node.member_declarations(), call);
+        }
+
+        template<class Node, class Call> requires is<Node, VariableDeclaration>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.initializer());
+        }
+
+        template<class Node, class Call> requires is<Node, ConstructorDeclaration>
+        static void children(Node &node, Call &&call) {
+            each<Node>(node.parameters(), call);
+        }
+
+        template<class Node, class Call> requires is<Node, ConstructorDefinition>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.header());
+            call(1, *node.body());
+        }
+
+        template<class Node, class Call> requires is<Node, MethodDeclaration>
+        static void children(Node &node, Call &&call) {
+            each<Node>(node.parameters(), call);
+        }
+
+        template<class Node, class Call> requires is<Node, MethodDefinition>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.header());
+            call(1, *node.body());
+        }
+
+        template<class Node, class Call> requires is<Node, ProgramDeclaration>
+        static void children(Node &node, Call &&call) {
+            each<Node>(node.class_declarations(), call);
+        }
+
+        template<class Node, class Call> requires is<Node, ClassDefinition>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.header());
+            call(1, *node.body());
+        }
+
+        template<class Node, class Call> requires is<Node, Program>
+        static void children(Node &node, Call &&call) {
+            call(0, *node.class_declarations());
+            call(1, *node.main_class());
+        }
+
+        template<class Base, class Call>
+        static void with_node(const Step<Base> &step, Call &&call) {
+            if (step.kind != NodeKind::Variable) {
+                with_node(*step.node, call);
+            } else if (step.member) {
+                call(*static_cast<Like<Base, VariableDeclaration> *>(static_cast<Like<Base, MemberDeclarationExpr> *>(step.node)));
+            } else {
+                call(*static_cast<Like<Base, VariableDeclaration> *>(static_cast<Like<Base, BodyExpr> *>(step.node)));
+            }
+        }
+
+        // Calls `call` with `node` as its class, by a switch on its kind rather
+        // than a virtual call; a variable is not reached through NodeBase.
+        template<class Node, class Call>
+        static void with_node(Node &node, Call &&call) {
+            switch (node.kind()) {
+                case NodeKind::BooleanLiteral:
+                    dispatch<BooleanLiteralExpr>(node, call);
+                    break;
+                case NodeKind::IntegerLiteral:
+                    dispatch<IntegerLiteralExpr>(node, call);
+                    break;
+                case NodeKind::RealLiteral:
+                    dispatch<RealLiteralExpr>(node, call);
+                    break;
+                case NodeKind::StringLiteral:
+                    dispatch<StringLiteralExpr>(node, call);
+                    break;
+                case NodeKind::This:
+                    dispatch<ThisExpr>(node, call);
+                    break;
+                case NodeKind::FieldAccess:
+                    dispatch<FieldAccessExpr>(node, call);
+                    break;
+                case NodeKind::MethodCall:
+                    dispatch<MethodCallExpr>(node, call);
+                    break;
+                case NodeKind::MemberAccess:
+                    dispatch<MemberAccess>(node, call);
+                    break;
+                case NodeKind::Return:
+                    dispatch<ReturnStmt>(node, call);
+                    break;
+                case NodeKind::Assignment:
+                    dispatch<AssignmentStmt>(node, call);
+                    break;
+                case NodeKind::If:
+                    dispatch<IfStmt>(node, call);
+                    break;
+                case NodeKind::While:
+                    dispatch<WhileStmt>(node, call);
+                    break;
+                case NodeKind::Variable:
+                    dispatch<VariableDeclaration>(node, call);
+                    break;
+                case NodeKind::ConstructorDeclaration:
+                    dispatch<ConstructorDeclaration>(node, call);
+                    break;
+                case NodeKind::ConstructorDefinition:
+                    dispatch<ConstructorDefinition>(node, call);
+                    break;
+                case NodeKind::MethodDeclaration:
+                    dispatch<MethodDeclaration>(node, call);
+                    break;
+                case NodeKind::MethodDefinition:
+                    dispatch<MethodDefinition>(node, call);
+                    break;
+                case NodeKind::ClassDeclaration:
+                    dispatch<ClassDeclaration>(node, call);
+                    break;
+                case NodeKind::ClassDefinition:
+                    dispatch<ClassDefinition>(node, call);
+                    break;
+                case NodeKind::Body:
+                    dispatch<Body>(node, call);
+                    break;
+                case NodeKind::MemberDeclaration:
+                    dispatch<MemberDeclaration>(node, call);
+                    break;
+                case NodeKind::Parameter:
+                    dispatch<ParameterDeclaration>(node, call);
+                    break;
+                case NodeKind::ProgramDeclaration:
+                    dispatch<ProgramDeclaration>(node, call);
+                    break;
+                case NodeKind::Program:
+                    dispatch<Program>(node, call);
+                    break;
+            }
+        }
+
+        template<class Concrete, class Node, class Call>
+        static void dispatch(Node &node, Call &&call) {
+            using Base = std::remove_const_t<Node>;
+            if constexpr (std::is_base_of_v<Base, Concrete> && !std::is_same_v<Base, NodeBase>) {
+                call(static_cast<Like<Node, Concrete> &>(node));
+            } else if constexpr (std::is_same_v<Base, NodeBase> && !std::is_same_v<Concrete, VariableDeclaration>) {
+                call(static_cast<Like<Node, Concrete> &>(node));
+            }
+        }
+    };
+}
+
+#endif //OPP_FRONTEND_ITERATIVE_VISITOR_HPP
@@ -4,12 +4,106 @@
 
 #include "lexer/buffered_reader.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 #include <utility>
 
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/StringSaver.h>
+
 namespace yy {
 
-    BufferedReader::BufferedReader(std::string buffer) : buffer_(std::move(buffer)) {
+    struct BufferedReader::Stream {
+        Stream(int fd, size_t window)
+                : fd(fd), window(std::make_unique<char[]>(window)),
+                  capacity(window), max_token(window / 2), strings(allocator) {}
+
+        ~Stream() {
+            if (owns_fd) {
+                llvm::sys::fs::closeFile(native);
+            }
+        }
+
+        int fd;
+        bool owns_fd = false;
+        llvm::sys::fs::file_t native = llvm::sys::fs::convertFDToNativeFile(fd);
+        bool at_end = false;
+        std::unique_ptr<char[]> window;
+        size_t capacity;
+        size_t max_token;
+        llvm::BumpPtrAllocator allocator;
+        llvm::UniqueStringSaver strings;
+    };
+
+    BufferedReader::BufferedReader(std::string buffer)
+            : storage_(std::make_unique<const std::string>(std::move(buffer))), buffer_(*storage_) {
+
+    }
+
+    BufferedReader::BufferedReader(std::string_view buffer) noexcept: buffer_(buffer) {
+
+    }
+
+    BufferedReader BufferedReader::stream(int fd, size_t window) {
+        BufferedReader reader{std::string_view()};
+        reader.stream_ = std::make_unique<Stream>(fd, std::max<size_t>(window, 2));
+        reader.refill_at_ = 0;
+        return reader;
+    }
+
+    BufferedReader BufferedReader::open_stream(const std::string &path, size_t window) {
+        if (path == "-") {
+            return stream(0, window);
+        }
+        int fd;
+        if (llvm::sys::fs::openFileForRead(path, fd)) {
+            throw std::runtime_error("Cant open file: " + path);
+        }
+        BufferedReader reader = stream(fd, window);
+        reader.stream_->owns_fd = true;
+        return reader;
+    }
+
+    BufferedReader::BufferedReader(BufferedReader &&other) noexcept = default;
+
+    BufferedReader &BufferedReader::operator=(BufferedReader &&other) noexcept = default;
+
+    BufferedReader::~BufferedReader() = default;
+
+    void BufferedReader::refill() {
+        Stream &stream = *stream_;
+        size_t size = buffer_.size() - offset_;
+        window_offset_ += offset_;
+        std::memmove(stream.window.get(), buffer_.data() + offset_, size);
+
+        while (size < stream.capacity && !stream.at_end) {
+            auto read = llvm::sys::fs::readNativeFile(
+                    stream.native,
+                    llvm::MutableArrayRef<char>(stream.window.get() + size, stream.capacity - size)
+            );
+            if (!read) {
+                throw std::runtime_error("Cant read input: " + llvm::toString(read.takeError()));
+            }
+            size += *read;
+            stream.at_end = *read == 0;
+        }
+
+        buffer_ = {stream.window.get(), size};
+        offset_ = 0;
+        refill_at_ = stream.at_end ? static_cast<size_t>(-1) : size - stream.max_token;
+    }
 
+    bool BufferedReader::exhausted() const noexcept {
+        return !stream_ || stream_->at_end;
+    }
+
+    std::string_view BufferedReader::save(std::string_view text) {
+        llvm::StringRef saved = stream_->strings.save(llvm::StringRef(text.data(), text.size()));
+        return {saved.data(), saved.size()};
     }
 
     size_t BufferedReader::offset() const {
@@ -31,15 +125,11 @@ namespace yy {
         return buffer_[offset_++];
     }
 
-    const std::string &BufferedReader::content() const {
+    std::string_view BufferedReader::content() const {
         return buffer_;
     }
 
-    std::string BufferedReader::substring(size_t start, size_t delta) const {
+    std::string_view BufferedReader::substring(size_t start, size_t delta) const {
         return buffer_.substr(start, offset_ + delta);
     }
-
-    bool BufferedReader::eof() const {
-        return offset_ > buffer_.size() - 1;
-    }
-}
\ No newline at end of file
+}
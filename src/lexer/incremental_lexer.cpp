@@ -0,0 +1,149 @@
+#include "lexer/incremental_lexer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/scanner.hpp"
+#include "util/token_utils.hpp"
+
+namespace {
+    using kind = yy::parser::symbol_kind;
+
+    yy::LexedToken lex_token(yy::Scanner &scanner, const char *text) {
+        yy::LexedToken token{};
+        try {
+            auto symbol = scanner.get_token();
+            token.kind = symbol.kind();
+            token.location = symbol.location;
+            switch (token.kind) {
+                case kind::S_INTEGER_LITERAL:
+                    token.integer = symbol.value.as<int>();
+                    break;
+                case kind::S_REAL_LITERAL:
+                    token.real = symbol.value.as<double>();
+                    break;
+                case kind::S_BOOLEAN_LITERAL:
+                    token.boolean = symbol.value.as<bool>();
+                    break;
+                default:
+                    break;
+            }
+        } catch (const yy::parser::syntax_error &error) {
+            token.kind = kind::S_YYerror;
+            token.location = error.location;
+        }
+        token.offset = scanner.token_start() - text;
+        token.length = static_cast<uint32_t>(scanner.cursor() - scanner.token_start());
+        return token;
+    }
+}
+
+namespace yy {
+
+    IncrementalLexer::IncrementalLexer(std::string text, const std::string &filename)
+            : text_(std::move(text)), file_(SourceManager::add(filename, text_)) {
+        Scanner scanner{BufferedReader(std::string_view(text_)), SourceLoc{file_.id(), 0}};
+        do {
+            tokens_.push_back(lex_token(scanner, text_.data()));
+        } while (tokens_.back().kind != kind::S_YYEOF);
+    }
+
+    TokenRange IncrementalLexer::apply(const TextEdit &edit) {
+        if (edit.offset > text_.size() || edit.removed > text_.size() - edit.offset) {
+            throw std::runtime_error("Cant apply edit: it runs past the end of the text");
+        }
+        const size_t removed = edit.removed;
+        text_.replace(edit.offset, removed, edit.inserted);
+        SourceManager::replace_text(file_.id(), text_);
+        const ptrdiff_t delta = static_cast<ptrdiff_t>(edit.inserted.size()) - static_cast<ptrdiff_t>(removed);
+        const size_t edit_end = edit.offset + edit.inserted.size();
+
+        // A token that ends right at the edit may grow into it; every token in
+        // front of that one decided where it ends on a byte before the edit.
+        auto first = std::partition_point(tokens_.begin(), tokens_.end(), [&](const LexedToken &token) {
+            return token.offset + token.length < edit.offset;
+        });
+        size_t restart = 0;
+        if (first != tokens_.begin()) {
+            restart = first[-1].offset + first[-1].length;
+        }
+
+        Scanner scanner{
+                BufferedReader(std::string_view(text_).substr(restart)),
+                SourceLoc{file_.id(), static_cast<uint32_t>(restart)}
+        };
+
+        std::vector<LexedToken> relexed;
+        TokenRange range;
+        range.delta = delta;
+        auto old = first;
+        for (;;) {
+            LexedToken token = lex_token(scanner, text_.data());
+            if (token.kind == kind::S_YYEOF) {
+                relexed.push_back(token);
+                old = tokens_.end();
+                break;
+            }
+
+            if (token.offset >= edit_end) {
+                // Behind the edit the text is the old one; a token starting where
+                // an old one did is that token, and so is everything after it.
+                size_t old_offset = static_cast<size_t>(static_cast<ptrdiff_t>(token.offset) - delta);
+                while (old->offset < old_offset) {
+                    ++old;
+                }
+                if (old->offset == old_offset && old->kind == token.kind) {
+                    if (delta != 0) {
+                        for (auto it = old; it != tokens_.end(); ++it) {
+                            it->offset += delta;
+                            range.shift(it->location);
+                        }
+                    }
+                    break;
+                }
+            }
+            relexed.push_back(token);
+        }
+
+        range.first = static_cast<size_t>(first - tokens_.begin());
+        range.removed = static_cast<size_t>(old - first);
+        range.inserted = relexed.size();
+        size_t overlap = std::min(range.removed, range.inserted);
+        std::copy_n(relexed.begin(), overlap, first);
+        if (range.removed > overlap) {
+            tokens_.erase(first + overlap, old);
+        } else {
+            tokens_.insert(first + overlap, relexed.begin() + overlap, relexed.end());
+        }
+        return range;
+    }
+
+    parser::symbol_type IncrementalLexer::symbol(size_t index) const {
+        const LexedToken &token = tokens_[index];
+        int number = token_numbers()[token.kind];
+        switch (token.kind) {
+            case kind::S_IDENTIFIER:
+                return {number, lexeme(token), token.location};
+            case kind::S_STRING_LITERAL:
+                return {number, lexeme(token).substr(1, token.length - 2), token.location};
+            case kind::S_INTEGER_LITERAL:
+                return {number, token.integer, token.location};
+            case kind::S_REAL_LITERAL:
+                return {number, token.real, token.location};
+            case kind::S_BOOLEAN_LITERAL:
+                return {number, token.boolean, token.location};
+            case kind::S_YYerror: {
+                Scanner scanner{
+                        BufferedReader(std::string_view(text_).substr(token.offset)),
+                        SourceLoc{file_.id(), static_cast<uint32_t>(token.offset)}
+                };
+                scanner.get_token();
+                return {number, token.location};
+            }
+            default:
+                return {number, token.location};
+        }
+    }
+}
@@ -1,17 +1,39 @@
 #include<string>
-#include<iostream>
+#include<sstream>
+#include <llvm/Support/raw_ostream.h>
 #include "parser/parser.tab.hpp"
 #include "util/token_utils.hpp"
+#include "util/trace.hpp"
 #include "lexer/scanner.hpp"
 
 
 namespace yy {
 
+    static void trace_token(Trace &trace, const parser::symbol_type &token) {
+        auto &out = trace.stream();
+        out << token_to_string(token.kind());
+
+        if (trace.enabled(TraceChannel::Tokens, TraceLevel::Debug)) {
+            std::ostringstream location;
+            location << token.location;
+            out << ' ' << location.str();
+
+            if (token.kind() == parser::symbol_kind::S_IDENTIFIER
+                || token.kind() == parser::symbol_kind::S_STRING_LITERAL) {
+                auto text = token.value.as<std::string_view>();
+                out << ' ' << llvm::StringRef(text.data(), text.size());
+            }
+        }
+        out << '\n';
+    }
+
     parser::symbol_type yylex(Scanner &scanner) {
-        parser::symbol_type &&token = scanner.get_token();
-        std::cout << token_to_string(token.kind()) << std::endl;
-        return std::forward<parser::symbol_type>(std::move(token));
+        parser::symbol_type token = scanner.get_token();
+        if (Trace *trace = scanner.trace(); trace && trace->enabled(TraceChannel::Tokens)) [[unlikely]] {
+            trace_token(*trace, token);
+        }
+        return token;
     }
 
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,191 @@
+#include "lexer/parallel_lexer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/char_class.hpp"
+#include "lexer/scanner.hpp"
+#include "util/token_utils.hpp"
+
+namespace {
+    using kind = yy::parser::symbol_kind;
+}
+
+namespace yy {
+
+    std::vector<size_t> find_split_points(std::string_view source, size_t chunk_size) {
+        constexpr std::string_view keyword = "\nclass";
+
+        std::vector<size_t> splits;
+        size_t from = chunk_size;
+        while (from < source.size()) {
+            size_t at = source.find(keyword, from);
+            if (at == std::string_view::npos) {
+                break;
+            }
+            size_t split = at + 1;
+            size_t after = at + keyword.size();
+            // `classes` is an identifier, not the keyword.
+            if (after == source.size() || is_spliterator(source[after])) {
+                splits.push_back(split);
+                from = split + chunk_size;
+            } else {
+                from = split;
+            }
+        }
+        return splits;
+    }
+
+    ParallelLexer::ParallelLexer(
+            std::string_view source,
+            unsigned threads,
+            size_t chunk_size
+    ) : source_(source), window_(2 * std::max(threads, 1u)),
+        pool_(std::make_unique<llvm::ThreadPool>(llvm::hardware_concurrency(std::max(threads, 1u)))) {
+        std::vector<size_t> splits = find_split_points(source, chunk_size);
+        splits.push_back(source.size());
+
+        // Sized once: a chunk is not copyable and moving one may throw.
+        chunks_ = std::vector<Chunk>(splits.size());
+        size_t begin = 0;
+        for (size_t i = 0; i < splits.size(); i++) {
+            chunks_[i].begin = begin;
+            chunks_[i].stop = splits[i];
+            begin = splits[i];
+        }
+
+        for (size_t i = 0; i < std::min(window_, chunks_.size()); i++) {
+            submit(i);
+        }
+        chunks_.front().done.get();
+    }
+
+    ParallelLexer::~ParallelLexer() {
+        // A parse that stopped early leaves chunks being lexed ahead of it.
+        cancelled_.store(true, std::memory_order_relaxed);
+        pool_->wait();
+    }
+
+    void ParallelLexer::submit(size_t index) {
+        if (index < chunks_.size()) {
+            chunks_[index].done = pool_->async([this, index] {
+                lex(chunks_[index]);
+            });
+        }
+    }
+
+    void ParallelLexer::lex(Chunk &chunk) const {
+        Scanner scanner{BufferedReader(source_.substr(chunk.begin)), SourceLoc{0, static_cast<uint32_t>(chunk.begin)}};
+        const char *stop = source_.data() + chunk.stop;
+
+        // Code averages five to six bytes per token, whitespace included.
+        chunk.lexemes.reserve((chunk.stop - chunk.begin) / 5);
+        chunk.end = chunk.begin;
+        while (!cancelled_.load(std::memory_order_relaxed)) {
+            Lexeme lexeme{};
+            try {
+                auto token = scanner.get_token();
+                lexeme.kind = token.kind();
+                if (lexeme.kind != kind::S_YYEOF && scanner.token_start() >= stop) {
+                    return;
+                }
+                lexeme.begin = token.location.begin.offset;
+                lexeme.end = token.location.end.offset;
+                switch (lexeme.kind) {
+                    case kind::S_IDENTIFIER:
+                    case kind::S_STRING_LITERAL: {
+                        auto text = token.value.as<std::string_view>();
+                        lexeme.text = text.data();
+                        lexeme.length = static_cast<uint32_t>(text.size());
+                        break;
+                    }
+                    case kind::S_INTEGER_LITERAL:
+                        lexeme.integer = token.value.as<int>();
+                        break;
+                    case kind::S_REAL_LITERAL:
+                        lexeme.real = token.value.as<double>();
+                        break;
+                    case kind::S_BOOLEAN_LITERAL:
+                        lexeme.boolean = token.value.as<bool>();
+                        break;
+                    default:
+                        break;
+                }
+            } catch (const parser::syntax_error &error) {
+                if (scanner.token_start() >= stop) {
+                    return;
+                }
+                lexeme.kind = kind::S_YYerror;
+                lexeme.end = error.location.end.offset;
+                chunk.errors.push_back(error);
+            }
+
+            chunk.end = scanner.cursor() - source_.data();
+            chunk.lexemes.push_back(lexeme);
+            if (lexeme.kind == kind::S_YYEOF) {
+                return;
+            }
+        }
+    }
+
+    void ParallelLexer::advance() {
+        Chunk &last = chunks_[current_];
+        size_t end = last.end;
+        std::vector<Lexeme>().swap(last.lexemes);
+
+        submit(++current_ + window_ - 1);
+        Chunk &chunk = chunks_[current_];
+        chunk.done.get();
+
+        if (chunk.begin < end) {
+            // The last token before the cut, a string, ran into this chunk.
+            chunk.lexemes.clear();
+            chunk.errors.clear();
+            chunk.begin = end;
+            lex(chunk);
+        }
+    }
+
+    parser::symbol_type ParallelLexer::next(uint32_t file) {
+        for (;;) {
+            Chunk &chunk = chunks_[current_];
+            if (chunk.next_lexeme < chunk.lexemes.size()) {
+                const Lexeme &lexeme = chunk.lexemes[chunk.next_lexeme++];
+                if (lexeme.kind == kind::S_YYerror) [[unlikely]] {
+                    parser::syntax_error error = std::move(chunk.errors.front());
+                    chunk.errors.pop_front();
+                    error.location.begin.file = file;
+                    error.location.end.file = file;
+                    throw error;
+                }
+
+                SourceRange location{{file, lexeme.begin}, {file, lexeme.end}};
+                int token = token_numbers()[lexeme.kind];
+                switch (lexeme.kind) {
+                    case kind::S_IDENTIFIER:
+                    case kind::S_STRING_LITERAL:
+                        return {token, std::string_view(lexeme.text, lexeme.length), std::move(location)};
+                    case kind::S_INTEGER_LITERAL:
+                        return {token, lexeme.integer, std::move(location)};
+                    case kind::S_REAL_LITERAL:
+                        return {token, lexeme.real, std::move(location)};
+                    case kind::S_BOOLEAN_LITERAL:
+                        return {token, lexeme.boolean, std::move(location)};
+                    default:
+                        return {token, std::move(location)};
+                }
+            }
+            if (current_ + 1 == chunks_.size()) {
+                // Past the end of file, like a scanner asked again.
+                SourceLoc end{file, static_cast<uint32_t>(chunk.end)};
+                return parser::make_YYEOF({end, end});
+            }
+            advance();
+        }
+    }
+}
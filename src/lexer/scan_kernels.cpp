@@ -0,0 +1,318 @@
+#include "lexer/scan_kernels.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "lexer/char_class.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OPP_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(OPP_SCAN_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define OPP_SCAN_AVX2 1
+#define OPP_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    // Appends the line starts behind the newline bits of the block at `offset`.
+    inline void push_line_starts(uint32_t mask, uint32_t offset, std::vector<uint32_t> &starts) {
+        for (; mask; mask &= mask - 1) {
+            starts.push_back(offset + std::countr_zero(mask) + 1);
+        }
+    }
+
+    inline uint32_t offset_of(const char *at, const char *begin, uint32_t offset) {
+        return offset + static_cast<uint32_t>(at - begin);
+    }
+
+    // BEGIN SCALAR KERNELS
+
+    const char *skip_whitespace_scalar(const char *begin, const char *end) {
+        while (begin != end && yy::is_whitespace(*begin)) {
+            ++begin;
+        }
+        return begin;
+    }
+
+    const char *find_spliterator_scalar(const char *begin, const char *end) {
+        while (begin != end && !yy::is_spliterator(*begin)) {
+            ++begin;
+        }
+        return begin;
+    }
+
+    const char *find_quote_scalar(const char *begin, const char *end) {
+        while (begin != end && *begin != '\'') {
+            ++begin;
+        }
+        return begin;
+    }
+
+    void find_line_starts_scalar(const char *begin, const char *end, uint32_t offset, std::vector<uint32_t> &starts) {
+        for (const char *at = begin; at != end; ++at) {
+            if (*at == '\n') {
+                starts.push_back(offset_of(at, begin, offset) + 1);
+            }
+        }
+    }
+
+    constexpr yy::ScanKernels scalar_kernels{
+            "scalar",
+            skip_whitespace_scalar,
+            find_spliterator_scalar,
+            find_quote_scalar,
+            find_line_starts_scalar,
+    };
+
+    // END SCALAR KERNELS
+
+#ifdef OPP_SCAN_SSE2
+
+    // BEGIN SSE2 KERNELS
+
+    template<char... Chars>
+    inline __m128i any_of_sse2(__m128i block) {
+        __m128i mask = _mm_setzero_si128();
+        ((mask = _mm_or_si128(mask, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+        return mask;
+    }
+
+    inline uint32_t whitespace_sse2(__m128i block) {
+        return _mm_movemask_epi8(any_of_sse2<' ', '\t', '\r', '\n'>(block));
+    }
+
+    inline uint32_t spliterator_sse2(__m128i block) {
+        return _mm_movemask_epi8(any_of_sse2<' ', '\t', '\r', '\n', '.', '(', ')', ':', ']', '[', ',', '=', '>'>(block));
+    }
+
+    inline uint32_t byte_sse2(__m128i block, char ch) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(ch)));
+    }
+
+    const char *skip_whitespace_sse2(const char *begin, const char *end) {
+        for (; end - begin >= 16; begin += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            if (uint32_t other = ~whitespace_sse2(block) & 0xFFFF) {
+                return begin + std::countr_zero(other);
+            }
+        }
+        return skip_whitespace_scalar(begin, end);
+    }
+
+    const char *find_spliterator_sse2(const char *begin, const char *end) {
+        for (; end - begin >= 16; begin += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            if (uint32_t stop = spliterator_sse2(block)) {
+                return begin + std::countr_zero(stop);
+            }
+        }
+        return find_spliterator_scalar(begin, end);
+    }
+
+    const char *find_quote_sse2(const char *begin, const char *end) {
+        for (; end - begin >= 16; begin += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            if (uint32_t quotes = byte_sse2(block, '\'')) {
+                return begin + std::countr_zero(quotes);
+            }
+        }
+        return find_quote_scalar(begin, end);
+    }
+
+    void find_line_starts_sse2(const char *begin, const char *end, uint32_t offset, std::vector<uint32_t> &starts) {
+        const char *at = begin;
+        for (; end - at >= 16; at += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(at));
+            push_line_starts(byte_sse2(block, '\n'), offset_of(at, begin, offset), starts);
+        }
+        find_line_starts_scalar(at, end, offset_of(at, begin, offset), starts);
+    }
+
+    constexpr yy::ScanKernels sse2_kernels{
+            "sse2",
+            skip_whitespace_sse2,
+            find_spliterator_sse2,
+            find_quote_sse2,
+            find_line_starts_sse2,
+    };
+
+    // END SSE2 KERNELS
+
+#endif
+
+#ifdef OPP_SCAN_AVX2
+
+    // BEGIN AVX2 KERNELS
+
+    // Splits a byte set into low and high nibble lookup tables, so that a byte is a
+    // member iff low[byte & 15] & high[byte >> 4] is non zero. Rows of the 16x16
+    // byte matrix with equal low nibble sets share one of the eight bits.
+    struct NibbleTables {
+        std::array<uint8_t, 16> low{};
+        std::array<uint8_t, 16> high{};
+    };
+
+    template<class Predicate>
+    constexpr NibbleTables make_nibble_tables(Predicate is_member) {
+        std::array<uint16_t, 16> rows{};
+        for (int byte = 0; byte < 256; byte++) {
+            if (is_member(static_cast<char>(byte))) {
+                rows[byte >> 4] |= uint16_t(1) << (byte & 15);
+            }
+        }
+
+        NibbleTables tables;
+        std::array<uint16_t, 8> bit_rows{};
+        size_t used_bits = 0;
+        for (size_t high = 0; high < 16; high++) {
+            if (!rows[high]) {
+                continue;
+            }
+            size_t bit = 0;
+            while (bit < used_bits && bit_rows[bit] != rows[high]) {
+                bit++;
+            }
+            if (bit == used_bits) {
+                if (used_bits == bit_rows.size()) {
+                    throw "byte set needs more than eight distinct rows";
+                }
+                bit_rows[used_bits++] = rows[high];
+            }
+            tables.high[high] |= uint8_t(1) << bit;
+            for (size_t low = 0; low < 16; low++) {
+                if (rows[high] & (uint16_t(1) << low)) {
+                    tables.low[low] |= uint8_t(1) << bit;
+                }
+            }
+        }
+        return tables;
+    }
+
+    constexpr NibbleTables spliterator_tables = make_nibble_tables(yy::is_spliterator);
+
+    static_assert([] {
+        for (int byte = 0; byte < 256; byte++) {
+            bool member = spliterator_tables.low[byte & 15] & spliterator_tables.high[byte >> 4];
+            if (member != yy::is_spliterator(static_cast<char>(byte))) {
+                return false;
+            }
+        }
+        return true;
+    }());
+
+    OPP_TARGET_AVX2 inline __m256i broadcast_table(const std::array<uint8_t, 16> &table) {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table.data())));
+    }
+
+    OPP_TARGET_AVX2 inline uint32_t byte_avx2(__m256i block, char ch) {
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(ch)));
+    }
+
+    OPP_TARGET_AVX2 inline uint32_t whitespace_avx2(__m256i block) {
+        __m256i mask = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')),
+                                _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\t'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\r')),
+                                _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n')))
+        );
+        return _mm256_movemask_epi8(mask);
+    }
+
+    OPP_TARGET_AVX2 inline uint32_t spliterator_avx2(__m256i block, __m256i low_table, __m256i high_table) {
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(block, nibble));
+        __m256i high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+        __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+        return ~uint32_t(_mm256_movemask_epi8(miss));
+    }
+
+    OPP_TARGET_AVX2 const char *skip_whitespace_avx2(const char *begin, const char *end) {
+        for (; end - begin >= 32; begin += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            if (uint32_t other = ~whitespace_avx2(block)) {
+                return begin + std::countr_zero(other);
+            }
+        }
+        return skip_whitespace_sse2(begin, end);
+    }
+
+    OPP_TARGET_AVX2 const char *find_spliterator_avx2(const char *begin, const char *end) {
+        const __m256i low_table = broadcast_table(spliterator_tables.low);
+        const __m256i high_table = broadcast_table(spliterator_tables.high);
+        for (; end - begin >= 32; begin += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            if (uint32_t stop = spliterator_avx2(block, low_table, high_table)) {
+                return begin + std::countr_zero(stop);
+            }
+        }
+        return find_spliterator_sse2(begin, end);
+    }
+
+    OPP_TARGET_AVX2 const char *find_quote_avx2(const char *begin, const char *end) {
+        for (; end - begin >= 32; begin += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            if (uint32_t quotes = byte_avx2(block, '\'')) {
+                return begin + std::countr_zero(quotes);
+            }
+        }
+        return find_quote_sse2(begin, end);
+    }
+
+    OPP_TARGET_AVX2 void find_line_starts_avx2(
+            const char *begin,
+            const char *end,
+            uint32_t offset,
+            std::vector<uint32_t> &starts
+    ) {
+        const char *at = begin;
+        for (; end - at >= 32; at += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(at));
+            push_line_starts(byte_avx2(block, '\n'), offset_of(at, begin, offset), starts);
+        }
+        find_line_starts_sse2(at, end, offset_of(at, begin, offset), starts);
+    }
+
+    constexpr yy::ScanKernels avx2_kernels{
+            "avx2",
+            skip_whitespace_avx2,
+            find_spliterator_avx2,
+            find_quote_avx2,
+            find_line_starts_avx2,
+    };
+
+    bool cpu_has_avx2() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+
+    // END AVX2 KERNELS
+
+#endif
+}
+
+const yy::ScanKernels &yy::scalar_scan_kernels() noexcept {
+    return scalar_kernels;
+}
+
+const yy::ScanKernels &yy::default_scan_kernels() noexcept {
+    static const ScanKernels &kernels = *available_scan_kernels().back();
+    return kernels;
+}
+
+std::vector<const yy::ScanKernels *> yy::available_scan_kernels() {
+    std::vector<const ScanKernels *> kernels{&scalar_kernels};
+#ifdef OPP_SCAN_SSE2
+    kernels.push_back(&sse2_kernels);
+#endif
+#ifdef OPP_SCAN_AVX2
+    if (cpu_has_avx2()) {
+        kernels.push_back(&avx2_kernels);
+    }
+#endif
+    return kernels;
+}
@@ -4,225 +4,267 @@
 
 #include "lexer/scanner.hpp"
 
+#include <cerrno>
+#include <cstdlib>
 #include <utility>
-#include "lexer/buffered_reader.hpp"
 
-// BEGIN PREDICATES BLOCK
+#include <llvm/ADT/StringRef.h>
 
-static constexpr bool is_special(char peek) noexcept {
-    return peek == '.' || peek == '(' || peek == ')'
-           || peek == ':' || peek == ']' || peek == '['
-           || peek == ',' || peek == '=' || peek == '>';
-}
+#include "lexer/buffered_reader.hpp"
+#include "lexer/char_class.hpp"
+#include "lexer/keywords.hpp"
+#include "lexer/lexer_dfa.hpp"
 
-static constexpr bool is_whitespace(char peek) noexcept {
-    return peek == ' ' || peek == '\t' || peek == '\r' || peek == '\n';
+static llvm::StringRef to_string_ref(std::string_view view) noexcept {
+    return {view.data(), view.size()};
 }
 
-static constexpr bool is_spliterator(char peek) {
-    return is_whitespace(peek) || is_special(peek);
-}
+// strtod needs a terminated string, but the source view is not. Literals are
+// copied to the stack; only absurdly long ones spill to the heap.
+static bool parse_real(std::string_view text, double &value) {
+    char stack_buffer[64];
+    std::string heap_buffer;
+    const char *begin = stack_buffer;
+    if (text.size() < sizeof(stack_buffer)) {
+        text.copy(stack_buffer, text.size());
+        stack_buffer[text.size()] = '\0';
+    } else {
+        heap_buffer = text;
+        begin = heap_buffer.c_str();
+    }
 
-static constexpr bool is_num_spliterator(char peek) {
-    return is_whitespace(peek)
-           || peek == '(' || peek == ')' || peek == ']' || peek == '['
-           || peek == ',' || peek == '=' || peek == '>' || peek == ':';
+    char *end = nullptr;
+    errno = 0;
+    value = std::strtod(begin, &end);
+    return errno == 0 && end == begin + text.size();
 }
 
-// END PREDICATES BLOCK
-
 
 yy::parser::symbol_type yy::Scanner::get_literal_identifier_or_keyword() {
-    begin_token();
-    std::string s;
-
-    while (!reader_.eof() && !is_spliterator(peek())) {
-        s += advance();
-    }
-
-    if (s == "true")
-        return yy::parser::make_BOOLEAN_LITERAL(true, end_token());
-    if (s == "false")
-        return yy::parser::make_BOOLEAN_LITERAL(false, end_token());
-    if (s == "class")
-        return yy::parser::make_CLASS(end_token());
-    if (s == "extends")
-        return yy::parser::make_EXTENDS(end_token());
-    if (s == "is")
-        return yy::parser::make_IS(end_token());
-    if (s == "end")
-        return yy::parser::make_END(end_token());
-    if (s == "this")
-        return yy::parser::make_THIS(end_token());
-    if (s == "method")
-        return yy::parser::make_METHOD(end_token());
-    if (s == "return")
-        return yy::parser::make_RETURN(end_token());
-    if (s == "var")
-        return yy::parser::make_VAR(end_token());
-    if (s == "if")
-        return yy::parser::make_IF(end_token());
-    if (s == "then")
-        return yy::parser::make_THEN(end_token());
-    if (s == "else")
-        return yy::parser::make_ELSE(end_token());
-    if (s == "while")
-        return yy::parser::make_WHILE(end_token());
-    if (s == "loop")
-        return yy::parser::make_LOOP(end_token());
-
-    return yy::parser::make_IDENTIFIER(s, end_token());
+    const char *start = reader_.cursor();
+
+    skip_to(find_word_end(start));
+    check_window(reader_.cursor());
+
+    std::string_view s = lexeme(start);
+
+    if (const Keyword *keyword = find_keyword(s)) {
+        if (keyword->token == yy::parser::token::BOOLEAN_LITERAL) {
+            return yy::parser::make_BOOLEAN_LITERAL(keyword->value, end_token());
+        }
+        return {keyword->token, end_token()};
+    }
+
+    return yy::parser::make_IDENTIFIER(value(start), end_token());
 }
 
 yy::parser::symbol_type yy::Scanner::get_string_literal() {
-    begin_token();
     advance();
 
-    std::string s;
-    while (!reader_.eof() && peek() != '\'') {
-        s += advance();
-    }
+    const char *start = reader_.cursor();
+    skip_to(kernels_.find_quote(start, reader_.end()));
+    check_window(reader_.cursor());
 
     if (reader_.eof()) {
         return yy::parser::make_YYUNDEF(end_token());
     }
+    std::string_view s = value(start);
     advance();
     return yy::parser::make_STRING_LITERAL(s, end_token());
 }
 
-yy::parser::symbol_type yy::Scanner::get_num_literal() {
-    begin_token();
-    size_t dots = 0;
-
-    std::string s;
-    while (!reader_.eof() && !is_num_spliterator(peek())) {
-        if (peek() == '.') {
-            dots++;
-        }
-        s += advance();
-    }
-
-    if (dots > 1) {
+yy::parser::symbol_type yy::Scanner::get_num_literal(LexState state, std::string_view s) {
+    if (state == LexState::BadNumberLiteral) {
         return yy::parser::make_YYUNDEF(end_token());
     }
 
-    if (dots == 1) {
-        return yy::parser::make_REAL_LITERAL(std::stod(s), end_token());
+    if (state == LexState::RealLiteral) {
+        double value;
+        if (!parse_real(s, value)) {
+            throw yy::parser::syntax_error(end_token(), "invalid or out of range real literal: " + std::string(s));
+        }
+        return yy::parser::make_REAL_LITERAL(value, end_token());
     }
 
-    return yy::parser::make_INTEGER_LITERAL(std::stoi(s), end_token());
+    int value;
+    if (to_string_ref(s).getAsInteger(10, value)) {
+        throw yy::parser::syntax_error(end_token(), "invalid or out of range integer literal: " + std::string(s));
+    }
+    return yy::parser::make_INTEGER_LITERAL(value, end_token());
 }
 
 
-yy::parser::symbol_type yy::Scanner::get_special() {
-    begin_token();
-    std::string s;
-
-    while (s.length() < 2) {
-        s += advance();
-
-        if (s == "(")
+yy::parser::symbol_type yy::Scanner::get_special(LexState state) {
+    switch (state) {
+        case LexState::LeftParen:
             return yy::parser::make_LEFT_PAREN(end_token());
-        if (s == ")")
+        case LexState::RightParen:
             return yy::parser::make_RIGHT_PAREN(end_token());
-        if (s == "]")
+        case LexState::RightBracket:
             // TODO: implement "]" token
             return yy::parser::make_LEFT_PAREN(end_token());
-        if (s == "[")
+        case LexState::LeftBracket:
             // TODO: implement "[" token
             return yy::parser::make_RIGHT_PAREN(end_token());
-        if (s == ":" && peek() != '=')
+        case LexState::ColonOperator:
             return yy::parser::make_COLON(end_token());
-        if (s == ",")
+        case LexState::Comma:
             return yy::parser::make_COMMA(end_token());
-        if (s == "=>")
+        case LexState::MemberAccess:
+            return yy::parser::make_MEMBER_ACCESS_OPERATOR(end_token());
+        case LexState::MethodDefinition:
             return yy::parser::make_METHOD_DEFINITION(end_token());
-        if (s == ":=")
+        case LexState::AssignmentOperator:
             return yy::parser::make_ASSIGNMENT_OPERATOR(end_token());
-        if (s == ".")
-            return yy::parser::make_MEMBER_ACCESS_OPERATOR(end_token());
+        default:
+            return yy::parser::make_YYUNDEF(end_token());
     }
-
-    return yy::parser::make_YYUNDEF(end_token());
 }
 
 yy::parser::symbol_type yy::Scanner::get_identifier_or_undef() {
-    begin_token();
-    std::string s;
+    const char *start = reader_.cursor();
 
-    while (!reader_.eof() && !is_spliterator(peek())) {
-        s += advance();
-    }
+    skip_to(find_word_end(start));
+    check_window(reader_.cursor());
 
-    return yy::parser::make_IDENTIFIER(s, end_token());
+    return yy::parser::make_IDENTIFIER(value(start), end_token());
 }
 
 
 yy::Scanner::Scanner(
         yy::BufferedReader reader,
-        const std::string &filename
-) : filename_(filename), reader_(std::move(reader))
-     {}
-
-char yy::Scanner::peek() const {
-    return reader_.peek();
+        const std::string &filename,
+        const ScanKernels &kernels
+) : reader_(std::move(reader)), kernels_(kernels) {
+    registration_ = reader_.streaming()
+            ? SourceManager::add_stream(filename)
+            : SourceManager::add(filename, reader_.content());
+    file_ = registration_.id();
 }
 
-char yy::Scanner::advance() {
-    char ch = reader_.peek();
-    if (ch == '\n') {
-        lines_ += 1;
-        lineOffset_ = 0;
-    } else {
-        lineOffset_++;
-    }
+yy::Scanner::Scanner(
+        yy::BufferedReader reader,
+        SourceLoc start,
+        const ScanKernels &kernels
+) : file_(start.file), start_(start.offset), reader_(std::move(reader)), kernels_(kernels) {}
 
+char yy::Scanner::advance() {
     return reader_.advance();
 }
 
-yy::parser::symbol_type yy::Scanner::get_token() {
-    begin_token();
-    while (!reader_.eof()) {
-        char next = peek();
+const char *yy::Scanner::skip_whitespace(const char *begin) const {
+    const char *end = reader_.end();
+    const char *limit = end - begin > short_run_length ? begin + short_run_length : end;
+    while (begin != limit && is_whitespace(*begin)) {
+        begin++;
+    }
+    if (begin == limit && begin != end) {
+        return kernels_.skip_whitespace(begin, end);
+    }
+    return begin;
+}
 
-        while (is_whitespace(next)) {
-            advance();
+const char *yy::Scanner::find_word_end(const char *begin) const {
+    const char *end = reader_.end();
+    const char *limit = end - begin > short_run_length ? begin + short_run_length : end;
+    while (begin != limit && !is_spliterator(*begin)) {
+        begin++;
+    }
+    if (begin == limit && begin != end) {
+        return kernels_.find_spliterator(begin, end);
+    }
+    return begin;
+}
 
-            if (reader_.eof()) {
-                return parser::make_YYEOF(end_token());
-            }
+void yy::Scanner::fill_window() {
+    // Whitespace may run on past the window, the token behind it has to fit.
+    do {
+        reader_.refill();
+        // The window is gone once the stream moves on; the lines it had are kept.
+        const size_t read = reader_.input_offset(reader_.end());
+        const char *unindexed = reader_.end() - (read - indexed_);
+        SourceManager::record_lines(file_, {unindexed, read - indexed_}, offset(unindexed));
+        indexed_ = read;
+        skip_to(skip_whitespace(reader_.cursor()));
+    } while (reader_.needs_refill());
+}
 
-            next = peek();
-        }
+yy::parser::symbol_type yy::Scanner::get_token() {
+    if (recorder_) [[unlikely]] {
+        return record_token();
+    }
+    return next_token();
+}
 
+yy::parser::symbol_type yy::Scanner::next_token() {
+    if (replay_) [[unlikely]] {
+        return replay_->next(file_);
+    }
+    return scan_token();
+}
 
-        if ('a' <= next && next <= 'z') {
-            return get_literal_identifier_or_keyword();
-        }
+yy::parser::symbol_type yy::Scanner::record_token() {
+    try {
+        auto token = next_token();
+        recorder_->record(token);
+        return token;
+    } catch (...) {
+        // A stream with a lexical error in it is not worth caching.
+        recorder_->abandon();
+        throw;
+    }
+}
 
-        if (next == '\'') {
-            return get_string_literal();
-        }
+yy::parser::symbol_type yy::Scanner::scan_token() {
+    // The end of file token covers trailing whitespace, so it begins here.
+    begin_token();
 
-        if ('0' <= next && next <= '9') {
-            return get_num_literal();
-        }
+    skip_to(skip_whitespace(reader_.cursor()));
+    if (reader_.needs_refill()) [[unlikely]] {
+        fill_window();
+    }
 
-        if (is_special(next)) {
-            return get_special();
-        }
+    const char *start = reader_.cursor();
+    token_start_ = start;
+    const char *cursor = start;
+    LexState state = run_lexer_dfa(cursor, reader_.end());
+
+    if (state == LexState::End) {
+        return parser::make_YYEOF(end_token());
+    }
+    begin_token();
+    check_window(cursor);
 
-        return get_identifier_or_undef();
+    switch (state) {
+        case LexState::Word:
+            return get_literal_identifier_or_keyword();
+        case LexState::Name:
+            return get_identifier_or_undef();
+        case LexState::String:
+            return get_string_literal();
+        case LexState::IntegerLiteral:
+        case LexState::RealLiteral:
+        case LexState::BadNumberLiteral:
+            skip_to(cursor);
+            return get_num_literal(state, lexeme(start));
+        default:
+            break;
     }
 
-    return parser::make_YYEOF(end_token());
+    // The only multi-byte lexeme without a token swallows whatever follows the
+    // stray operator, which may be a newline.
+    skip_to(cursor);
+    return get_special(state);
+}
+
+std::string_view yy::Scanner::lexeme(const char *start) const {
+    return {start, static_cast<size_t>(reader_.cursor() - start)};
 }
 
 void yy::Scanner::begin_token() {
-    begin_ = yy::position(&filename_, lines_, lineOffset_);
+    token_begin_ = offset(reader_.cursor());
 }
 
-yy::location yy::Scanner::end_token() {
-    yy::position end{&filename_, lines_, lineOffset_};
-    return {{begin_}, end};
+yy::SourceRange yy::Scanner::end_token() {
+    return {{file_, token_begin_}, {file_, offset(reader_.cursor())}};
 }
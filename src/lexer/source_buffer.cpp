@@ -0,0 +1,35 @@
+#include "lexer/source_buffer.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+namespace yy {
+
+    SourceBuffer SourceBuffer::open(const std::string &filename) {
+        auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(
+                filename,
+                /*IsText=*/false,
+                /*RequiresNullTerminator=*/false
+        );
+
+        if (!buffer) {
+            throw std::runtime_error("Cant open file: " + filename);
+        }
+
+        return SourceBuffer(std::move(*buffer));
+    }
+
+    SourceBuffer::SourceBuffer(std::unique_ptr<llvm::MemoryBuffer> buffer) noexcept: buffer_(std::move(buffer)) {}
+
+    SourceBuffer::SourceBuffer(SourceBuffer &&other) noexcept = default;
+
+    SourceBuffer &SourceBuffer::operator=(SourceBuffer &&other) noexcept = default;
+
+    SourceBuffer::~SourceBuffer() = default;
+
+    std::string_view SourceBuffer::view() const noexcept {
+        return {buffer_->getBufferStart(), buffer_->getBufferSize()};
+    }
+}
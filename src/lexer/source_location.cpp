@@ -0,0 +1,171 @@
+#include "lexer/source_location.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "lexer/scan_kernels.hpp"
+
+namespace {
+    struct SourceFile {
+        std::string name;
+        std::string_view text;
+        bool streamed = false;
+        bool indexed = false;
+        // Offsets of the bytes behind every newline.
+        std::vector<uint32_t> line_starts;
+    };
+
+    class SourceFiles {
+    public:
+        uint32_t add(SourceFile file) {
+            std::lock_guard lock(mutex_);
+            auto entry = std::make_unique<SourceFile>(std::move(file));
+            if (!free_.empty()) {
+                uint32_t id = free_.back();
+                free_.pop_back();
+                files_[id - 1] = std::move(entry);
+                return id;
+            }
+            files_.push_back(std::move(entry));
+            return static_cast<uint32_t>(files_.size());
+        }
+
+        void remove(uint32_t file) {
+            std::unique_ptr<SourceFile> removed;
+            std::lock_guard lock(mutex_);
+            removed = std::move(files_.at(file - 1));
+            free_.push_back(file);
+        }
+
+        // A file that is gone gives what `action` returns by default.
+        template<class Action>
+        auto with(uint32_t file, Action action) {
+            std::lock_guard lock(mutex_);
+            if (file > files_.size() || !files_[file - 1]) {
+                return std::invoke_result_t<Action, SourceFile &>();
+            }
+            return action(*files_[file - 1]);
+        }
+
+    private:
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<SourceFile>> files_;
+        // The ids of removed files.
+        std::vector<uint32_t> free_;
+    };
+
+    // Never destroyed, like the name pool: diagnostics may be printed late.
+    SourceFiles &files() {
+        static auto *instance = new SourceFiles();
+        return *instance;
+    }
+
+    void check_size(size_t size) {
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Cant locate tokens in a file of 4 GiB or more");
+        }
+    }
+
+    yy::position locate(const SourceFile &file, uint32_t offset) {
+        auto line = std::upper_bound(file.line_starts.begin(), file.line_starts.end(), offset);
+        uint32_t line_start = line == file.line_starts.begin() ? 0 : line[-1];
+        return yy::position(
+                &file.name,
+                static_cast<int>(line - file.line_starts.begin()),
+                static_cast<int>(offset - line_start)
+        );
+    }
+}
+
+namespace yy {
+
+    std::ostream &operator<<(std::ostream &out, const position &position) {
+        if (position.filename) {
+            out << *position.filename << ':';
+        }
+        return out << position.line << '.' << position.column;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const location &location) {
+        int end_column = 0 < location.end.column ? location.end.column - 1 : 0;
+        out << location.begin;
+        if (location.end.filename
+            && (!location.begin.filename || *location.begin.filename != *location.end.filename)) {
+            out << '-' << *location.end.filename << ':' << location.end.line << '.' << end_column;
+        } else if (location.begin.line < location.end.line) {
+            out << '-' << location.end.line << '.' << end_column;
+        } else if (location.begin.column < end_column) {
+            out << '-' << end_column;
+        }
+        return out;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const SourceRange &range) {
+        return out << SourceManager::resolve(range);
+    }
+
+    SourceManager::File &SourceManager::File::operator=(File &&other) noexcept {
+        if (this != &other) {
+            if (id_ != 0) {
+                files().remove(id_);
+            }
+            id_ = other.id_;
+            other.id_ = 0;
+        }
+        return *this;
+    }
+
+    SourceManager::File::~File() {
+        if (id_ != 0) {
+            files().remove(id_);
+        }
+    }
+
+    SourceManager::File SourceManager::add(const std::string &name, std::string_view text) {
+        check_size(text.size());
+        return File(files().add({name, text, false, false, {}}));
+    }
+
+    SourceManager::File SourceManager::add_stream(const std::string &name) {
+        return File(files().add({name, {}, true, false, {}}));
+    }
+
+    void SourceManager::record_lines(uint32_t file, std::string_view text, uint32_t offset) {
+        check_size(size_t(offset) + text.size());
+        files().with(file, [&](SourceFile &source) {
+            default_scan_kernels().find_line_starts(text.data(), text.data() + text.size(), offset, source.line_starts);
+        });
+    }
+
+    void SourceManager::replace_text(uint32_t file, std::string_view text) {
+        check_size(text.size());
+        files().with(file, [&](SourceFile &source) {
+            source.text = text;
+            source.indexed = false;
+            source.line_starts.clear();
+        });
+    }
+
+    position SourceManager::resolve(SourceLoc loc) {
+        if (loc.file == 0) {
+            return position();
+        }
+        return files().with(loc.file, [&](SourceFile &source) {
+            if (!source.streamed && !source.indexed) {
+                const char *text = source.text.data();
+                default_scan_kernels().find_line_starts(text, text + source.text.size(), 0, source.line_starts);
+                source.indexed = true;
+            }
+            return locate(source, loc.offset);
+        });
+    }
+
+    location SourceManager::resolve(const SourceRange &range) {
+        return {resolve(range.begin), resolve(range.end)};
+    }
+}
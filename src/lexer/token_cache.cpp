@@ -0,0 +1,265 @@
+#include "lexer/token_cache.hpp"
+
+#include <cstring>
+#include <string_view>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+#include "util/token_utils.hpp"
+
+namespace {
+    constexpr char magic[6] = {'O', 'P', 'T', 'O', 'K', '\0'};
+    constexpr uint16_t format_version = 2;
+    // magic, version, source hash, source size, payload hash, string count, token count
+    constexpr size_t header_size = sizeof(magic) + 2 + 8 + 8 + 8 + 4 + 4;
+
+    using kind = yy::parser::symbol_kind;
+
+    static_assert(kind::YYNTOKENS <= 0x100, "symbol kinds must fit into the kind byte");
+
+    template<typename T>
+    void append_fixed(std::string &out, T value) {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out.push_back(static_cast<char>(uint64_t(value) >> (8 * i)));
+        }
+    }
+
+    template<typename T>
+    T read_fixed(const uint8_t *&cursor) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= uint64_t(cursor[i]) << (8 * i);
+        }
+        cursor += sizeof(T);
+        return static_cast<T>(value);
+    }
+
+    void append_uleb(std::string &out, uint64_t value) {
+        uint8_t bytes[16];
+        unsigned size = llvm::encodeULEB128(value, bytes);
+        out.append(reinterpret_cast<const char *>(bytes), size);
+    }
+
+    // Gaps between tokens, token lengths and most string indices fit into one byte.
+    inline uint64_t read_uleb(const uint8_t *&cursor, const uint8_t *end) {
+        if (*cursor < 0x80) [[likely]] {
+            return *cursor++;
+        }
+        unsigned size = 0;
+        uint64_t value = llvm::decodeULEB128(cursor, &size, end);
+        cursor += size;
+        return value;
+    }
+
+    uint64_t zigzag(int64_t value) {
+        return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return int64_t(value >> 1) ^ -int64_t(value & 1);
+    }
+}
+
+namespace yy {
+
+    uint64_t source_hash(std::string_view source) noexcept {
+        return llvm::xxHash64(llvm::StringRef(source.data(), source.size()));
+    }
+
+    std::string token_cache_path(const std::string &directory, std::string_view source) {
+        llvm::SmallString<32> name;
+        llvm::raw_svector_ostream(name) << llvm::format_hex_no_prefix(source_hash(source), 16) << ".optok";
+        return directory + "/" + std::string(name.str());
+    }
+
+    void TokenCacheWriter::record(const parser::symbol_type &token) {
+        kind::symbol_kind_type symbol = token.kind();
+        const SourceRange &location = token.location;
+
+        tokens_.push_back(static_cast<char>(symbol));
+        append_uleb(tokens_, location.begin.offset - end_);
+        append_uleb(tokens_, location.end.offset - location.begin.offset);
+        end_ = location.end.offset;
+        token_count_++;
+
+        switch (symbol) {
+            case kind::S_IDENTIFIER:
+            case kind::S_STRING_LITERAL:
+                append_uleb(tokens_, intern(token.value.as<std::string_view>()));
+                break;
+            case kind::S_INTEGER_LITERAL:
+                append_uleb(tokens_, zigzag(token.value.as<int>()));
+                break;
+            case kind::S_REAL_LITERAL: {
+                char bytes[sizeof(double)];
+                double value = token.value.as<double>();
+                std::memcpy(bytes, &value, sizeof(bytes));
+                tokens_.append(bytes, sizeof(bytes));
+                break;
+            }
+            case kind::S_BOOLEAN_LITERAL:
+                tokens_.push_back(token.value.as<bool>() ? 1 : 0);
+                break;
+            case kind::S_YYEOF:
+                complete_ = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void TokenCacheWriter::abandon() noexcept {
+        abandoned_ = true;
+    }
+
+    bool TokenCacheWriter::complete() const noexcept {
+        return complete_ && !abandoned_;
+    }
+
+    uint32_t TokenCacheWriter::intern(std::string_view text) {
+        auto [it, inserted] = string_ids_.try_emplace(llvm::StringRef(text.data(), text.size()), strings_.size());
+        if (inserted) {
+            strings_.push_back(text);
+        }
+        return it->second;
+    }
+
+    bool TokenCacheWriter::write(const std::string &path, std::string_view source) const {
+        if (!complete()) {
+            return false;
+        }
+
+        std::string payload;
+        for (std::string_view text: strings_) {
+            append_uleb(payload, text.size());
+            payload.append(text);
+        }
+        payload += tokens_;
+
+        std::string header(magic, sizeof(magic));
+        append_fixed<uint16_t>(header, format_version);
+        append_fixed<uint64_t>(header, source_hash(source));
+        append_fixed<uint64_t>(header, source.size());
+        append_fixed<uint64_t>(header, llvm::xxHash64(payload));
+        append_fixed<uint32_t>(header, strings_.size());
+        append_fixed<uint32_t>(header, token_count_);
+
+        int fd;
+        llvm::SmallString<128> temporary;
+        if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, temporary)) {
+            return false;
+        }
+        {
+            llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+            out << header << payload;
+            out.close();
+            if (out.has_error()) {
+                out.clear_error();
+                llvm::sys::fs::remove(temporary);
+                return false;
+            }
+        }
+        if (llvm::sys::fs::rename(temporary, path)) {
+            llvm::sys::fs::remove(temporary);
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<TokenCacheReader> TokenCacheReader::open(const std::string &path, std::string_view source) {
+        auto buffer = llvm::MemoryBuffer::getFile(
+                path,
+                /*IsText=*/false,
+                /*RequiresNullTerminator=*/false
+        );
+        if (!buffer) {
+            return nullptr;
+        }
+
+        std::unique_ptr<TokenCacheReader> reader(new TokenCacheReader(std::move(*buffer)));
+        if (!reader->load(source)) {
+            return nullptr;
+        }
+        return reader;
+    }
+
+    TokenCacheReader::TokenCacheReader(std::unique_ptr<llvm::MemoryBuffer> buffer)
+            : buffer_(std::move(buffer)), token_numbers_(token_numbers().data()) {}
+
+    TokenCacheReader::~TokenCacheReader() = default;
+
+    bool TokenCacheReader::load(std::string_view source) {
+        const auto *cursor = reinterpret_cast<const uint8_t *>(buffer_->getBufferStart());
+        const auto *end = reinterpret_cast<const uint8_t *>(buffer_->getBufferEnd());
+        if (size_t(end - cursor) < header_size || std::memcmp(cursor, magic, sizeof(magic)) != 0) {
+            return false;
+        }
+        cursor += sizeof(magic);
+
+        if (read_fixed<uint16_t>(cursor) != format_version
+            || read_fixed<uint64_t>(cursor) != source_hash(source)
+            || read_fixed<uint64_t>(cursor) != source.size()) {
+            return false;
+        }
+        uint64_t payload_hash = read_fixed<uint64_t>(cursor);
+        uint32_t string_count = read_fixed<uint32_t>(cursor);
+        remaining_ = read_fixed<uint32_t>(cursor);
+
+        llvm::StringRef payload(reinterpret_cast<const char *>(cursor), end - cursor);
+        if (llvm::xxHash64(payload) != payload_hash) {
+            return false;
+        }
+
+        strings_.reserve(string_count);
+        for (uint32_t i = 0; i < string_count; i++) {
+            uint64_t size = read_uleb(cursor, end);
+            if (size > uint64_t(end - cursor)) {
+                return false;
+            }
+            strings_.emplace_back(reinterpret_cast<const char *>(cursor), size);
+            cursor += size;
+        }
+
+        cursor_ = cursor;
+        end_ = end;
+        return true;
+    }
+
+    parser::symbol_type TokenCacheReader::next(uint32_t file) {
+        if (remaining_ == 0) {
+            SourceLoc end{file, source_end_};
+            return parser::make_YYEOF({end, end});
+        }
+        remaining_--;
+
+        auto symbol = static_cast<kind::symbol_kind_type>(*cursor_++);
+        uint32_t begin = source_end_ + static_cast<uint32_t>(read_uleb(cursor_, end_));
+        source_end_ = begin + static_cast<uint32_t>(read_uleb(cursor_, end_));
+        SourceRange location{{file, begin}, {file, source_end_}};
+
+        int token = token_numbers_[symbol];
+        switch (symbol) {
+            case kind::S_IDENTIFIER:
+            case kind::S_STRING_LITERAL:
+                return {token, strings_[read_uleb(cursor_, end_)], std::move(location)};
+            case kind::S_INTEGER_LITERAL:
+                return {token, static_cast<int>(unzigzag(read_uleb(cursor_, end_))), std::move(location)};
+            case kind::S_REAL_LITERAL: {
+                double value;
+                std::memcpy(&value, cursor_, sizeof(value));
+                cursor_ += sizeof(value);
+                return {token, value, std::move(location)};
+            }
+            case kind::S_BOOLEAN_LITERAL:
+                return {token, *cursor_++ != 0, std::move(location)};
+            default:
+                return {token, std::move(location)};
+        }
+    }
+}
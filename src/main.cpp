@@ -2,12 +2,107 @@
 // Created by Nikita Morozov on 20.02.2025.
 //
 
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
 #include "parser/parser.tab.hpp"
+#include "lexer/buffered_reader.hpp"
 #include "driver.hpp"
 
+static int usage(const char *program) {
+    std::cerr << "usage: " << program << " [--trace=<channel>[:<level>],...] [--trace-file=<path>] [--token-cache=<dir>] [--lex-threads=<n>]\n"
+              << "       [--stream[=<window bytes>]] [--parser=bison|rd] [--parse-threads=<n>]\n"
+              << "       [--parse-only] [--skip-pass=<pass>] [--semantic-threads=<n>] [--flat-ast]\n"
+              << "       <file or - for stdin>\n"
+              << "  channels: tokens, ast, symbols, semantic, all\n"
+              << "  levels:   off, info (default), debug\n"
+              << "  passes:   class-collector, method-collector, symbol-table, entrypoint, type-checker,\n"
+              << "            control-flow, inheritance\n";
+    return 2;
+}
+
+// The whole of `text` as a number above 0; false, and `value` untouched, otherwise.
+template<class T>
+static bool parse_positive(std::string_view text, T &value) {
+    T parsed = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (error != std::errc() || end != text.data() + text.size() || parsed == 0) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
 int main(int argc, char **argv) {
     yy::driver driver;
-    std::string filename{argv[1]};
+    std::string filename;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg.starts_with("--trace=")) {
+            if (!driver.trace().configure(arg.substr(std::string_view("--trace=").size()))) {
+                return usage(argv[0]);
+            }
+        } else if (arg.starts_with("--trace-file=")) {
+            try {
+                driver.trace().to_file(std::string(arg.substr(std::string_view("--trace-file=").size())));
+            } catch (const std::runtime_error &error) {
+                std::cerr << error.what() << std::endl;
+                return 2;
+            }
+        } else if (arg.starts_with("--token-cache=")) {
+            driver.set_token_cache(std::string(arg.substr(std::string_view("--token-cache=").size())));
+        } else if (arg.starts_with("--lex-threads=")) {
+            unsigned threads = 0;
+            if (!parse_positive(arg.substr(std::string_view("--lex-threads=").size()), threads)) {
+                return usage(argv[0]);
+            }
+            driver.set_lexer_threads(threads);
+        } else if (arg == "--stream") {
+            driver.set_stream_window(yy::BufferedReader::default_window);
+        } else if (arg.starts_with("--stream=")) {
+            size_t window = 0;
+            if (!parse_positive(arg.substr(std::string_view("--stream=").size()), window)) {
+                return usage(argv[0]);
+            }
+            driver.set_stream_window(window);
+        } else if (arg.starts_with("--parse-threads=")) {
+            unsigned threads = 0;
+            if (!parse_positive(arg.substr(std::string_view("--parse-threads=").size()), threads)) {
+                return usage(argv[0]);
+            }
+            driver.set_parser_threads(threads);
+        } else if (arg.starts_with("--semantic-threads=")) {
+            unsigned threads = 0;
+            if (!parse_positive(arg.substr(std::string_view("--semantic-threads=").size()), threads)) {
+                return usage(argv[0]);
+            }
+            driver.set_semantic_threads(threads);
+        } else if (arg.starts_with("--skip-pass=")) {
+            if (!driver.skip_pass(std::string(arg.substr(std::string_view("--skip-pass=").size())))) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--flat-ast") {
+            driver.set_flat_ast(true);
+        } else if (arg == "--parse-only") {
+            driver.set_semantic_analysis(false);
+        } else if (arg == "--parser=bison") {
+            driver.set_parser(yy::ParserBackend::Bison);
+        } else if (arg == "--parser=rd") {
+            driver.set_parser(yy::ParserBackend::RecursiveDescent);
+        } else if (filename.empty()) {
+            filename = arg;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (filename.empty()) {
+        return usage(argv[0]);
+    }
+
     driver.parse(filename);
     return 0;
 }
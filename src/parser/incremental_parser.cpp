@@ -0,0 +1,185 @@
+#include "parser/incremental_parser.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "ast/ast_arena.hpp"
+#include "lexer/buffered_reader.hpp"
+#include "lexer/scanner.hpp"
+#include "lexer/token_source.hpp"
+#include "parser/recursive_descent_parser.hpp"
+#include "visitor/iterative_visitor.hpp"
+
+namespace {
+    // Moves the nodes of a subtree behind an edit to where their tokens are now.
+    // Walks the nodes the parser owns as they are, not const.
+    class LocationShifter : public yy::IterativeVisitor<LocationShifter> {
+    public:
+        explicit LocationShifter(const yy::TokenRange &range) : range_(range) {}
+
+        template<class Node>
+        bool enter(Node &node) {
+            move(node);
+            return true;
+        }
+
+        // A member and a statement both, with a location as either.
+        bool enter(VariableDeclaration &node) {
+            move(static_cast<MemberDeclarationExpr &>(node));
+            move(static_cast<BodyExpr &>(node));
+            return true;
+        }
+
+    private:
+        void move(NodeBase &node) const {
+            yy::SourceRange location = node.location();
+            range_.shift(location);
+            node.relocate(location);
+        }
+
+        const yy::TokenRange &range_;
+    };
+}
+
+namespace yy {
+
+    // Hands the lexer's tokens to the scanner, from wherever the parse starts.
+    class IncrementalParser::LexedTokens : public TokenSource {
+    public:
+        explicit LexedTokens(const IncrementalLexer &lexer) : lexer_(lexer) {}
+
+        void seek(size_t index) noexcept {
+            next_ = index;
+        }
+
+        // The index of the next token handed out.
+        size_t position() const noexcept {
+            return next_;
+        }
+
+        parser::symbol_type next(uint32_t) override {
+            return lexer_.symbol(next_++);
+        }
+
+    private:
+        const IncrementalLexer &lexer_;
+        size_t next_ = 0;
+    };
+
+    IncrementalParser::IncrementalParser(std::string text, const std::string &filename)
+            : lexer_(std::move(text), filename),
+              tokens_(std::make_unique<LexedTokens>(lexer_)),
+              scanner_(std::make_unique<Scanner>(BufferedReader(std::string_view()), SourceLoc{lexer_.file(), 0})) {
+        scanner_->replay_from(tokens_.get());
+        AstArena::Scope heap(nullptr);
+        parse_all();
+    }
+
+    IncrementalParser::~IncrementalParser() = default;
+
+    int IncrementalParser::apply(const TextEdit &edit) {
+        AstArena::Scope heap(nullptr);
+        const TokenRange range = lexer_.apply(edit);
+        if (program_) {
+            // The class the first damaged token is in; an edit between two
+            // classes goes to the one behind it.
+            auto behind = std::upper_bound(starts_.begin(), starts_.end(), range.first);
+            if (behind != starts_.begin() && reparse(behind - starts_.begin() - 1, range)) {
+                return 0;
+            }
+        }
+        return parse_all();
+    }
+
+    int IncrementalParser::parse_all() {
+        std::unique_ptr<Program> program;
+        tokens_->seek(0);
+        int failure = RecursiveDescentParser(*scanner_, program)();
+        program_ = std::move(program);
+        starts_.clear();
+        parsed_classes_ = 0;
+        if (failure) {
+            return failure;
+        }
+
+        const auto &tokens = lexer_.tokens();
+        auto token_at = [&](SourceLoc begin) {
+            auto token = std::partition_point(tokens.begin(), tokens.end(), [&](const LexedToken &token) {
+                return token.location.begin.offset < begin.offset;
+            });
+            return static_cast<size_t>(token - tokens.begin());
+        };
+        for (const auto &declaration: program_->class_declarations()->class_declarations()) {
+            starts_.push_back(token_at(declaration->location().begin));
+        }
+        starts_.push_back(token_at(program_->main_class()->location().begin));
+        parsed_classes_ = starts_.size() - 1;
+        return 0;
+    }
+
+    bool IncrementalParser::reparse(size_t index, const TokenRange &range) {
+        const bool main_class = index + 1 == starts_.size();
+        const size_t old_tokens = lexer_.tokens().size() - range.inserted + range.removed;
+        const size_t end = main_class ? old_tokens : starts_[index + 1];
+        if (range.first + range.removed > end) {
+            return false;
+        }
+        const ptrdiff_t delta = static_cast<ptrdiff_t>(range.inserted) - static_cast<ptrdiff_t>(range.removed);
+
+        std::unique_ptr<Program> unused;
+        RecursiveDescentParser parser(*scanner_, unused);
+        tokens_->seek(starts_[index]);
+        std::unique_ptr<ProgramDeclarationExpr> declaration;
+        std::unique_ptr<Expr> expression;
+        try {
+            if (main_class) {
+                expression = parser.parse_main_expression();
+            } else {
+                declaration = parser.parse_class();
+                // Ending anywhere else, the class took tokens of the next one or left some.
+                if (tokens_->position() != end + delta) {
+                    return false;
+                }
+            }
+        } catch (const parser::syntax_error &) {
+            return false;
+        }
+
+        auto classes = program_->release_class_declarations()->release_class_declarations();
+        if (main_class) {
+            rebuild(std::move(classes), std::move(expression));
+            parsed_classes_ = 0;
+            return true;
+        }
+
+        expression = program_->release_main_class();
+        classes[index] = std::move(declaration);
+        if (range.delta != 0) {
+            LocationShifter shifter(range);
+            for (size_t i = index + 1; i < classes.size(); i++) {
+                shifter.visit(*classes[i]);
+            }
+            shifter.visit(*expression);
+        }
+        for (size_t i = index + 1; i < starts_.size(); i++) {
+            starts_[i] += delta;
+        }
+        rebuild(std::move(classes), std::move(expression));
+        parsed_classes_ = 1;
+        return true;
+    }
+
+    void IncrementalParser::rebuild(
+            std::vector<std::unique_ptr<ProgramDeclarationExpr>> &&classes,
+            std::unique_ptr<Expr> &&main_class
+    ) {
+        // Located as bison locates them; see RecursiveDescentParser::parse.
+        SourceRange declarations{SourceLoc(), classes.empty() ? SourceLoc() : classes.back()->location().end};
+        SourceRange program{declarations.begin, main_class->location().end};
+        program_ = std::make_unique<Program>(
+                program,
+                std::make_unique<ProgramDeclaration>(declarations, std::move(classes)),
+                std::move(main_class)
+        );
+    }
+}
@@ -0,0 +1,102 @@
+#include "parser/parallel_parser.hpp"
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/parallel_lexer.hpp"
+#include "lexer/scanner.hpp"
+#include "parser/recursive_descent_parser.hpp"
+
+namespace yy {
+
+    ParallelParser::ParallelParser(
+            std::string_view source,
+            const std::string &filename,
+            unsigned threads,
+            size_t chunk_size
+    ) : source_(source), file_(SourceManager::add(filename, source)), threads_(std::max(threads, 1u)) {
+        if (chunk_size == 0) {
+            chunk_size = std::max(min_chunk_size, source.size() / (4 * threads_));
+        }
+        std::vector<size_t> splits = find_split_points(source, chunk_size);
+        splits.push_back(source.size());
+
+        chunks_ = std::vector<Chunk>(splits.size());
+        size_t begin = 0;
+        for (size_t i = 0; i < splits.size(); i++) {
+            chunks_[i].begin = begin;
+            chunks_[i].stop = splits[i];
+            begin = splits[i];
+        }
+    }
+
+    ParallelParser::~ParallelParser() = default;
+
+    void ParallelParser::parse(Chunk &chunk, bool last) {
+        AstArena::Scope arena_scope(&chunk.arena);
+        chunk.scanner = std::make_unique<Scanner>(
+                BufferedReader(source_.substr(chunk.begin)),
+                SourceLoc{file_.id(), static_cast<uint32_t>(chunk.begin)}
+        );
+        std::unique_ptr<Program> unused;
+        RecursiveDescentParser parser(*chunk.scanner, unused);
+        try {
+            if (last) {
+                parser.parse_classes(chunk.classes, source_.data() + source_.size());
+                chunk.main_class = parser.parse_main_expression();
+                chunk.complete = true;
+            } else {
+                const char *next = parser.parse_classes(chunk.classes, source_.data() + chunk.stop);
+                chunk.complete = next == source_.data() + chunk.stop;
+            }
+        } catch (const parser::syntax_error &) {
+            chunk.complete = false;
+        }
+    }
+
+    std::unique_ptr<Program> ParallelParser::parse() {
+        {
+            llvm::ThreadPool pool(llvm::hardware_concurrency(threads_));
+            std::vector<std::shared_future<void>> parsed;
+            parsed.reserve(chunks_.size());
+            for (size_t i = 0; i < chunks_.size(); i++) {
+                parsed.push_back(pool.async([this, i] {
+                    parse(chunks_[i], i + 1 == chunks_.size());
+                }));
+            }
+            for (auto &chunk: parsed) {
+                chunk.get();
+            }
+        }
+        if (!std::all_of(chunks_.begin(), chunks_.end(), [](const Chunk &chunk) { return chunk.complete; })) {
+            return nullptr;
+        }
+
+        size_t count = 0;
+        for (auto &chunk: chunks_) {
+            count += chunk.classes.size();
+        }
+        std::vector<std::unique_ptr<ProgramDeclarationExpr>> classes;
+        classes.reserve(count);
+        for (auto &chunk: chunks_) {
+            std::move(chunk.classes.begin(), chunk.classes.end(), std::back_inserter(classes));
+            chunk.classes.clear();
+        }
+
+        // Bison starts the class list at the location it starts its stack with,
+        // and ends it where the last class ends, or there if there is none.
+        SourceRange declarations{SourceLoc(), classes.empty() ? SourceLoc() : classes.back()->location().end};
+        auto main_class = std::move(chunks_.back().main_class);
+        SourceRange program{declarations.begin, main_class->location().end};
+        return std::make_unique<Program>(
+                program,
+                std::make_unique<ProgramDeclaration>(declarations, std::move(classes)),
+                std::move(main_class)
+        );
+    }
+}
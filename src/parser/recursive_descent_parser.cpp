@@ -0,0 +1,427 @@
+#include "parser/recursive_descent_parser.hpp"
+
+#include <utility>
+
+#include "lexer/scanner.hpp"
+
+namespace {
+    using kind = yy::parser::symbol_kind;
+
+    yy::SourceRange span(const yy::SourceRange &first, const yy::SourceRange &last) {
+        return {first.begin, last.end};
+    }
+}
+
+namespace yy {
+
+    RecursiveDescentParser::RecursiveDescentParser(Scanner &scanner, std::unique_ptr<Program> &root)
+            : scanner_(scanner), root_(root) {}
+
+    int RecursiveDescentParser::parse() {
+        try {
+            std::vector<std::unique_ptr<ProgramDeclarationExpr>> classes;
+            while (peek() == kind::S_CLASS) {
+                classes.push_back(class_declaration());
+            }
+            // Bison starts the class list at the location it starts its stack with.
+            SourceRange declarations{SourceLoc(), last_end_};
+            auto main_class = expression();
+            expect(kind::S_YYEOF);
+
+            SourceRange program{declarations.begin, main_class->location().end};
+            root_ = std::make_unique<Program>(
+                    program,
+                    std::make_unique<ProgramDeclaration>(declarations, std::move(classes)),
+                    std::move(main_class)
+            );
+            return 0;
+        } catch (const parser::syntax_error &error) {
+            report_syntax_error(error.location, error.what());
+            return 1;
+        }
+    }
+
+    const char *RecursiveDescentParser::parse_classes(
+            std::vector<std::unique_ptr<ProgramDeclarationExpr>> &classes,
+            const char *stop
+    ) {
+        while (peek() == kind::S_CLASS) {
+            if (scanner_.token_start() >= stop) {
+                return scanner_.token_start();
+            }
+            classes.push_back(class_declaration());
+        }
+        return nullptr;
+    }
+
+    std::unique_ptr<Expr> RecursiveDescentParser::parse_main_expression() {
+        auto main_class = expression();
+        expect(kind::S_YYEOF);
+        return main_class;
+    }
+
+    std::unique_ptr<ProgramDeclarationExpr> RecursiveDescentParser::parse_class() {
+        if (peek() != kind::S_CLASS) {
+            fail();
+        }
+        return class_declaration();
+    }
+
+    RecursiveDescentParser::Kind RecursiveDescentParser::peek() {
+        if (!has_lookahead_) {
+            parser::symbol_type token = yylex(scanner_);
+            lookahead_.kind = token.kind();
+            lookahead_.location = token.location;
+            switch (lookahead_.kind) {
+                case kind::S_IDENTIFIER:
+                case kind::S_STRING_LITERAL:
+                    lookahead_.text = token.value.as<std::string_view>();
+                    break;
+                case kind::S_INTEGER_LITERAL:
+                    lookahead_.integer = token.value.as<int>();
+                    break;
+                case kind::S_REAL_LITERAL:
+                    lookahead_.real = token.value.as<double>();
+                    break;
+                case kind::S_BOOLEAN_LITERAL:
+                    lookahead_.boolean = token.value.as<bool>();
+                    break;
+                default:
+                    break;
+            }
+            has_lookahead_ = true;
+        }
+        return lookahead_.kind;
+    }
+
+    RecursiveDescentParser::Token RecursiveDescentParser::take() {
+        peek();
+        has_lookahead_ = false;
+        last_end_ = lookahead_.location.end;
+        return lookahead_;
+    }
+
+    RecursiveDescentParser::Token RecursiveDescentParser::expect(Kind expected) {
+        if (peek() != expected) {
+            fail();
+        }
+        return take();
+    }
+
+    void RecursiveDescentParser::fail() {
+        throw parser::syntax_error(lookahead_.location, "syntax error");
+    }
+
+    std::unique_ptr<ProgramDeclarationExpr> RecursiveDescentParser::class_declaration() {
+        Token keyword = take();
+        Token name = expect(kind::S_IDENTIFIER);
+        std::unique_ptr<ClassDeclaration> header;
+        if (peek() == kind::S_EXTENDS) {
+            take();
+            Token parent = expect(kind::S_IDENTIFIER);
+            header = std::make_unique<ClassDeclaration>(name.location, Name(name.text), Name(parent.text));
+        } else {
+            header = std::make_unique<ClassDeclaration>(name.location, Name(name.text));
+        }
+        expect(kind::S_IS);
+
+        std::vector<std::unique_ptr<MemberDeclarationExpr>> members;
+        const SourceLoc members_begin = last_end_;
+        for (;;) {
+            Kind next = peek();
+            if (next == kind::S_VAR) {
+                members.push_back(variable_declaration());
+            } else if (next == kind::S_METHOD) {
+                members.push_back(method_declaration());
+            } else if (next == kind::S_THIS) {
+                members.push_back(constructor_declaration());
+            } else {
+                break;
+            }
+        }
+        SourceRange members_location{members_begin, last_end_};
+        Token end = expect(kind::S_END);
+
+        return std::make_unique<ClassDefinition>(
+                span(keyword.location, end.location),
+                std::move(header),
+                std::make_unique<MemberDeclaration>(members_location, std::move(members))
+        );
+    }
+
+    std::unique_ptr<MemberDeclarationExpr> RecursiveDescentParser::method_declaration() {
+        Token keyword = take();
+        Token name = expect(kind::S_IDENTIFIER);
+        auto parameter_list = parameters();
+        std::unique_ptr<MethodDeclaration> header;
+        if (peek() == kind::S_COLON) {
+            take();
+            Token type = expect(kind::S_IDENTIFIER);
+            header = std::make_unique<MethodDeclaration>(
+                    span(keyword.location, type.location),
+                    Name(name.text),
+                    std::move(parameter_list),
+                    Name(type.text)
+            );
+        } else {
+            header = std::make_unique<MethodDeclaration>(
+                    SourceRange{keyword.location.begin, last_end_},
+                    Name(name.text),
+                    std::move(parameter_list)
+            );
+        }
+
+        Kind next = peek();
+        if (next != kind::S_IS && next != kind::S_METHOD_DEFINITION) {
+            return header;
+        }
+        const SourceLoc begin = header->location().begin;
+        auto body = method_body();
+        return std::make_unique<MethodDefinition>(SourceRange{begin, last_end_}, std::move(header), std::move(body));
+    }
+
+    std::unique_ptr<Body> RecursiveDescentParser::method_body() {
+        if (take().kind == kind::S_IS) {
+            auto body = body_list();
+            expect(kind::S_END);
+            return body;
+        }
+
+        std::vector<std::unique_ptr<BodyExpr>> body;
+        if (peek() == kind::S_RETURN) {
+            body.push_back(return_statement());
+        } else {
+            body.push_back(expression());
+        }
+        SourceRange body_location = body.front()->location();
+        return std::make_unique<Body>(body_location, std::move(body));
+    }
+
+    std::unique_ptr<ConstructorDefinition> RecursiveDescentParser::constructor_declaration() {
+        Token keyword = take();
+        auto header = std::make_unique<ConstructorDeclaration>(keyword.location, parameters());
+        expect(kind::S_IS);
+        auto body = body_list();
+        Token end = expect(kind::S_END);
+        return std::make_unique<ConstructorDefinition>(span(keyword.location, end.location), std::move(header), std::move(body));
+    }
+
+    std::unique_ptr<VariableDeclaration> RecursiveDescentParser::variable_declaration() {
+        Token keyword = take();
+        Token name = expect(kind::S_IDENTIFIER);
+        expect(kind::S_COLON);
+        auto initializer = expression();
+        SourceRange declaration{keyword.location.begin, initializer->location().end};
+        return std::make_unique<VariableDeclaration>(declaration, Name(name.text), std::move(initializer));
+    }
+
+    std::vector<std::unique_ptr<ParameterDeclaration>> RecursiveDescentParser::parameters() {
+        std::vector<std::unique_ptr<ParameterDeclaration>> result;
+        expect(kind::S_LEFT_PAREN);
+        // Empty, or comma separated with an optional trailing comma.
+        while (peek() == kind::S_IDENTIFIER) {
+            Token name = take();
+            expect(kind::S_COLON);
+            Token type = expect(kind::S_IDENTIFIER);
+            result.push_back(std::make_unique<ParameterDeclaration>(
+                    span(name.location, type.location),
+                    Name(name.text),
+                    Name(type.text)
+            ));
+            if (peek() != kind::S_COMMA) {
+                break;
+            }
+            take();
+        }
+        expect(kind::S_RIGHT_PAREN);
+        return result;
+    }
+
+    std::unique_ptr<Body> RecursiveDescentParser::body_list() {
+        // The bodies of the while loops and ifs around the statement being
+        // parsed, innermost last; the outermost is the one asked for.
+        std::vector<OpenBody> open;
+        open.push_back({kind::S_YYEOF, {}, nullptr, nullptr, last_end_, {}});
+        for (;;) {
+            Kind next = peek();
+            if (next == kind::S_WHILE || next == kind::S_IF) {
+                Token keyword = take();
+                auto condition = expression();
+                expect(next == kind::S_WHILE ? kind::S_LOOP : kind::S_THEN);
+                open.push_back({next, keyword, std::move(condition), nullptr, last_end_, {}});
+                continue;
+            }
+            if (next == kind::S_VAR || next == kind::S_IDENTIFIER || next == kind::S_RETURN || starts_primary(next)) {
+                open.back().expressions.push_back(body());
+                continue;
+            }
+
+            OpenBody &top = open.back();
+            auto body = std::make_unique<Body>(SourceRange{top.begin, last_end_}, std::move(top.expressions));
+            if (top.statement == kind::S_YYEOF) {
+                return body;
+            }
+            if (top.statement == kind::S_IF && peek() == kind::S_ELSE) {
+                take();
+                top.statement = kind::S_ELSE;
+                top.then_body = std::move(body);
+                top.begin = last_end_;
+                top.expressions.clear();
+                continue;
+            }
+
+            Token end = expect(kind::S_END);
+            const SourceRange location = span(top.keyword.location, end.location);
+            std::unique_ptr<BodyExpr> statement;
+            if (top.statement == kind::S_WHILE) {
+                statement = std::make_unique<WhileStmt>(location, std::move(top.condition), std::move(body));
+            } else if (top.statement == kind::S_IF) {
+                statement = std::make_unique<IfStmt>(location, std::move(top.condition), std::move(body));
+            } else {
+                statement = std::make_unique<IfStmt>(
+                        location,
+                        std::move(top.condition),
+                        std::move(top.then_body),
+                        std::move(body)
+                );
+            }
+            open.pop_back();
+            open.back().expressions.push_back(std::move(statement));
+        }
+    }
+
+    std::unique_ptr<BodyExpr> RecursiveDescentParser::body() {
+        switch (peek()) {
+            case kind::S_VAR:
+                return variable_declaration();
+            case kind::S_RETURN:
+                return return_statement();
+            case kind::S_IDENTIFIER: {
+                Token name = take();
+                if (peek() != kind::S_ASSIGNMENT_OPERATOR) {
+                    return expression(std::move(name));
+                }
+                take();
+                auto value = expression();
+                SourceRange assignment{name.location.begin, value->location().end};
+                return std::make_unique<AssignmentStmt>(assignment, Name(name.text), std::move(value));
+            }
+            default:
+                return expression();
+        }
+    }
+
+    std::unique_ptr<ReturnStmt> RecursiveDescentParser::return_statement() {
+        Token keyword = take();
+        auto value = expression();
+        SourceRange statement{keyword.location.begin, value->location().end};
+        return std::make_unique<ReturnStmt>(statement, std::move(value));
+    }
+
+    std::unique_ptr<Expr> RecursiveDescentParser::expression() {
+        Kind next = peek();
+        if (next == kind::S_IDENTIFIER) {
+            return expression(take());
+        }
+        if (!starts_primary(next)) {
+            fail();
+        }
+        auto value = primary(take());
+        if (peek() == kind::S_MEMBER_ACCESS_OPERATOR) {
+            return member_access_chain(std::move(value));
+        }
+        return value;
+    }
+
+    std::unique_ptr<Expr> RecursiveDescentParser::expression(Token &&identifier) {
+        Kind next = peek();
+        if (next == kind::S_LEFT_PAREN) {
+            auto call = function_call(std::move(identifier));
+            if (peek() == kind::S_MEMBER_ACCESS_OPERATOR) {
+                return member_access_chain(std::move(call));
+            }
+            SourceRange call_location = call->location();
+            return std::make_unique<MemberAccess>(call_location, std::make_unique<ThisExpr>(call_location), std::move(call));
+        }
+
+        auto field = std::make_unique<FieldAccessExpr>(identifier.location, Name(identifier.text));
+        if (next == kind::S_MEMBER_ACCESS_OPERATOR) {
+            return member_access_chain(std::move(field));
+        }
+        return std::make_unique<MemberAccess>(identifier.location, std::make_unique<ThisExpr>(identifier.location), std::move(field));
+    }
+
+    std::unique_ptr<MethodCallExpr> RecursiveDescentParser::function_call(Token &&identifier) {
+        if (call_depth_ == max_call_depth) {
+            throw parser::syntax_error(identifier.location, "syntax error, calls nest too deep");
+        }
+        call_depth_++;
+        take();
+        // Arguments may also start with a comma: bison's expression_list can be empty in front of one.
+        std::vector<std::unique_ptr<Expr>> arguments;
+        Kind next = peek();
+        if (next == kind::S_IDENTIFIER || starts_primary(next)) {
+            arguments.push_back(expression());
+        }
+        while (peek() == kind::S_COMMA) {
+            take();
+            arguments.push_back(expression());
+        }
+        Token close = expect(kind::S_RIGHT_PAREN);
+        call_depth_--;
+        return std::make_unique<MethodCallExpr>(
+                span(identifier.location, close.location),
+                Name(identifier.text),
+                std::move(arguments)
+        );
+    }
+
+    std::unique_ptr<PrimaryExpr> RecursiveDescentParser::primary(Token &&token) {
+        switch (token.kind) {
+            case kind::S_BOOLEAN_LITERAL:
+                return std::make_unique<BooleanLiteralExpr>(token.location, token.boolean);
+            case kind::S_INTEGER_LITERAL:
+                return std::make_unique<IntegerLiteralExpr>(token.location, token.integer);
+            case kind::S_REAL_LITERAL:
+                return std::make_unique<RealLiteralExpr>(token.location, token.real);
+            case kind::S_STRING_LITERAL:
+                return std::make_unique<StringLiteralExpr>(token.location, std::string(token.text));
+            default:
+                return std::make_unique<ThisExpr>(token.location);
+        }
+    }
+
+    std::unique_ptr<MemberAccess> RecursiveDescentParser::member_access_chain(std::unique_ptr<Expr> &&first) {
+        std::vector<std::unique_ptr<Expr>> links;
+        links.push_back(std::move(first));
+        for (;;) {
+            take();
+            Kind next = peek();
+            if (starts_primary(next)) {
+                // Only ever a link in the middle of the chain.
+                links.push_back(primary(take()));
+                if (peek() != kind::S_MEMBER_ACCESS_OPERATOR) {
+                    fail();
+                }
+                continue;
+            }
+
+            Token name = expect(kind::S_IDENTIFIER);
+            std::unique_ptr<MemberAccessExpr> link;
+            if (peek() == kind::S_LEFT_PAREN) {
+                link = function_call(std::move(name));
+            } else {
+                link = std::make_unique<FieldAccessExpr>(name.location, Name(name.text));
+            }
+            if (peek() != kind::S_MEMBER_ACCESS_OPERATOR) {
+                return nest_member_access(std::move(links), std::move(link));
+            }
+            links.push_back(std::move(link));
+        }
+    }
+
+    bool RecursiveDescentParser::starts_primary(Kind next) {
+        return next == kind::S_BOOLEAN_LITERAL || next == kind::S_INTEGER_LITERAL || next == kind::S_REAL_LITERAL
+               || next == kind::S_STRING_LITERAL || next == kind::S_THIS;
+    }
+}
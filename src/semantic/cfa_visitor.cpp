@@ -7,16 +7,42 @@
 
 
 
-void yy::CFAVisitor::operator()(const ReturnStmt &return_stmt) {
+bool yy::CFAVisitor::enter(const MethodCallExpr &) {
+    return false;
+}
+
+
+bool yy::CFAVisitor::enter(const MemberAccess &) {
+    return false;
+}
+
+
+bool yy::CFAVisitor::enter(const ReturnStmt &) {
     result_ = 1;
+    return false;
+}
+
+
+bool yy::CFAVisitor::enter(const IfStmt &) {
+    saved_.push_back(result_);
+    return true;
 }
 
 
-void yy::CFAVisitor::operator()(const IfStmt &if_stmt) {
-    size_t prev = result_;
-    size_t then = if_stmt.then_body()->accept(*this);
+void yy::CFAVisitor::after(const IfStmt &, size_t child) {
+    if (child == 1) {
+        saved_.push_back(result_);
+    }
+}
+
+
+void yy::CFAVisitor::leave(const IfStmt &if_stmt) {
+    size_t then = saved_.back();
+    saved_.pop_back();
+    size_t prev = saved_.back();
+    saved_.pop_back();
     if (if_stmt.else_body()) {
-        size_t elze = if_stmt.else_body()->accept(*this);
+        size_t elze = result_;
         if (then & elze) {
             result_ = 1;
             return;
@@ -26,15 +52,19 @@ void yy::CFAVisitor::operator()(const IfStmt &if_stmt) {
 }
 
 
-void yy::CFAVisitor::operator()(const ConstructorDefinition &constructor_definition) {
-
+bool yy::CFAVisitor::enter(const ConstructorDefinition &) {
+    return false;
 }
 
 
-void yy::CFAVisitor::operator()(const MethodDefinition &method_definition) {
+bool yy::CFAVisitor::enter(const MethodDefinition &) {
     result_ = 0;
-    size_t res = method_definition.body()->accept(*this);
-    if (res != 1 && !method_definition.header()->return_type().empty()) {
+    return true;
+}
+
+
+void yy::CFAVisitor::leave(const MethodDefinition &method_definition) {
+    if (result_ != 1 && !method_definition.header()->return_type().empty()) {
         semantic_errors_.emplace_back(
                 "Missing return statement",
                 method_definition.location()
@@ -43,5 +73,55 @@ void yy::CFAVisitor::operator()(const MethodDefinition &method_definition) {
 }
 
 
+bool yy::FlatCFAVisitor::enter(const FlatAst &ast, NodeId node) {
+    switch (ast.kind(node)) {
+        case NodeKind::MethodCall:
+        case NodeKind::MemberAccess:
+        case NodeKind::ConstructorDefinition:
+            return false;
+        case NodeKind::Return:
+            result_ = 1;
+            return false;
+        case NodeKind::If:
+            saved_.push_back(result_);
+            return true;
+        case NodeKind::MethodDefinition:
+            result_ = 0;
+            return true;
+        default:
+            return true;
+    }
+}
+
+
+void yy::FlatCFAVisitor::after(const FlatAst &ast, NodeId node, uint32_t child) {
+    if (ast.kind(node) == NodeKind::If && child == 1) {
+        saved_.push_back(result_);
+    }
+}
 
 
+void yy::FlatCFAVisitor::leave(const FlatAst &ast, NodeId node) {
+    if (ast.kind(node) == NodeKind::If) {
+        size_t then = saved_.back();
+        saved_.pop_back();
+        size_t prev = saved_.back();
+        saved_.pop_back();
+        // The else body is the third child.
+        if (ast.children(node).size() == 3) {
+            size_t elze = result_;
+            if (then & elze) {
+                result_ = 1;
+                return;
+            }
+        }
+        result_ = prev;
+    } else if (ast.kind(node) == NodeKind::MethodDefinition) {
+        if (result_ != 1 && !ast.type(ast.child(node, 0)).empty()) {
+            semantic_errors_.emplace_back(
+                    "Missing return statement",
+                    ast.location(node)
+            );
+        }
+    }
+}
@@ -6,40 +6,40 @@
 #include <unordered_set>
 
 
-void yy::InheritanceVisitor::operator()(const VariableDeclaration &variable_declaration) {
-    auto *location = dynamic_cast<const MemberDeclarationExpr *>(&variable_declaration);
+bool yy::InheritanceVisitor::enter(const VariableDeclaration &variable_declaration) {
+    auto *location = static_cast<const MemberDeclarationExpr *>(&variable_declaration);
     auto &symbol_table = symbol_table_index_->restore(location);
     auto variable = symbol_table.resolve_local(variable_declaration.name());
 
     if (!variable) {
         semantic_errors_.emplace_back(
-                "Unexpected identifier: " + variable_declaration.name(),
+                "Unexpected identifier: " + variable_declaration.name().str(),
                 location->location()
         );
-        result_ = nullptr;
-        return;
+        return false;
     }
 
     auto class_scope = symbol_table.resolve_this();
     const ClassDefinition *parent;
     for (auto clazz = symbol_table.resolve_symbol(class_scope->declaredNode()->header()->parent());
          clazz != nullptr;
-         (parent = dynamic_cast<const ClassDefinition *>(clazz->get_symbol()->declaredNode()),
+         (parent = llvm::dyn_cast_or_null<ClassDefinition>(clazz->get_symbol()->declaredNode()),
                  clazz = symbol_table.resolve_symbol(parent->header()->parent()))
             ) {
         auto super_local = clazz->resolve_local(variable_declaration.name());
         if (super_local && variable->clazz() != super_local->clazz()) {
             semantic_errors_.emplace_back(
-                    "Redefinition of field: " + variable_declaration.name(),
+                    "Redefinition of field: " + variable_declaration.name().str(),
                     location->location()
             );
         }
 
     }
+    return false;
 }
 
 
-void yy::InheritanceVisitor::operator()(const ClassDeclaration &class_declaration) {
+bool yy::InheritanceVisitor::enter(const ClassDeclaration &class_declaration) {
     auto &symbol_table = symbol_table_index_->restore(&class_declaration);
 
     ClassSymbol *clazz = symbol_table.resolve_class(class_declaration.name());
@@ -49,26 +49,27 @@ void yy::InheritanceVisitor::operator()(const ClassDeclaration &class_declaratio
                 "Self inheritance forbidden",
                 class_declaration.location()
         );
-        return;
+        return true;
     }
 
     if (!clazz) {
         semantic_errors_.emplace_back(
-                "Missing class: " + class_declaration.name(),
+                "Missing class: " + class_declaration.name().str(),
                 class_declaration.location()
         );
     }
 
-    std::unordered_set<std::string> super_graph;
+    std::unordered_set<yy::Name> super_graph;
 
     for (; clazz != nullptr; (clazz = symbol_table.resolve_class(clazz->declaredNode()->header()->parent()))) {
         if (auto twiceParent = super_graph.find(clazz->name()); twiceParent != super_graph.end()) {
             semantic_errors_.emplace_back(
-                    "Class loop on : " + (*twiceParent),
+                    "Class loop on : " + twiceParent->str(),
                     class_declaration.location()
             );
             break;
         }
         super_graph.emplace(clazz->name());
     }
+    return true;
 }
@@ -7,7 +7,7 @@
 #include <sstream>
 
 std::string transform_to_mangling_name(
-        const std::string &method_name,
+        yy::Name method_name,
         const std::vector<ClassSymbol *> &parameters
 ) {
     std::ostringstream out;
@@ -0,0 +1,253 @@
+#include "semantic/pass_manager.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include <llvm/Support/ThreadPool.h>
+
+#include "semantic/cfa_visitor.hpp"
+#include "semantic/entrypoint_visitor.hpp"
+#include "semantic/inheritance_visitor.hpp"
+#include "semantic/symbol_table_class_collector_visitor.hpp"
+#include "semantic/symbol_table_method_collector_visitor.hpp"
+#include "semantic/symbol_table_visitor.hpp"
+#include "semantic/type_checker_visitor.hpp"
+
+namespace {
+    constexpr size_t none = std::numeric_limits<size_t>::max();
+
+    bool contains(const std::vector<yy::PassData> &data, yy::PassData datum) {
+        return std::find(data.begin(), data.end(), datum) != data.end();
+    }
+}
+
+namespace yy {
+
+    void PassManager::add(
+            const std::string &name,
+            std::unique_ptr<FusedPass> pass,
+            std::unique_ptr<std::vector<SemanticError>> errors,
+            std::initializer_list<PassInput> inputs,
+            std::initializer_list<PassData> outputs
+    ) {
+        Entry entry{name, std::move(pass), std::move(errors), inputs, outputs, {}};
+        for (auto &input: inputs) {
+            size_t writer = entries_.size();
+            while (writer > 0 && !contains(entries_[writer - 1].outputs, input.data)) {
+                writer--;
+            }
+            if (writer == 0) {
+                throw std::runtime_error("Cant run pass " + name + ": no pass in front of it writes what it reads");
+            }
+            entry.dependencies.push_back({writer - 1, input.needs});
+        }
+        // What it writes must not change under the passes in front of it.
+        for (auto output: outputs) {
+            for (size_t earlier = 0; earlier < entries_.size(); earlier++) {
+                auto &read = entries_[earlier].inputs;
+                bool reads = std::any_of(read.begin(), read.end(), [&](const PassInput &input) {
+                    return input.data == output;
+                });
+                if (reads || contains(entries_[earlier].outputs, output)) {
+                    entry.dependencies.push_back({earlier, PassNeeds::WholeProgram});
+                }
+            }
+        }
+        entries_.push_back(std::move(entry));
+    }
+
+    void PassManager::disable(const std::string &name) {
+        auto found = std::find_if(entries_.begin(), entries_.end(), [&](const Entry &entry) {
+            return entry.name == name;
+        });
+        if (found == entries_.end()) {
+            throw std::runtime_error("Cant disable pass " + name + ": there is none");
+        }
+        found->disabled = true;
+    }
+
+    std::vector<bool> PassManager::enabled() const {
+        std::vector<bool> enabled(entries_.size());
+        for (size_t i = 0; i < entries_.size(); i++) {
+            auto &dependencies = entries_[i].dependencies;
+            enabled[i] = !entries_[i].disabled
+                         && std::all_of(dependencies.begin(), dependencies.end(), [&](const Dependency &dependency) {
+                return enabled[dependency.pass];
+            });
+        }
+        return enabled;
+    }
+
+    std::vector<std::string> PassManager::passes() const {
+        std::vector<std::string> names;
+        auto enabled = this->enabled();
+        for (size_t i = 0; i < entries_.size(); i++) {
+            if (enabled[i]) {
+                names.push_back(entries_[i].name);
+            }
+        }
+        return names;
+    }
+
+    std::vector<PassManager::Walk> PassManager::plan() const {
+        std::vector<Walk> walks;
+        std::vector<size_t> walk_of(entries_.size(), none);
+        // Whether walk `from` waits for walk `to`, if only through others.
+        std::function<bool(size_t, size_t)> waits = [&](size_t from, size_t to) {
+            auto &dependencies = walks[from].dependencies;
+            return from == to || std::any_of(dependencies.begin(), dependencies.end(), [&](size_t dependency) {
+                return waits(dependency, to);
+            });
+        };
+
+        auto enabled = this->enabled();
+        size_t previous = none;
+        for (size_t i = 0; i < entries_.size(); i++) {
+            if (!enabled[i]) {
+                continue;
+            }
+            auto &dependencies = entries_[i].dependencies;
+
+            size_t walk = none;
+            if (fusion_ && threads_ <= 1) {
+                walk = previous == none ? none : walk_of[previous];
+            } else if (fusion_) {
+                for (auto &dependency: dependencies) {
+                    walk = walk == none ? walk_of[dependency.pass] : std::max(walk, walk_of[dependency.pass]);
+                }
+            }
+            bool joins = walk != none && std::all_of(dependencies.begin(), dependencies.end(), [&](const Dependency &dependency) {
+                size_t other = walk_of[dependency.pass];
+                return other == walk ? dependency.needs == PassNeeds::SameClass : waits(walk, other);
+            });
+
+            if (joins) {
+                walks[walk].passes.push_back(i);
+            } else {
+                walk = walks.size();
+                walks.emplace_back();
+                walks.back().passes.push_back(i);
+                for (auto &dependency: dependencies) {
+                    auto &waited = walks.back().dependencies;
+                    if (std::find(waited.begin(), waited.end(), walk_of[dependency.pass]) == waited.end()) {
+                        waited.push_back(walk_of[dependency.pass]);
+                    }
+                }
+            }
+            walk_of[i] = walk;
+            previous = i;
+        }
+        return walks;
+    }
+
+    size_t PassManager::walks() const {
+        return plan().size();
+    }
+
+    void PassManager::run(const Program &program, const Walk &walk) {
+        for (auto pass: walk.passes) {
+            entries_[pass].pass->enter(program);
+        }
+        for (auto &clazz: program.class_declarations()->class_declarations()) {
+            for (auto pass: walk.passes) {
+                entries_[pass].pass->visit(*clazz);
+            }
+        }
+        for (auto pass: walk.passes) {
+            entries_[pass].pass->leave(program);
+        }
+    }
+
+    void PassManager::run(const Program &program, std::vector<SemanticError> &errors) {
+        auto walks = plan();
+        if (threads_ <= 1) {
+            for (auto &walk: walks) {
+                run(program, walk);
+            }
+        } else {
+            std::mutex mutex;
+            std::vector<size_t> waiting(walks.size());
+            std::vector<std::vector<size_t>> waited_by(walks.size());
+            std::vector<size_t> first;
+            for (size_t walk = 0; walk < walks.size(); walk++) {
+                waiting[walk] = walks[walk].dependencies.size();
+                for (auto dependency: walks[walk].dependencies) {
+                    waited_by[dependency].push_back(walk);
+                }
+                if (waiting[walk] == 0) {
+                    first.push_back(walk);
+                }
+            }
+
+            llvm::ThreadPool pool(llvm::hardware_concurrency(threads_));
+            std::function<void(size_t)> start = [&](size_t walk) {
+                pool.async([&, walk] {
+                    run(program, walks[walk]);
+                    std::vector<size_t> ready;
+                    {
+                        std::lock_guard lock(mutex);
+                        for (auto next: waited_by[walk]) {
+                            if (--waiting[next] == 0) {
+                                ready.push_back(next);
+                            }
+                        }
+                    }
+                    for (auto next: ready) {
+                        start(next);
+                    }
+                });
+            };
+            // Picked before any walk runs, which would count down the others.
+            for (auto walk: first) {
+                start(walk);
+            }
+            pool.wait();
+        }
+
+        for (auto &entry: entries_) {
+            errors.insert(errors.end(), entry.errors->begin(), entry.errors->end());
+            entry.errors->clear();
+        }
+    }
+
+    void add_semantic_passes(PassManager &passes, SymbolTable *symbol_table, SymbolTableIndex *symbol_table_index,
+                             const FlatAst *flat_ast) {
+        // Method signatures name classes declared further down, and a local
+        // variable may be a field declared further down: both need the whole
+        // program of the pass in front.
+        passes.add("class collector", [=](auto &errors) {
+            return SymbolTableClassCollectorVisitor(symbol_table, errors);
+        }, {}, {PassData::Classes});
+        passes.add("method collector", [=](auto &errors) {
+            return SymbolTableMethodCollectorVisitor(symbol_table, errors);
+        }, {{PassData::Classes}}, {PassData::Members});
+        passes.add("symbol table", [=](auto &errors) {
+            return SymbolTableVisitor(symbol_table, symbol_table_index, errors);
+        }, {{PassData::Classes}, {PassData::Members}}, {PassData::Scopes});
+        passes.add("entrypoint", [=](auto &errors) {
+            return EntryPointVisitor(symbol_table_index, errors);
+        }, {{PassData::Classes}, {PassData::Scopes, PassNeeds::SameClass}});
+        // Looks into other classes only for their methods and fields, which the
+        // collectors made; it types the fields itself.
+        passes.add("type checker", [=](auto &errors) {
+            return TypeCheckerVisitor(symbol_table_index, errors);
+        }, {{PassData::Members}, {PassData::Scopes, PassNeeds::SameClass}}, {PassData::Types});
+        if (flat_ast) {
+            passes.add("control flow", [=](auto &errors) {
+                return FlatCFAVisitor(*flat_ast, errors);
+            });
+        } else {
+            passes.add("control flow", [](auto &errors) {
+                return CFAVisitor(errors);
+            });
+        }
+        // Compares the type of a field with the one in a parent class, which
+        // may come further down.
+        passes.add("inheritance", [=](auto &errors) {
+            return InheritanceVisitor(symbol_table_index, errors);
+        }, {{PassData::Scopes, PassNeeds::SameClass}, {PassData::Types}});
+    }
+}
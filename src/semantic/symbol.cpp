@@ -6,9 +6,10 @@
 
 #include <sstream>
 
-Symbol::Symbol(const std::string &name, const NodeBase *declaredNode) : name_(name), declaredNode_(declaredNode) {}
+Symbol::Symbol(SymbolKind symbol_kind, yy::Name name, const NodeBase *declaredNode)
+        : name_(name), declaredNode_(declaredNode), symbol_kind_(symbol_kind) {}
 
-const std::string &Symbol::name() const noexcept {
+yy::Name Symbol::name() const noexcept {
     return name_;
 }
 
@@ -20,10 +21,10 @@ const NodeBase *Symbol::declaredNode() const noexcept {
 InstanceSymbol::InstanceSymbol(
         InstanceSymbolKind kind,
         const ClassSymbol *clazz,
-        const std::string &name,
+        yy::Name name,
         const NodeBase *declaredNode
 ) :
-        Symbol(name, declaredNode),
+        Symbol(SymbolKind::Instance, name, declaredNode),
         clazz_(clazz),
         kind_(kind) {}
 
@@ -59,9 +60,9 @@ MethodSymbol::MethodSymbol(
         const ClassSymbol *clazz,
         std::vector<ClassSymbol *> &&parameters,
         const ClassSymbol *returnType,
-        const std::string &name,
+        yy::Name name,
         const NodeBase *declaredNode
-) : Symbol(name, declaredNode),
+) : Symbol(SymbolKind::Method, name, declaredNode),
     kind_(kind),
     clazz_(clazz),
     parameters_(std::move(parameters)),
@@ -91,9 +92,7 @@ noexcept {
 const MethodDefinition *MethodSymbol::declaredNode() const
 
 noexcept {
-    return dynamic_cast
-
-            <const MethodDefinition *> (Symbol::declaredNode());
+    return llvm::dyn_cast_or_null<MethodDefinition>(Symbol::declaredNode());
 
 }
 
@@ -125,11 +124,12 @@ MethodSymbolKind MethodSymbol::kind() const {
 }
 
 
-ClassSymbol::ClassSymbol(const std::string &name, const NodeBase *declaredNode) : Symbol(name, declaredNode) {}
+ClassSymbol::ClassSymbol(yy::Name name, const NodeBase *declaredNode)
+        : Symbol(SymbolKind::Class, name, declaredNode) {}
 
 
 const ClassDefinition *ClassSymbol::declaredNode() const noexcept {
-    return dynamic_cast<const ClassDefinition *> (Symbol::declaredNode());
+    return llvm::dyn_cast_or_null<ClassDefinition>(Symbol::declaredNode());
 }
 
 
@@ -2,120 +2,307 @@
 // Created by Nikita Morozov on 25.05.2025.
 //
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "semantic/symbol_table.hpp"
 #include "semantic/mangling_transformer.hpp"
 
+namespace {
+    // The parent of the root.
+    constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+}
+
+// The scopes below a root, by index; the root is index 0 and lives where its
+// owner put it. Scopes are made in chunks of chunk_size and stay where they
+// are made, so SymbolTable pointers into the arena do not go stale.
+class SymbolTable::Arena {
+public:
+    explicit Arena(SymbolTable *root) : root_(root) {}
+
+    Arena(const Arena &) = delete;
 
-SymbolTable::SymbolTable(SymbolTable *parent, std::unique_ptr<Symbol> &&symbol)
-        : parent_(parent), symbol_(std::move(symbol)), symbols_{}, children_() {
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena() {
+        for (uint32_t index = 1; index < size_; index++) {
+            at(index)->~SymbolTable();
+        }
+    }
+
+    SymbolTable *add(uint32_t parent, yy::Name name, std::unique_ptr<Symbol> &&symbol) {
+        const uint32_t index = size_;
+        if ((index >> shift) == chunks_.size()) {
+            chunks_.push_back(std::make_unique<Chunk>());
+        }
+        auto *scope = new(&chunks_[index >> shift]->scopes[index & mask])
+                SymbolTable(this, index, parent, name, std::move(symbol));
+        size_++;
+        // A class declared in the root under its own name is found there from
+        // inside it too.
+        if (parent != 0) {
+            shadow(name);
+        }
+        if (parent != 0 || scope->symbol_name_ != name) {
+            shadow(scope->symbol_name_);
+        }
+        return scope;
+    }
+
+    SymbolTable *at(uint32_t index) const noexcept {
+        return index == 0 ? root_ : &chunks_[index >> shift]->scopes[index & mask];
+    }
+
+    uint32_t size() const noexcept {
+        return size_;
+    }
+
+    // Whether a lookup of `name` can stop anywhere but the root: something
+    // below it is declared as `name` or opened for a symbol of that name.
+    bool shadowed(yy::Name name) const noexcept {
+        return name.id() < shadowed_.size() && shadowed_[name.id()];
+    }
+
+    // Room for a hash table of `capacity` entries at the end of tables_.
+    Table allocate(uint32_t capacity) {
+        const auto offset = static_cast<uint32_t>(tables_.size());
+        tables_.resize(tables_.size() + capacity);
+        return {offset, capacity};
+    }
+
+    Entry *entries(Table table) noexcept {
+        return tables_.data() + table.offset;
+    }
 
+    // The hash tables of the scopes with more than inline_entries names, one
+    // after another: open addressing, a power of two long and at most half
+    // full. A table that grows moves to the end and leaves its old entries
+    // behind, which at most doubles what it takes.
+    std::vector<Entry> tables_;
+
+private:
+    static constexpr uint32_t shift = 10;
+    static constexpr uint32_t mask = (1u << shift) - 1;
+
+    // Storage for scopes, which add() makes one at a time.
+    struct Chunk {
+        Chunk() {}
+
+        ~Chunk() {}
+
+        union {
+            SymbolTable scopes[1u << shift];
+        };
+    };
+
+    SymbolTable *root_;
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    std::vector<bool> shadowed_;
+    // The root's slot in the first chunk stays empty.
+    uint32_t size_ = 1;
+
+    void shadow(yy::Name name) {
+        if (name.empty()) {
+            return;
+        }
+        if (name.id() >= shadowed_.size()) {
+            shadowed_.resize(name.id() + 1);
+        }
+        shadowed_[name.id()] = true;
+    }
+};
+
+SymbolTable::SymbolTable(std::unique_ptr<Symbol> &&symbol)
+        : SymbolTable(nullptr, 0, none, yy::Name(), std::move(symbol)) {
+    arena_ = new Arena(this);
+}
+
+SymbolTable::SymbolTable(
+        Arena *arena,
+        uint32_t index,
+        uint32_t parent,
+        yy::Name name,
+        std::unique_ptr<Symbol> &&symbol
+) : arena_(arena), symbol_(std::move(symbol)), index_(index), parent_(parent), name_(name),
+    symbol_name_(symbol_ ? symbol_->name() : yy::Name()) {
+    // Lookups of `this` and of the method skip the root.
+    if (parent_ == none) {
+        owner_ = none;
+    } else if (llvm::isa_and_nonnull<ClassSymbol, MethodSymbol>(symbol_.get())) {
+        owner_ = index_;
+    } else {
+        owner_ = arena_->at(parent_)->owner_;
+    }
+}
+
+SymbolTable::~SymbolTable() {
+    // The scopes below go with the arena, none of them through another.
+    if (parent_ == none) {
+        delete arena_;
+    }
 }
 
 Symbol *SymbolTable::get_symbol() {
     return symbol_.get();
 }
 
-SymbolTable *SymbolTable::add_symbol(const std::string &name, std::unique_ptr<Symbol> &&symbol) {
-    if (auto it = symbols_.find(name); it != symbols_.end()) {
+SymbolTable *SymbolTable::add_symbol(yy::Name name, std::unique_ptr<Symbol> &&symbol) {
+    if (find(name)) {
         return nullptr;
     }
 
-    auto child = std::make_unique<SymbolTable>(this, std::move(symbol));
-    auto it = symbols_.emplace(name, std::move(child));
-    if (!it.second) {
-        return nullptr;
+    auto child = arena_->add(index_, name, std::move(symbol));
+    // An empty name is never looked up.
+    if (name.empty()) {
+        return child;
     }
 
-    return it.first->second.get();
+    if (size_ < inline_entries) {
+        entries_[size_++] = {name, child->index_};
+        return child;
+    }
+
+    if (size_ == inline_entries) {
+        Entry entries[inline_entries];
+        std::copy(entries_, entries_ + inline_entries, entries);
+        // A power of two, so that the hash is masked rather than divided.
+        table_ = arena_->allocate(16);
+        for (auto &entry: entries) {
+            insert(arena_->entries(table_), table_.capacity, entry);
+        }
+    }
+
+    if ((size_ + 1) * 2 > table_.capacity) {
+        const Table grown = arena_->allocate(table_.capacity * 2);
+        const Entry *table = arena_->entries(table_);
+        for (uint32_t slot = 0; slot < table_.capacity; slot++) {
+            if (!table[slot].name.empty()) {
+                insert(arena_->entries(grown), grown.capacity, table[slot]);
+            }
+        }
+        table_ = grown;
+    }
+    insert(arena_->entries(table_), table_.capacity, {name, child->index_});
+    size_++;
+    return child;
 }
 
 SymbolTable *SymbolTable::add_child() {
-    auto child = std::make_unique<SymbolTable>(this);
+    return arena_->add(index_, yy::Name(), {});
+}
 
-    children_.push_back(std::move(child));
-    return children_.rbegin()->get();
+void SymbolTable::insert(Entry *table, uint32_t capacity, Entry entry) noexcept {
+    const size_t mask = capacity - 1;
+    size_t slot = std::hash<yy::Name>{}(entry.name) & mask;
+    while (!table[slot].name.empty()) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = entry;
 }
 
-SymbolTable *SymbolTable::resolve_symbol(const std::string &name) const noexcept {
+SymbolTable *SymbolTable::find(yy::Name name) const noexcept {
+    // What the empty slots of a table hold.
     if (name.empty()) {
         return nullptr;
     }
 
-    if (symbol_ && symbol_->name() == name) {
-        return const_cast<SymbolTable *>(this);
+    if (size_ <= inline_entries) {
+        for (uint32_t i = 0; i < size_; i++) {
+            if (entries_[i].name == name) {
+                return arena_->at(entries_[i].scope);
+            }
+        }
+        return nullptr;
     }
 
-    if (auto symbol = symbols_.find(name); symbol != symbols_.end()) {
-        return symbol->second.get();
-    } else {
-        return parent_ ? parent_->resolve_symbol(name) : nullptr;
+    const Entry *table = arena_->entries(table_);
+    const size_t mask = table_.capacity - 1;
+    for (size_t slot = std::hash<yy::Name>{}(name) & mask;; slot = (slot + 1) & mask) {
+        if (table[slot].name == name) {
+            return arena_->at(table[slot].scope);
+        }
+        if (table[slot].name.empty()) {
+            return nullptr;
+        }
     }
 }
 
-MethodSymbol *SymbolTable::method_scope() {
-    for (auto symbol_table = this;
-         symbol_table->parent_ != nullptr;
-         symbol_table = symbol_table->parent_) {
-        if (!symbol_table->symbol_) {
-            continue;
-        }
+const SymbolTable *SymbolTable::parent() const noexcept {
+    return parent_ == none ? nullptr : arena_->at(parent_);
+}
 
-        if (auto clazz = dynamic_cast<const MethodSymbol *>(symbol_table->symbol_.get()); clazz != nullptr) {
-            return const_cast<MethodSymbol *>(clazz);
-        }
+SymbolTable *SymbolTable::resolve_symbol(yy::Name name) const noexcept {
+    if (name.empty()) {
+        return nullptr;
+    }
+
+    // Nothing on the way can stop the walk, so the root is where it ends.
+    if (!arena_->shadowed(name)) {
+        auto root = arena_->at(0);
+        return root->symbol_name_ == name ? root : root->find(name);
     }
 
+    for (auto symbol_table = this; symbol_table; symbol_table = symbol_table->parent()) {
+        if (symbol_table->symbol_name_ == name) {
+            return const_cast<SymbolTable *>(symbol_table);
+        }
+        if (auto found = symbol_table->find(name)) {
+            return found;
+        }
+    }
     return nullptr;
 }
 
-ClassSymbol *SymbolTable::resolve_this() const noexcept {
-    for (auto symbol_table = this;
-         symbol_table->parent_ != nullptr;
-         symbol_table = symbol_table->parent_) {
-        if (!symbol_table->symbol_) {
-            continue;
+MethodSymbol *SymbolTable::method_scope() {
+    for (auto owner = owner_; owner != none; owner = arena_->at(arena_->at(owner)->parent_)->owner_) {
+        if (auto method = llvm::dyn_cast<MethodSymbol>(arena_->at(owner)->symbol_.get())) {
+            return method;
         }
+    }
 
+    return nullptr;
+}
 
-        if (auto clazz = dynamic_cast<const ClassSymbol *>(symbol_table->symbol_.get()); clazz != nullptr) {
-            return const_cast<ClassSymbol *>(clazz);
+ClassSymbol *SymbolTable::resolve_this() const noexcept {
+    for (auto owner = owner_; owner != none; owner = arena_->at(arena_->at(owner)->parent_)->owner_) {
+        if (auto clazz = llvm::dyn_cast<ClassSymbol>(arena_->at(owner)->symbol_.get())) {
+            return clazz;
         }
     }
 
     return nullptr;
 }
 
-ClassSymbol *SymbolTable::resolve_class(const std::string &name) const noexcept {
+ClassSymbol *SymbolTable::resolve_class(yy::Name name) const noexcept {
     SymbolTable *child = resolve_symbol(name);
     if (!child) {
         return nullptr;
     }
 
-    return dynamic_cast<ClassSymbol *>(child->symbol_.get());
+    return llvm::dyn_cast_or_null<ClassSymbol>(child->symbol_.get());
 }
 
 MethodSymbol *SymbolTable::resolve_method(
-        const std::string &class_name,
-        const std::string &method_name,
+        yy::Name class_name,
+        yy::Name method_name,
         const std::vector<ClassSymbol *> &args
 ) const noexcept {
     auto clazz_table = resolve_symbol(class_name);
     if (!clazz_table) {
         return nullptr;
     }
-    auto name = transform_to_mangling_name(method_name, args);
+    auto name = yy::Name::find(transform_to_mangling_name(method_name, args));
     auto method_table = clazz_table->resolve_symbol(name);
     if (!method_table) {
         return nullptr;
     }
-    return dynamic_cast<MethodSymbol *>(method_table->symbol_.get());
+    return llvm::dyn_cast_or_null<MethodSymbol>(method_table->symbol_.get());
 }
 
 InstanceSymbol *SymbolTable::resolve_field(
-        const std::string &class_name,
-        const std::string &field_name
+        yy::Name class_name,
+        yy::Name field_name
 ) const noexcept {
     auto clazz_table = resolve_symbol(class_name);
     if (!clazz_table) {
@@ -125,39 +312,58 @@ InstanceSymbol *SymbolTable::resolve_field(
     return clazz_table->resolve_local(field_name);
 }
 
-InstanceSymbol *SymbolTable::resolve_local(const std::string &name) const noexcept {
+InstanceSymbol *SymbolTable::resolve_local(yy::Name name) const noexcept {
     SymbolTable *local_table = resolve_symbol(name);
     if (!local_table) {
         return nullptr;
     }
 
-    return dynamic_cast<InstanceSymbol *>(local_table->symbol_.get());
+    return llvm::dyn_cast_or_null<InstanceSymbol>(local_table->symbol_.get());
 }
 
 std::string SymbolTable::print_debug_info(size_t offset) const {
+    // The scopes below each, in the order they were made.
+    std::vector<std::vector<uint32_t>> below(arena_->size());
+    for (uint32_t index = 1; index < arena_->size(); index++) {
+        below[arena_->at(index)->parent_].push_back(index);
+    }
+
     std::ostringstream out;
+    print_debug_info(out, offset, below);
+    return out.str();
+}
+
+void SymbolTable::print_debug_info(
+        std::ostream &out,
+        size_t offset,
+        const std::vector<std::vector<uint32_t>> &below
+) const {
+    std::vector<const SymbolTable *> symbols;
+    std::vector<const SymbolTable *> children;
+    for (auto index: below[index_]) {
+        auto scope = arena_->at(index);
+        (scope->symbol_ || !scope->name_.empty() ? symbols : children).push_back(scope);
+    }
 
     out << "{" << std::endl;
     out << std::string(offset, ' ') << R"( "type": "symbol_table")" << std::endl;
     if (symbol_) {
         out << std::string(offset, ' ') << " \"symbol\": " << symbol_->print_debug_info(offset + 1) << std::endl;
     }
-    if (!symbols_.empty()) {
+    if (!symbols.empty()) {
         out << std::string(offset, ' ') << " \"symbols\": [" << std::endl;
-        std::for_each(symbols_.begin(), symbols_.end(), [&out, &offset](auto &pair) {
-            out << std::string(offset + 1, ' ') << "\"" << pair.first << "\": ";
-            out << pair.second->print_debug_info(offset + 1);
-        });
+        for (auto scope: symbols) {
+            out << std::string(offset + 1, ' ') << "\"" << scope->name_ << "\": ";
+            scope->print_debug_info(out, offset + 1, below);
+        }
         out << std::string(offset, ' ') << "]" << std::endl;
     }
-    if (!children_.empty()) {
+    if (!children.empty()) {
         out << std::string(offset, ' ') << " \"children\": [" << std::endl;
-        std::for_each(children_.begin(), children_.end(), [&out, &offset](auto &child) {
-            out << child->print_debug_info(offset + 1);
-        });
+        for (auto scope: children) {
+            scope->print_debug_info(out, offset + 1, below);
+        }
         out << std::string(offset, ' ') << "]" << std::endl;
     }
     out << std::string(offset, ' ') << "}";
-
-    return out.str();
 }
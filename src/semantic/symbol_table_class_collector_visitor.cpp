@@ -23,7 +23,7 @@ void yy::SymbolTableClassCollectorVisitor::operator()(const ClassDefinition &cla
     auto child = scope_symbol_table_->add_symbol(class_definition.header()->name(), std::move(symbol));
     if (!child) {
         semantic_errors_.emplace_back(
-                "Symbol already defined: " + class_definition.header()->name(),
+                "Symbol already defined: " + class_definition.header()->name().str(),
                 class_definition.location()
         );
     }
@@ -7,7 +7,7 @@
 SymbolTableIndex::SymbolTableIndex() : index_{} {}
 
 void SymbolTableIndex::commit(const NodeBase *location, SymbolTable *symbol_table) {
-    index_.emplace(location, symbol_table);
+    index_.try_emplace(location, symbol_table);
 }
 
 SymbolTable &SymbolTableIndex::restore(const NodeBase *location) {
@@ -7,8 +7,8 @@
 
 void yy::SymbolTableMethodCollectorVisitor::operator()(const VariableDeclaration &variable_declaration) {
     // todo: inheritanse issue
-    const std::string &var_name = variable_declaration.name();
-    auto *location = dynamic_cast<const MemberDeclarationExpr *>(&variable_declaration);
+    yy::Name var_name = variable_declaration.name();
+    auto *location = static_cast<const MemberDeclarationExpr *>(&variable_declaration);
     auto symbol = std::make_unique<InstanceSymbol>(
             field,
             nullptr,
@@ -21,7 +21,7 @@ void yy::SymbolTableMethodCollectorVisitor::operator()(const VariableDeclaration
     auto child = scope_symbol_table_->add_symbol(var_name, std::move(symbol));
     if (!child) {
         semantic_errors_.emplace_back(
-                "Symbol already defined: " + clazz->name() + "::" + var_name,
+                "Symbol already defined: " + clazz->name().str() + "::" + var_name.str(),
                 location->location()
         );
     }
@@ -84,7 +84,7 @@ void yy::SymbolTableMethodCollectorVisitor::operator()(const ClassDefinition &cl
 
 void yy::SymbolTableMethodCollectorVisitor::add_method(
         MethodSymbolKind kind,
-        const std::string &method_name,
+        yy::Name method_name,
         const std::vector<std::unique_ptr<ParameterDeclaration>> &parameters,
         const ClassSymbol *return_type,
         const NodeBase *node
@@ -99,7 +99,7 @@ void yy::SymbolTableMethodCollectorVisitor::add_method(
             }
     );
 
-    auto name = transform_to_mangling_name(method_name, params);
+    auto name = yy::Name(transform_to_mangling_name(method_name, params));
     const ClassSymbol *clazz = scope_symbol_table_->resolve_this();
     auto symbol = std::make_unique<MethodSymbol>(
             kind,
@@ -113,7 +113,7 @@ void yy::SymbolTableMethodCollectorVisitor::add_method(
     auto child = scope_symbol_table_->add_symbol(name, std::move(symbol));
     if (!child) {
         semantic_errors_.emplace_back(
-                "Symbol already defined: " + clazz->name() + "::" + method_name + "(...)",
+                "Symbol already defined: " + clazz->name().str() + "::" + method_name.str() + "(...)",
                 node->location()
         );
     }
@@ -12,75 +12,86 @@
 #include "stdlib/builtins.hpp"
 
 
-void yy::TypeCheckerVisitor::operator()(const BooleanLiteralExpr &boolean_literal_expr) {
+bool yy::TypeCheckerVisitor::enter(const BooleanLiteralExpr &boolean_literal_expr) {
     auto &symbol_table = symbol_table_index_->restore(&boolean_literal_expr);
     result_ = symbol_table.resolve_class(oppstd::bool_class);
+    return true;
 }
 
-void yy::TypeCheckerVisitor::operator()(const IntegerLiteralExpr &integer_literal_expr) {
+bool yy::TypeCheckerVisitor::enter(const IntegerLiteralExpr &integer_literal_expr) {
     auto &symbol_table = symbol_table_index_->restore(&integer_literal_expr);
     result_ = symbol_table.resolve_class(oppstd::integer_class);
+    return true;
 }
 
-void yy::TypeCheckerVisitor::operator()(const RealLiteralExpr &real_literal_expr) {
+bool yy::TypeCheckerVisitor::enter(const RealLiteralExpr &real_literal_expr) {
     auto &symbol_table = symbol_table_index_->restore(&real_literal_expr);
     result_ = symbol_table.resolve_class(oppstd::real_class);
+    return true;
 }
 
-void yy::TypeCheckerVisitor::operator()(const StringLiteralExpr &string_literal_expr) {
+bool yy::TypeCheckerVisitor::enter(const StringLiteralExpr &string_literal_expr) {
     auto &symbol_table = symbol_table_index_->restore(&string_literal_expr);
     result_ = symbol_table.resolve_class(oppstd::string_class);
+    return true;
 }
 
-void yy::TypeCheckerVisitor::operator()(const ThisExpr &this_expr) {
+bool yy::TypeCheckerVisitor::enter(const ThisExpr &this_expr) {
     auto &symbol_table = symbol_table_index_->restore(&this_expr);
     result_ = symbol_table.resolve_this();
+    return true;
 }
 
-void yy::TypeCheckerVisitor::operator()(const FieldAccessExpr &field_access_expr) {
+bool yy::TypeCheckerVisitor::enter(const FieldAccessExpr &field_access_expr) {
     auto &symbol_table = symbol_table_index_->restore(&field_access_expr);
     if (callee_) {
         auto field = symbol_table.resolve_field(callee_->name(), field_access_expr.name());
         if (!field) {
             semantic_errors_.emplace_back("Missing property", field_access_expr.location());
             result_ = nullptr;
-            return;
+            return true;
         }
 
         if (!field->clazz()) {
             semantic_errors_.emplace_back(
-                    "Ambiguous variable type: " + field_access_expr.name(),
+                    "Ambiguous variable type: " + field_access_expr.name().str(),
                     field_access_expr.location()
             );
             result_ = nullptr;
-            return;
+            return true;
         }
         result_ = const_cast<ClassSymbol *>(field->clazz());
 
-        return;
+        return true;
     }
 
     result_ = symbol_table.resolve_local(field_access_expr.name());
+    return true;
+}
+
+bool yy::TypeCheckerVisitor::enter(const MethodCallExpr &) {
+    calls_.emplace_back(arguments_.size(), false);
+    return true;
+}
+
+void yy::TypeCheckerVisitor::after(const MethodCallExpr &method_call_expr, size_t child) {
+    auto arg_type = llvm::dyn_cast_or_null<ClassSymbol>(result_);
+
+    if (!arg_type) {
+        semantic_errors_.emplace_back("Cant get arg type", method_call_expr.arguments()[child]->location());
+        calls_.back().second = true;
+        return;
+    }
+
+    arguments_.push_back(arg_type);
 }
 
-void yy::TypeCheckerVisitor::operator()(const MethodCallExpr &method_call_expr) {
+void yy::TypeCheckerVisitor::leave(const MethodCallExpr &method_call_expr) {
     auto &symbol_table = symbol_table_index_->restore(&method_call_expr);
-    std::vector<ClassSymbol *> args;
-    bool has_error = false;
-    std::for_each(
-            method_call_expr.arguments().begin(),
-            method_call_expr.arguments().end(),
-            [&args, this, &has_error](auto &arg) {
-                auto arg_type = dynamic_cast<ClassSymbol *>(arg->accept(*this));
-
-                if (!arg_type) {
-                    semantic_errors_.emplace_back("Cant get arg type", arg->location());
-                    has_error = true;
-                    return;
-                }
-
-                args.push_back(arg_type);
-            });
+    auto [first, has_error] = calls_.back();
+    calls_.pop_back();
+    std::vector<ClassSymbol *> args(arguments_.begin() + first, arguments_.end());
+    arguments_.resize(first);
 
     if (has_error) {
         result_ = nullptr;
@@ -124,18 +135,22 @@ void yy::TypeCheckerVisitor::operator()(const MethodCallExpr &method_call_expr)
     result_ = const_cast<ClassSymbol *>(constructor->returnType());
 }
 
-void yy::TypeCheckerVisitor::operator()(const MemberAccess &member_access) {
-    auto rhs = member_access.lhs()->accept(*this);
-    auto callee = dynamic_cast<ClassSymbol *>(rhs);
+void yy::TypeCheckerVisitor::after(const MemberAccess &, size_t child) {
+    if (child != 0) {
+        return;
+    }
+    auto callee = llvm::dyn_cast_or_null<ClassSymbol>(result_);
     if (callee) {
         callee_ = callee;
     }
-    member_access.rhs()->accept(*this);
+}
+
+void yy::TypeCheckerVisitor::leave(const MemberAccess &) {
     callee_ = nullptr;
 }
 
 
-void yy::TypeCheckerVisitor::operator()(const ReturnStmt &return_stmt) {
+bool yy::TypeCheckerVisitor::enter(const ReturnStmt &return_stmt) {
     auto &symbol_table = symbol_table_index_->restore(&return_stmt);
     auto method_scope = symbol_table.method_scope();
     if (!method_scope) {
@@ -143,24 +158,31 @@ void yy::TypeCheckerVisitor::operator()(const ReturnStmt &return_stmt) {
                 "Unexpected return statement",
                 return_stmt.location()
         );
-        return;
+        return false;
     }
+    methods_.push_back(method_scope);
+    return true;
+}
+
+void yy::TypeCheckerVisitor::leave(const ReturnStmt &return_stmt) {
+    auto method_scope = methods_.back();
+    methods_.pop_back();
 
-    auto type = return_stmt.expression()->accept(*this);
+    auto type = result_;
     if (!type && method_scope->returnType()) {
         semantic_errors_.emplace_back(
-                "Expected type: " + method_scope->returnType()->name() + ", but found: nullptr",
+                "Expected type: " + method_scope->returnType()->name().str() + ", but found: nullptr",
                 return_stmt.location()
         );
         return;
     }
 
 
-    auto return_type = dynamic_cast<ClassSymbol *>(type);
+    auto return_type = llvm::dyn_cast_or_null<ClassSymbol>(type);
 
     if (return_type != method_scope->returnType()) {
-        auto expected = method_scope->returnType() ? method_scope->returnType()->name() : "void";
-        auto actual = return_type ? return_type->name() : "nullptr(void)";
+        auto expected = method_scope->returnType() ? method_scope->returnType()->name().str() : "void";
+        auto actual = return_type ? return_type->name().str() : "nullptr(void)";
         semantic_errors_.emplace_back(
                 "Expected type: " + expected + ", but found: " + actual,
                 return_stmt.location()
@@ -169,20 +191,27 @@ void yy::TypeCheckerVisitor::operator()(const ReturnStmt &return_stmt) {
 
 }
 
-void yy::TypeCheckerVisitor::operator()(const AssignmentStmt &assignment_stmt) {
+bool yy::TypeCheckerVisitor::enter(const AssignmentStmt &assignment_stmt) {
     auto &symbol_table = symbol_table_index_->restore(&assignment_stmt);
     auto symbol = symbol_table.resolve_local(assignment_stmt.name());
     if (!symbol->clazz()) {
         semantic_errors_.emplace_back(
-                "Ambiguous variable type: " + assignment_stmt.name(),
+                "Ambiguous variable type: " + assignment_stmt.name().str(),
                 assignment_stmt.location()
         );
     }
+    locals_.push_back(symbol);
+    return true;
+}
+
+void yy::TypeCheckerVisitor::leave(const AssignmentStmt &assignment_stmt) {
+    auto symbol = locals_.back();
+    locals_.pop_back();
 
-    auto expr_type = dynamic_cast<ClassSymbol *>(assignment_stmt.expression()->accept(*this));
+    auto expr_type = llvm::dyn_cast_or_null<ClassSymbol>(result_);
     if (!expr_type) {
         semantic_errors_.emplace_back(
-                "Ambiguous expression type: " + assignment_stmt.name(),
+                "Ambiguous expression type: " + assignment_stmt.name().str(),
                 assignment_stmt.location()
         );
         return;
@@ -190,82 +219,93 @@ void yy::TypeCheckerVisitor::operator()(const AssignmentStmt &assignment_stmt) {
 
     if (symbol->clazz() && symbol->clazz() != expr_type) {
         semantic_errors_.emplace_back(
-                "Expected type: " + symbol->clazz()->name() + ", but found: " + expr_type->name(),
+                "Expected type: " + symbol->clazz()->name().str() + ", but found: " + expr_type->name().str(),
                 assignment_stmt.location()
         );
     }
 }
 
-void yy::TypeCheckerVisitor::operator()(const IfStmt &if_stmt) {
+void yy::TypeCheckerVisitor::after(const IfStmt &if_stmt, size_t child) {
+    if (child != 0) {
+        return;
+    }
     auto &symbol_table = symbol_table_index_->restore(&if_stmt);
-    auto condition = dynamic_cast<ClassSymbol *>(if_stmt.condition()->accept(*this));
+    auto condition = llvm::dyn_cast_or_null<ClassSymbol>(result_);
     auto boolean = symbol_table.resolve_class(oppstd::bool_class);
     if (condition != boolean) {
+        auto actual = condition ? condition->name().str() : "nullptr";
         semantic_errors_.emplace_back(
-                "Expected type: " + boolean->name() + ", but found: " + condition->name(),
+                "Expected type: " + boolean->name().str() + ", but found: " + actual,
                 if_stmt.condition()->location()
         );
     }
-
-    if_stmt.then_body()->accept(*this);
-
-    if (if_stmt.else_body()) {
-        if_stmt.else_body()->accept(*this);
-    }
 }
 
-void yy::TypeCheckerVisitor::operator()(const WhileStmt &while_stmt) {
+void yy::TypeCheckerVisitor::after(const WhileStmt &while_stmt, size_t child) {
+    if (child != 0) {
+        return;
+    }
     auto &symbol_table = symbol_table_index_->restore(&while_stmt);
-    auto condition = dynamic_cast<ClassSymbol *>(while_stmt.condition()->accept(*this));
+    auto condition = llvm::dyn_cast_or_null<ClassSymbol>(result_);
     auto boolean = symbol_table.resolve_class(oppstd::bool_class);
     if (condition != boolean) {
+        auto actual = condition ? condition->name().str() : "nullptr";
         semantic_errors_.emplace_back(
-                "Expected type: " + boolean->name() + ", but found: " + condition->name(),
+                "Expected type: " + boolean->name().str() + ", but found: " + actual,
                 while_stmt.condition()->location()
         );
     }
-    while_stmt.loop_body()->accept(*this);
 }
 
 
-void yy::TypeCheckerVisitor::operator()(const ParameterDeclaration &parameter_declaration) {
+bool yy::TypeCheckerVisitor::enter(const ParameterDeclaration &parameter_declaration) {
     auto &symbol_table = symbol_table_index_->restore(&parameter_declaration);
     auto scope = symbol_table.resolve_this();
     if (symbol_table.resolve_local(parameter_declaration.name())->clazz() == scope) {
         semantic_errors_.emplace_back(
-                "Recursive type in constructor: " + scope->name(),
+                "Recursive type in constructor: " + scope->name().str(),
                 parameter_declaration.location()
         );
     }
+    return true;
 }
 
-void yy::TypeCheckerVisitor::operator()(const VariableDeclaration &variable_declaration) {
-    auto *location = dynamic_cast<const MemberDeclarationExpr *>(&variable_declaration);
+bool yy::TypeCheckerVisitor::enter(const VariableDeclaration &variable_declaration) {
+    auto *location = static_cast<const MemberDeclarationExpr *>(&variable_declaration);
     auto &symbol_table = symbol_table_index_->restore(location);
-    auto variable = symbol_table.resolve_local(variable_declaration.name());
 
+    auto variable = symbol_table.resolve_local(variable_declaration.name());
     if (!variable) {
         semantic_errors_.emplace_back(
-                "Unexpected identifier: " + variable_declaration.name(),
+                "Unexpected identifier: " + variable_declaration.name().str(),
                 location->location()
         );
         result_ = nullptr;
-        return;
+        return false;
     }
-    auto type = dynamic_cast<ClassSymbol *>(variable_declaration.initializer()->accept(*this));
+    locals_.push_back(variable);
+    return true;
+}
+
+void yy::TypeCheckerVisitor::leave(const VariableDeclaration &variable_declaration) {
+    auto *location = static_cast<const MemberDeclarationExpr *>(&variable_declaration);
+    auto variable = locals_.back();
+    locals_.pop_back();
+
+    auto type = llvm::dyn_cast_or_null<ClassSymbol>(result_);
     if (!type) {
         semantic_errors_.emplace_back(
-                "Can`t infer type: " + variable_declaration.name(),
+                "Can`t infer type: " + variable_declaration.name().str(),
                 location->location()
         );
         result_ = nullptr;
         return;
     }
 
-    ClassSymbol *class_scope = symbol_table.resolve_this();
+    ClassSymbol *class_scope = symbol_table_index_->restore(location).resolve_this();
     if (type == class_scope) {
         semantic_errors_.emplace_back(
-                "Recursive type forbidden: " + variable_declaration.name(),
+                "Recursive type forbidden: " + variable_declaration.name().str(),
                 location->location()
         );
         result_ = nullptr;
@@ -276,5 +316,3 @@ void yy::TypeCheckerVisitor::operator()(const VariableDeclaration &variable_decl
     variable->setClazz(type);
     result_ = type;
 }
-
-
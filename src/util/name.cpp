@@ -0,0 +1,95 @@
+#include "util/name.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    constexpr unsigned page_bits = 12;
+    constexpr uint32_t page_size = 1u << page_bits;
+    constexpr size_t max_pages = 1u << 12;
+
+    // The interned strings by handle, in pages that never move, so a handle is
+    // turned back into its string without taking the lock.
+    class NamePool {
+    public:
+        NamePool() {
+            intern("");
+        }
+
+        uint32_t intern(std::string_view text) {
+            std::lock_guard lock(mutex_);
+            if (auto found = ids_.find(text); found != ids_.end()) {
+                return found->second;
+            }
+            const uint32_t id = size_;
+            if (id % page_size == 0) {
+                if (id / page_size == max_pages) {
+                    throw std::runtime_error("Cant intern more than " + std::to_string(max_pages * page_size) + " names");
+                }
+                pages_[id / page_size].store(new std::string[page_size], std::memory_order_release);
+            }
+            std::string &stored = slot(id);
+            stored = text;
+            ids_.emplace(stored, id);
+            ++size_;
+            return id;
+        }
+
+        // 0, the empty name, if `text` was never interned.
+        uint32_t find(std::string_view text) {
+            std::lock_guard lock(mutex_);
+            auto found = ids_.find(text);
+            return found != ids_.end() ? found->second : 0;
+        }
+
+        const std::string &str(uint32_t id) const noexcept {
+            return slot(id);
+        }
+
+    private:
+        std::string &slot(uint32_t id) const noexcept {
+            return pages_[id >> page_bits].load(std::memory_order_acquire)[id & (page_size - 1)];
+        }
+
+        std::mutex mutex_;
+        std::unordered_map<std::string_view, uint32_t> ids_;
+        std::array<std::atomic<std::string *>, max_pages> pages_{};
+        uint32_t size_ = 0;
+    };
+
+    // Never destroyed: names may be read by destructors of other statics.
+    NamePool &pool() {
+        static auto *instance = new NamePool();
+        return *instance;
+    }
+
+    // The names this thread has interned or found, so that most of them are
+    // looked up without taking the pool's lock. The keys point into the pool.
+    thread_local std::unordered_map<std::string_view, uint32_t> seen;
+}
+
+namespace yy {
+
+    Name::Name(std::string_view text) {
+        if (auto found = seen.find(text); found != seen.end()) {
+            id_ = found->second;
+            return;
+        }
+        id_ = pool().intern(text);
+        seen.emplace(pool().str(id_), id_);
+    }
+
+    Name Name::find(std::string_view text) {
+        if (auto found = seen.find(text); found != seen.end()) {
+            return Name(found->second);
+        }
+        return Name(pool().find(text));
+    }
+
+    const std::string &Name::str() const noexcept {
+        return pool().str(id_);
+    }
+}
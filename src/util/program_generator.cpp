@@ -0,0 +1,219 @@
+#include "util/program_generator.hpp"
+
+#include <array>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr std::array<const char *, 4> type_names = {"Integer", "Real", "String", "Boolean"};
+    constexpr size_t fields_per_class = 3;
+
+    // mt19937 is specified bit for bit, unlike the standard distributions, so
+    // picks are taken modulo the range to keep the output the same everywhere.
+    class Generator {
+    public:
+        explicit Generator(const yy::ProgramShape &shape) : shape_(shape), random_(shape.seed) {}
+
+        std::string program() {
+            for (size_t i = 0; i < shape_.classes; i++) {
+                class_definition(i);
+            }
+            out_ += "class Main is\n    this() is\n";
+            for (size_t i = 0; i < shape_.classes; i++) {
+                out_ += "        var c" + std::to_string(i) + " : C" + std::to_string(i) + "()\n";
+            }
+            out_ += "    end\nend\n\nMain()\n";
+            return std::move(out_);
+        }
+
+    private:
+        size_t pick(size_t range) {
+            return range ? random_() % range : 0;
+        }
+
+        void line(size_t indent) {
+            out_.append(4 * indent, ' ');
+        }
+
+        void class_definition(size_t index) {
+            out_ += "class C" + std::to_string(index);
+            if (index > 0 && pick(3) == 0) {
+                out_ += " extends C" + std::to_string(pick(index));
+            }
+            out_ += " is\n";
+            for (size_t i = 0; i < fields_per_class; i++) {
+                line(1);
+                out_ += "var f" + std::to_string(i) + " : ";
+                literal();
+                out_ += "\n";
+            }
+
+            out_ += "    this() is\n";
+            scope_.clear();
+            body(2, 0);
+            out_ += "    end\n";
+
+            for (size_t i = 0; i < shape_.methods_per_class; i++) {
+                method_definition(i);
+            }
+            out_ += "end\n\n";
+        }
+
+        void method_definition(size_t index) {
+            scope_.clear();
+            out_ += "    method m" + std::to_string(index) + "(";
+            for (size_t i = 0; i < index % 4; i++) {
+                std::string name = "p" + std::to_string(i);
+                out_ += (i ? ", " : "") + name + ": " + type_names[(index + i) % 4];
+                scope_.push_back(std::move(name));
+            }
+            out_ += ") : ";
+            out_ += type_names[index % 4];
+            out_ += " is\n";
+            body(2, shape_.body_depth);
+            line(2);
+            out_ += "return ";
+            expression();
+            out_ += "\n    end\n";
+        }
+
+        // A few declarations and assignments, then one nested statement per level left.
+        void body(size_t indent, size_t depth) {
+            const size_t outer = scope_.size();
+            for (size_t i = 0, n = 1 + pick(2); i < n; i++) {
+                std::string name = "v" + std::to_string(locals_++);
+                line(indent);
+                out_ += "var " + name + " : ";
+                expression();
+                out_ += "\n";
+                scope_.push_back(std::move(name));
+            }
+            line(indent);
+            out_ += scope_[pick(scope_.size())] + " := ";
+            expression();
+            out_ += "\n";
+
+            if (depth > 0) {
+                line(indent);
+                switch (pick(3)) {
+                    case 0:
+                        out_ += "while ";
+                        expression();
+                        out_ += " loop\n";
+                        body(indent + 1, depth - 1);
+                        break;
+                    case 1:
+                        out_ += "if ";
+                        expression();
+                        out_ += " then\n";
+                        body(indent + 1, depth - 1);
+                        break;
+                    default:
+                        out_ += "if ";
+                        expression();
+                        out_ += " then\n";
+                        body(indent + 1, depth - 1);
+                        line(indent);
+                        out_ += "else\n";
+                        body(indent + 1, depth - 1);
+                        break;
+                }
+                line(indent);
+                out_ += "end\n";
+            }
+            scope_.resize(outer);
+        }
+
+        void expression() {
+            switch (pick(4)) {
+                case 0:
+                    literal();
+                    break;
+                case 1:
+                    if (!scope_.empty()) {
+                        out_ += scope_[pick(scope_.size())];
+                    } else {
+                        out_ += "f" + std::to_string(pick(fields_per_class));
+                    }
+                    break;
+                case 2:
+                    call();
+                    break;
+                default:
+                    chain();
+                    break;
+            }
+        }
+
+        void chain() {
+            out_ += "this";
+            for (size_t i = 0; i < shape_.chain_length; i++) {
+                out_ += ".";
+                if (i + 1 == shape_.chain_length && pick(2) == 0) {
+                    out_ += "f" + std::to_string(pick(fields_per_class));
+                } else {
+                    call();
+                }
+            }
+        }
+
+        void call() {
+            size_t method = pick(shape_.methods_per_class);
+            out_ += "m" + std::to_string(method) + "(";
+            arguments(method);
+            out_ += ")";
+        }
+
+        void arguments(size_t method) {
+            for (size_t i = 0; i < method % 4; i++) {
+                if (i) {
+                    out_ += ", ";
+                }
+                literal((method + i) % 4);
+            }
+        }
+
+        void literal() {
+            const unsigned weights[] = {
+                    shape_.integer_literals, shape_.real_literals, shape_.string_literals, shape_.boolean_literals
+            };
+            unsigned total = weights[0] + weights[1] + weights[2] + weights[3];
+            size_t roll = pick(total);
+            size_t type = 0;
+            while (type < 3 && roll >= weights[type]) {
+                roll -= weights[type++];
+            }
+            literal(type);
+        }
+
+        void literal(size_t type) {
+            switch (type) {
+                case 0:
+                    out_ += std::to_string(pick(100000));
+                    break;
+                case 1:
+                    out_ += std::to_string(pick(1000)) + "." + std::to_string(pick(1000));
+                    break;
+                case 2:
+                    out_ += "'text " + std::to_string(pick(100000)) + "'";
+                    break;
+                default:
+                    out_ += pick(2) ? "true" : "false";
+                    break;
+            }
+        }
+
+        const yy::ProgramShape &shape_;
+        std::mt19937 random_;
+        std::string out_;
+        std::vector<std::string> scope_;
+        size_t locals_ = 0;
+    };
+}
+
+namespace yy {
+
+    std::string generate_program(const ProgramShape &shape) {
+        return Generator(shape).program();
+    }
+}
@@ -25,18 +25,6 @@ std::string yy::token_to_string(yy::parser::symbol_kind::symbol_kind_type token)
             return "S_REAL_LITERAL";
         case yy::parser::symbol_kind::S_STRING_LITERAL:
             return "S_STRING_LITERAL";
-        case yy::parser::symbol_kind::S_CLASS:
-            return "S_CLASS";
-        case yy::parser::symbol_kind::S_EXTENDS:
-            return "S_EXTENDS";
-        case yy::parser::symbol_kind::S_IS:
-            return "S_IS";
-        case yy::parser::symbol_kind::S_END:
-            return "S_END";
-        case yy::parser::symbol_kind::S_THIS:
-            return "S_THIS";
-        case yy::parser::symbol_kind::S_METHOD:
-            return "S_METHOD";
         case yy::parser::symbol_kind::S_LEFT_PAREN:
             return "S_LEFT_PAREN";
         case yy::parser::symbol_kind::S_RIGHT_PAREN:
@@ -47,24 +35,16 @@ std::string yy::token_to_string(yy::parser::symbol_kind::symbol_kind_type token)
             return "S_COMMA";
         case yy::parser::symbol_kind::S_METHOD_DEFINITION:
             return "S_METHOD_DEFINITION";
-        case yy::parser::symbol_kind::S_RETURN:
-            return "S_RETURN";
-        case yy::parser::symbol_kind::S_VAR:
-            return "S_VAR";
         case yy::parser::symbol_kind::S_ASSIGNMENT_OPERATOR:
             return "S_ASSIGNMENT_OPERATOR";
         case yy::parser::symbol_kind::S_MEMBER_ACCESS_OPERATOR:
             return "S_MEMBER_ACCESS_OPERATOR";
-        case yy::parser::symbol_kind::S_IF:
-            return "S_IF";
-        case yy::parser::symbol_kind::S_THEN:
-            return "S_THEN";
-        case yy::parser::symbol_kind::S_ELSE:
-            return "S_ELSE";
-        case yy::parser::symbol_kind::S_WHILE:
-            return "S_WHILE";
-        case yy::parser::symbol_kind::S_LOOP:
-            return "S_LOOP";
+#define KEYWORD(SPELLING, TOKEN)            \
+        case yy::parser::symbol_kind::S_##TOKEN: \
+            return "S_" #TOKEN;
+
+#include "lexer/keywords.def"
+
         case yy::parser::symbol_kind::S_YYACCEPT:
             return "S_YYACCEPT";
         case yy::parser::symbol_kind::S_program:
@@ -127,4 +107,20 @@ std::string yy::token_to_string(yy::parser::symbol_kind::symbol_kind_type token)
         default:
             return "UNKNOWN_SYMBOL_KIND_TYPE";
     }
-}
\ No newline at end of file
+}
+const std::array<int, yy::parser::symbol_kind::YYNTOKENS> &yy::token_numbers() {
+    using kind = yy::parser::symbol_kind;
+    static const std::array<int, kind::YYNTOKENS> table = [] {
+        std::array<int, kind::YYNTOKENS> numbers{};
+        numbers[kind::S_YYUNDEF] = yy::parser::token::YYUNDEF;
+        const int last = yy::parser::token::YYUNDEF + static_cast<int>(kind::YYNTOKENS);
+        for (int token = yy::parser::token::YYEOF; token <= last; token++) {
+            kind::symbol_kind_type symbol = yy::parser::by_kind(yy::parser::token_kind_type(token)).kind();
+            if (symbol != kind::S_YYUNDEF) {
+                numbers[symbol] = token;
+            }
+        }
+        return numbers;
+    }();
+    return table;
+}
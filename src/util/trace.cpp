@@ -0,0 +1,112 @@
+#include "util/trace.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace {
+    std::optional<yy::TraceLevel> parse_level(std::string_view name) {
+        if (name == "off") {
+            return yy::TraceLevel::Off;
+        }
+        if (name == "info") {
+            return yy::TraceLevel::Info;
+        }
+        if (name == "debug") {
+            return yy::TraceLevel::Debug;
+        }
+        return std::nullopt;
+    }
+}
+
+namespace yy {
+
+    Trace::Trace() = default;
+
+    Trace::~Trace() {
+        flush();
+    }
+
+    void Trace::enable(TraceChannel channel, TraceLevel level) noexcept {
+        levels_[static_cast<size_t>(channel)] = level;
+    }
+
+    bool Trace::configure(std::string_view spec) {
+        auto levels = levels_;
+
+        while (!spec.empty()) {
+            size_t comma = spec.find(',');
+            std::string_view item = spec.substr(0, comma);
+            spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+
+            TraceLevel level = TraceLevel::Info;
+            size_t colon = item.find(':');
+            if (colon != std::string_view::npos) {
+                auto parsed = parse_level(item.substr(colon + 1));
+                if (!parsed) {
+                    return false;
+                }
+                level = *parsed;
+                item = item.substr(0, colon);
+            }
+
+            bool known = false;
+            for (size_t channel = 0; channel < trace_channel_count; channel++) {
+                if (item == "all" || item == trace_channel_name(static_cast<TraceChannel>(channel))) {
+                    levels[channel] = level;
+                    known = true;
+                }
+            }
+            if (!known) {
+                return false;
+            }
+        }
+
+        levels_ = levels;
+        return true;
+    }
+
+    void Trace::to_file(const std::string &path) {
+        std::error_code error;
+        auto sink = std::make_unique<llvm::raw_fd_ostream>(path, error);
+        if (error) {
+            throw std::runtime_error("Cant open trace file: " + path);
+        }
+        flush();
+        sink_ = std::move(sink);
+    }
+
+    void Trace::to_fd(int fd) {
+        flush();
+        sink_ = std::make_unique<llvm::raw_fd_ostream>(fd, /*shouldClose=*/false);
+    }
+
+    void Trace::to_string(std::string &buffer) {
+        flush();
+        sink_ = std::make_unique<llvm::raw_string_ostream>(buffer);
+    }
+
+    llvm::raw_ostream &Trace::stream() {
+        return sink_ ? *sink_ : llvm::outs();
+    }
+
+    void Trace::flush() {
+        stream().flush();
+    }
+
+    std::string_view trace_channel_name(TraceChannel channel) {
+        switch (channel) {
+            case TraceChannel::Tokens:
+                return "tokens";
+            case TraceChannel::Ast:
+                return "ast";
+            case TraceChannel::Symbols:
+                return "symbols";
+            case TraceChannel::Semantic:
+                return "semantic";
+        }
+        return "unknown";
+    }
+}
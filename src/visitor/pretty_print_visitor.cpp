@@ -48,7 +48,7 @@ void yy::PrettyPrintVisitor::operator()(const FieldAccessExpr &field_access_expr
     print_ident();
     output_ += std::format(
             "FIELD_ACCESS_EXPR[name: {}]",
-            field_access_expr.name()
+            field_access_expr.name().str()
     );
 }
 
@@ -56,7 +56,7 @@ void yy::PrettyPrintVisitor::operator()(const MethodCallExpr &method_call_expr)
     print_ident();
     output_ += std::format(
             "METHOD_CALL_EXPR[name: {}]",
-            method_call_expr.name()
+            method_call_expr.name().str()
     );
     depth_++;
     std::for_each(
@@ -112,7 +112,7 @@ void yy::PrettyPrintVisitor::operator()(const AssignmentStmt &assignment_stmt) {
     print_ident();
     output_ += std::format(
             "ASSIGNMENT_STMT[name: {}]",
-            assignment_stmt.name()
+            assignment_stmt.name().str()
     );
     depth_++;
     assignment_stmt.expression()->accept(*this);
@@ -164,8 +164,8 @@ void yy::PrettyPrintVisitor::operator()(const ParameterDeclaration &parameter_de
     print_ident();
     output_ += std::format(
             "PARAMETER_DECLARATION[name: {}, type: {}]",
-            parameter_declaration.name(),
-            parameter_declaration.type()
+            parameter_declaration.name().str(),
+            parameter_declaration.type().str()
     );
 }
 
@@ -173,7 +173,7 @@ void yy::PrettyPrintVisitor::operator()(const VariableDeclaration &variable_decl
     print_ident();
     output_ += std::format(
             "VARIABLE_DECLARATION[name: {}]",
-            variable_declaration.name()
+            variable_declaration.name().str()
     );
     depth_++;
     variable_declaration.initializer()->accept(*this);
@@ -212,8 +212,8 @@ void yy::PrettyPrintVisitor::operator()(const MethodDeclaration &method_declarat
     print_ident();
     output_ += std::format(
             "METHOD_DECLARATION[name: {}, returnType: {}]",
-            method_declaration.name(),
-            method_declaration.return_type()
+            method_declaration.name().str(),
+            method_declaration.return_type().str()
     );
     depth_++;
     std::for_each(
@@ -256,8 +256,8 @@ void yy::PrettyPrintVisitor::operator()(const ClassDeclaration &class_declaratio
     print_ident();
     output_ += std::format(
             "CLASS_DECLARATION[name: {} parent: {}]",
-            class_declaration.name(),
-            class_declaration.parent()
+            class_declaration.name().str(),
+            class_declaration.parent().str()
     );
 }
 
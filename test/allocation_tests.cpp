@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/scanner.hpp"
+
+// Its own executable: the operator new it counts with is replaced for the
+// whole program, which lexer_test should not pay for.
+
+namespace {
+    std::atomic<size_t> allocations{0};
+
+    // Program text that exercises every token kind the scanner produces.
+    const std::string corpus_unit = R"(
+class Point extends Shape is
+    var x : Integer(12345)
+    var label : String('a rather long string literal that never fits into SSO')
+    this(px: Integer, py: Real) is
+        x := px
+        while true loop
+            x := x.plus(1)
+        end
+    end
+    method distance(other: Point) : Real is
+        if false then
+            return 3.14159
+        else
+            return this.dist_squared_to_the_other_point(other).sqrt()
+        end
+    end
+    method area() : Real => 0.5
+end
+)";
+
+    std::string make_corpus(size_t min_size) {
+        std::string corpus;
+        corpus.reserve(min_size + corpus_unit.size());
+        while (corpus.size() < min_size) {
+            corpus += corpus_unit;
+        }
+        return corpus;
+    }
+}
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+TEST(ScannerTests, NoAllocationsPerToken) {
+    const std::string corpus = make_corpus(16 << 20);
+    const std::string filename = "corpus.opp";
+    yy::Scanner scanner{yy::BufferedReader(std::string_view(corpus)), filename};
+
+    size_t tokens = 0;
+    size_t before = allocations.load();
+    for (;;) {
+        auto token = scanner.get_token();
+        if (token.kind() == yy::parser::symbol_kind::S_YYEOF) {
+            break;
+        }
+        ASSERT_NE(token.kind(), yy::parser::symbol_kind::S_YYUNDEF);
+        tokens++;
+    }
+    size_t after = allocations.load();
+
+    EXPECT_GT(tokens, 1000000u);
+    EXPECT_EQ(after - before, 0u);
+}
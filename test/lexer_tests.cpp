@@ -0,0 +1,525 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "lexer/buffered_reader.hpp"
+#include "lexer/incremental_lexer.hpp"
+#include "lexer/parallel_lexer.hpp"
+#include "lexer/scanner.hpp"
+#include "lexer/token_cache.hpp"
+#include "util/trace.hpp"
+
+namespace yy {
+    parser::symbol_type yylex(Scanner &scanner);
+}
+
+namespace {
+    // Program text that exercises every token kind the scanner produces.
+    const std::string corpus_unit = R"(
+class Point extends Shape is
+    var x : Integer(12345)
+    var label : String('a rather long string literal that never fits into SSO')
+    this(px: Integer, py: Real) is
+        x := px
+        while true loop
+            x := x.plus(1)
+        end
+    end
+    method distance(other: Point) : Real is
+        if false then
+            return 3.14159
+        else
+            return this.dist_squared_to_the_other_point(other).sqrt()
+        end
+    end
+    method area() : Real => 0.5
+end
+)";
+
+    std::string describe(const yy::SourceRange &location) {
+        std::ostringstream out;
+        out << location;
+        return out.str();
+    }
+
+    // Kind, location and value of a token.
+    std::string describe(const yy::parser::symbol_type &token) {
+        std::ostringstream out;
+        out << static_cast<int>(token.kind()) << " " << token.location;
+        switch (token.kind()) {
+            case yy::parser::symbol_kind::S_IDENTIFIER:
+            case yy::parser::symbol_kind::S_STRING_LITERAL:
+                out << " " << token.value.as<std::string_view>();
+                break;
+            case yy::parser::symbol_kind::S_INTEGER_LITERAL:
+                out << " " << token.value.as<int>();
+                break;
+            case yy::parser::symbol_kind::S_REAL_LITERAL:
+                out << " " << token.value.as<double>();
+                break;
+            case yy::parser::symbol_kind::S_BOOLEAN_LITERAL:
+                out << " " << token.value.as<bool>();
+                break;
+            default:
+                break;
+        }
+        return out.str();
+    }
+
+    // The next token described, or the lexical error in its place.
+    std::string describe_next(yy::Scanner &scanner, bool &eof) {
+        try {
+            auto token = scanner.get_token();
+            eof = token.kind() == yy::parser::symbol_kind::S_YYEOF;
+            return describe(token);
+        } catch (const yy::parser::syntax_error &error) {
+            eof = false;
+            std::ostringstream out;
+            out << "error " << error.location << " " << error.what();
+            return out.str();
+        }
+    }
+
+    std::string make_corpus(size_t min_size) {
+        std::string corpus;
+        corpus.reserve(min_size + corpus_unit.size());
+        while (corpus.size() < min_size) {
+            corpus += corpus_unit;
+        }
+        return corpus;
+    }
+}
+
+TEST(ScannerTests, IntegerOverflowIsDiagnosed) {
+    const std::string filename = "overflow.opp";
+    yy::Scanner scanner{yy::BufferedReader(std::string("var x : 2147483648")), filename};
+
+    EXPECT_EQ(scanner.get_token().kind(), yy::parser::symbol_kind::S_VAR);
+    EXPECT_EQ(scanner.get_token().kind(), yy::parser::symbol_kind::S_IDENTIFIER);
+    EXPECT_EQ(scanner.get_token().kind(), yy::parser::symbol_kind::S_COLON);
+    EXPECT_THROW(scanner.get_token(), yy::parser::syntax_error);
+}
+
+TEST(ScannerTests, LiteralsAreDecodedInPlace) {
+    const std::string filename = "literals.opp";
+    yy::Scanner scanner{yy::BufferedReader(std::string("2147483647 2.5 'text' name")), filename};
+
+    EXPECT_EQ(scanner.get_token().value.as<int>(), 2147483647);
+    EXPECT_EQ(scanner.get_token().value.as<double>(), 2.5);
+    EXPECT_EQ(scanner.get_token().value.as<std::string_view>(), "text");
+    EXPECT_EQ(scanner.get_token().value.as<std::string_view>(), "name");
+}
+
+TEST(ScannerTests, ScanKernelsAgreeWithScalar) {
+    const std::string alphabet = "ab_Z09 \t\r\n.()[]:,=>'";
+    std::string text;
+    uint32_t state = 12345;
+    for (size_t i = 0; i < 4096; i++) {
+        state = state * 1103515245 + 12345;
+        // Long runs of one byte class, so the wide kernels see whole blocks.
+        size_t run = (state >> 8) % 48;
+        char ch = alphabet[(state >> 16) % alphabet.size()];
+        text.append(run, ch);
+    }
+
+    const auto &scalar = yy::scalar_scan_kernels();
+    const char *end = text.data() + text.size();
+    for (const yy::ScanKernels *kernels: yy::available_scan_kernels()) {
+        SCOPED_TRACE(kernels->name);
+        for (const char *begin = text.data(); begin < end; begin += 7) {
+            ASSERT_EQ(kernels->skip_whitespace(begin, end), scalar.skip_whitespace(begin, end));
+            ASSERT_EQ(kernels->find_spliterator(begin, end), scalar.find_spliterator(begin, end));
+            ASSERT_EQ(kernels->find_quote(begin, end), scalar.find_quote(begin, end));
+
+            std::vector<uint32_t> expected_lines, actual_lines;
+            kernels->find_line_starts(begin, end, 5, actual_lines);
+            scalar.find_line_starts(begin, end, 5, expected_lines);
+            ASSERT_EQ(actual_lines, expected_lines);
+        }
+    }
+}
+
+TEST(ScannerTests, OperatorsAndNumbersFollowTheAutomaton) {
+    using kind = yy::parser::symbol_kind;
+    const std::string filename = "operators.opp";
+    yy::Scanner scanner{yy::BufferedReader(std::string(":=a:b=>(1.5,1.2.3). 42=\n>")), filename};
+
+    const kind::symbol_kind_type expected[] = {
+            kind::S_ASSIGNMENT_OPERATOR, kind::S_IDENTIFIER, kind::S_COLON, kind::S_IDENTIFIER,
+            kind::S_METHOD_DEFINITION, kind::S_LEFT_PAREN, kind::S_REAL_LITERAL, kind::S_COMMA,
+            kind::S_YYUNDEF, kind::S_RIGHT_PAREN, kind::S_MEMBER_ACCESS_OPERATOR, kind::S_INTEGER_LITERAL,
+    };
+    for (auto k: expected) {
+        EXPECT_EQ(scanner.get_token().kind(), k);
+    }
+
+    // A stray '=' swallows the byte after it, here the newline.
+    auto stray = scanner.get_token();
+    EXPECT_EQ(stray.kind(), kind::S_YYUNDEF);
+    yy::position end = yy::SourceManager::resolve(stray.location.end);
+    EXPECT_EQ(end.line, 1);
+    EXPECT_EQ(end.column, 0);
+
+    EXPECT_EQ(scanner.get_token().kind(), kind::S_YYUNDEF);
+    EXPECT_EQ(scanner.get_token().kind(), kind::S_YYEOF);
+}
+
+TEST(SourceLocationTests, OffsetsResolveToLinesAndColumns) {
+    std::string text = "ab\ncd\n\nef";
+    auto registration = yy::SourceManager::add("lines.opp", text);
+    const uint32_t file = registration.id();
+
+    auto at = [&](uint32_t offset) {
+        yy::position position = yy::SourceManager::resolve(yy::SourceLoc{file, offset});
+        return std::to_string(position.line) + "." + std::to_string(position.column);
+    };
+    EXPECT_EQ(at(0), "0.0");
+    EXPECT_EQ(at(2), "0.2");
+    EXPECT_EQ(at(3), "1.0");
+    EXPECT_EQ(at(7), "3.0");
+    EXPECT_EQ(at(9), "3.2");
+    EXPECT_EQ(describe(yy::SourceRange{{file, 1}, {file, 8}}), "lines.opp:0.1-3.0");
+    EXPECT_EQ(describe(yy::SourceRange()), "1.1");
+
+    // An edited buffer is indexed again.
+    text = "\n\n\nab";
+    yy::SourceManager::replace_text(file, text);
+    EXPECT_EQ(at(4), "3.1");
+}
+
+TEST(SourceLocationTests, FilesAreDroppedWithTheirRegistration) {
+    const std::string text = "ab\ncd";
+    uint32_t file = 0;
+    {
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(text)), "dropped.opp"};
+        file = scanner.file();
+        EXPECT_EQ(describe(yy::SourceRange{{file, 3}, {file, 4}}), "dropped.opp:1.0");
+    }
+    EXPECT_EQ(yy::SourceManager::resolve(yy::SourceLoc{file, 3}).filename, nullptr);
+
+    // The id is handed out again rather than the registry growing.
+    for (int i = 0; i < 100; i++) {
+        auto registration = yy::SourceManager::add("again.opp", text);
+        EXPECT_EQ(registration.id(), file);
+    }
+}
+
+TEST(TraceTests, TokenChannelIsOffByDefault) {
+    const std::string filename = "trace.opp";
+    std::string output;
+    yy::Trace trace;
+    trace.to_string(output);
+
+    yy::Scanner scanner{yy::BufferedReader(std::string("class A is end")), filename};
+    scanner.set_trace(&trace);
+    while (yy::yylex(scanner).kind() != yy::parser::symbol_kind::S_YYEOF) {
+    }
+    trace.flush();
+
+    EXPECT_EQ(output, "");
+}
+
+TEST(TraceTests, TokenChannelWritesEveryToken) {
+    const std::string filename = "trace.opp";
+    std::string output;
+    yy::Trace trace;
+    trace.to_string(output);
+    ASSERT_TRUE(trace.configure("tokens"));
+
+    yy::Scanner scanner{yy::BufferedReader(std::string("class A is end")), filename};
+    scanner.set_trace(&trace);
+    while (yy::yylex(scanner).kind() != yy::parser::symbol_kind::S_YYEOF) {
+    }
+    trace.flush();
+
+    EXPECT_EQ(output, "S_CLASS\nS_IDENTIFIER\nS_IS\nS_END\nS_YYEOF\n");
+}
+
+TEST(TraceTests, ConfigureParsesChannelSpecs) {
+    yy::Trace trace;
+    ASSERT_TRUE(trace.configure("ast,semantic:debug"));
+    EXPECT_TRUE(trace.enabled(yy::TraceChannel::Ast));
+    EXPECT_FALSE(trace.enabled(yy::TraceChannel::Ast, yy::TraceLevel::Debug));
+    EXPECT_TRUE(trace.enabled(yy::TraceChannel::Semantic, yy::TraceLevel::Debug));
+    EXPECT_FALSE(trace.enabled(yy::TraceChannel::Tokens));
+
+    EXPECT_FALSE(trace.configure("all,parser"));
+    EXPECT_FALSE(trace.configure("symbols:loud"));
+    EXPECT_FALSE(trace.enabled(yy::TraceChannel::Symbols));
+
+    ASSERT_TRUE(trace.configure("all:off"));
+    EXPECT_FALSE(trace.enabled(yy::TraceChannel::Semantic));
+}
+
+TEST(TokenCacheTests, ReplayMatchesLiveScanner) {
+    const std::string filename = "cached.opp";
+    const std::string source = make_corpus(1 << 20) + "'unterminated";
+    const std::string path = (std::filesystem::temp_directory_path() / "opp_replay_test.optok").string();
+
+    yy::TokenCacheWriter recorder;
+    yy::Scanner live{yy::BufferedReader(std::string_view(source)), filename};
+    live.record_to(&recorder);
+    std::deque<yy::parser::symbol_type> expected;
+    for (;;) {
+        auto token = live.get_token();
+        bool eof = token.kind() == yy::parser::symbol_kind::S_YYEOF;
+        expected.push_back(std::move(token));
+        if (eof) {
+            break;
+        }
+    }
+    ASSERT_TRUE(recorder.complete());
+    ASSERT_TRUE(recorder.write(path, source));
+
+    auto cache = yy::TokenCacheReader::open(path, source);
+    ASSERT_NE(cache, nullptr);
+    yy::Scanner replay{yy::BufferedReader(std::string_view(source)), filename};
+    replay.replay_from(cache.get());
+    for (const auto &want: expected) {
+        auto got = replay.get_token();
+        ASSERT_EQ(got.kind(), want.kind());
+        ASSERT_EQ(describe(got.location), describe(want.location));
+        switch (want.kind()) {
+            case yy::parser::symbol_kind::S_IDENTIFIER:
+            case yy::parser::symbol_kind::S_STRING_LITERAL:
+                ASSERT_EQ(got.value.as<std::string_view>(), want.value.as<std::string_view>());
+                break;
+            case yy::parser::symbol_kind::S_INTEGER_LITERAL:
+                ASSERT_EQ(got.value.as<int>(), want.value.as<int>());
+                break;
+            case yy::parser::symbol_kind::S_REAL_LITERAL:
+                ASSERT_EQ(got.value.as<double>(), want.value.as<double>());
+                break;
+            case yy::parser::symbol_kind::S_BOOLEAN_LITERAL:
+                ASSERT_EQ(got.value.as<bool>(), want.value.as<bool>());
+                break;
+            default:
+                break;
+        }
+    }
+
+    EXPECT_EQ(yy::TokenCacheReader::open(path, source + " "), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(TokenCacheTests, LexicalErrorsAreNotCached) {
+    const std::string filename = "overflow.opp";
+    const std::string source = "var x : Integer(99999999999)";
+
+    yy::TokenCacheWriter recorder;
+    yy::Scanner scanner{yy::BufferedReader(std::string_view(source)), filename};
+    scanner.record_to(&recorder);
+    EXPECT_THROW({
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+    }, yy::parser::syntax_error);
+    while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+    }
+
+    EXPECT_FALSE(recorder.complete());
+    EXPECT_FALSE(recorder.write("unused.optok", source));
+}
+
+TEST(ParallelLexerTests, SplitsInFrontOfClassKeywords) {
+    const std::string source = "class A is end\nclass B is end\nclasses\n  class C\nclass";
+
+    EXPECT_EQ(yy::find_split_points(source, 1), (std::vector<size_t>{15, 48}));
+    EXPECT_EQ(yy::find_split_points(source, 20), (std::vector<size_t>{48}));
+    EXPECT_TRUE(yy::find_split_points(source, source.size()).empty());
+}
+
+TEST(ParallelLexerTests, StreamMatchesSerialScanner) {
+    const std::string filename = "parallel.opp";
+    // Strings spanning cuts, one of them over several chunks, lexical errors
+    // on both sides of a cut and a string left open at the end of the file.
+    const std::string source = make_corpus(64 << 10)
+                               + "var s : String('spans\nclass Fake is end\n')\n"
+                               + "class Overflow is var x : Integer(99999999999) end\n"
+                               + "var t : String('" + make_corpus(4 << 10) + "')\n"
+                               + make_corpus(16 << 10)
+                               + "class Tail is var y := 1.2.3 end\n'unterminated\nclass Z is end";
+
+    yy::Scanner serial{yy::BufferedReader(std::string_view(source)), filename};
+    std::vector<std::string> expected;
+    for (bool eof = false; !eof;) {
+        expected.push_back(describe_next(serial, eof));
+    }
+
+    for (unsigned threads: {1u, 2u, 4u}) {
+        for (size_t chunk_size: {size_t(1), size_t(700), size_t(8 << 10), yy::ParallelLexer::default_chunk_size}) {
+            yy::ParallelLexer lexer(source, threads, chunk_size);
+            yy::Scanner scanner{yy::BufferedReader(std::string_view(source)), filename};
+            scanner.replay_from(&lexer);
+
+            std::vector<std::string> tokens;
+            for (bool eof = false; !eof;) {
+                tokens.push_back(describe_next(scanner, eof));
+            }
+            ASSERT_EQ(tokens, expected) << threads << " threads, chunks of " << chunk_size;
+        }
+    }
+}
+
+namespace {
+    std::vector<std::string> describe(const yy::IncrementalLexer &lexer) {
+        std::vector<std::string> tokens;
+        for (const auto &token: lexer.tokens()) {
+            std::ostringstream out;
+            out << static_cast<int>(token.kind) << " " << token.location << " "
+                << token.offset << "+" << token.length << " " << lexer.lexeme(token);
+            if (token.kind == yy::parser::symbol_kind::S_INTEGER_LITERAL) {
+                out << " = " << token.integer;
+            } else if (token.kind == yy::parser::symbol_kind::S_REAL_LITERAL) {
+                out << " = " << token.real;
+            } else if (token.kind == yy::parser::symbol_kind::S_BOOLEAN_LITERAL) {
+                out << " = " << token.boolean;
+            }
+            tokens.push_back(out.str());
+        }
+        return tokens;
+    }
+}
+
+TEST(IncrementalLexerTests, EditsMatchLexingFromScratch) {
+    const std::string filename = "edited.opp";
+    yy::IncrementalLexer lexer(make_corpus(2 << 10), filename);
+
+    // Fragments that join and split tokens, open and close strings and break literals.
+    const std::vector<std::string> fragments = {"", "x", " ", "\n", "'", ".", ":", "=", "1", "9999999999", "class A is\n"};
+    std::mt19937 random(42);
+    for (int i = 0; i < 1000; i++) {
+        const std::string &inserted = fragments[random() % fragments.size()];
+        const size_t offset = random() % (lexer.text().size() + 1);
+        yy::TextEdit edit{offset, std::min<size_t>(random() % 4, lexer.text().size() - offset), inserted};
+        std::string expected_text = lexer.text();
+        expected_text.replace(edit.offset, edit.removed, inserted);
+
+        yy::TokenRange range = lexer.apply(edit);
+        ASSERT_EQ(lexer.text(), expected_text);
+        yy::IncrementalLexer fresh(expected_text, filename);
+        ASSERT_EQ(describe(lexer), describe(fresh)) << "edit " << i << " at " << edit.offset;
+        ASSERT_LE(range.first + range.inserted, lexer.tokens().size());
+    }
+}
+
+TEST(IncrementalLexerTests, OnlyTheDamagedTokensAreLexedAgain) {
+    yy::IncrementalLexer lexer("var x : Integer(1)\nvar y : Integer(2)\n", "small.opp");
+    const size_t count = lexer.tokens().size();
+
+    yy::TokenRange range = lexer.apply({4, 1, "longer"});
+    EXPECT_EQ(range.first, 1u);
+    EXPECT_EQ(range.removed, 1u);
+    EXPECT_EQ(range.inserted, 1u);
+    EXPECT_EQ(lexer.tokens().size(), count);
+    EXPECT_EQ(lexer.symbol(1).value.as<std::string_view>(), "longer");
+    EXPECT_EQ(describe(lexer.symbol(2).location), "small.opp:0.11");
+    EXPECT_EQ(describe(lexer.symbol(8).location), "small.opp:1.4");
+}
+
+TEST(IncrementalLexerTests, EditsPastTheEndAreRejected) {
+    const std::string text = "var x : Integer(1)";
+    yy::IncrementalLexer lexer(text, "short.opp");
+    const size_t count = lexer.tokens().size();
+
+    EXPECT_THROW(lexer.apply({text.size() + 1, 0, "x"}), std::runtime_error);
+    EXPECT_THROW(lexer.apply({text.size() - 1, 2, ""}), std::runtime_error);
+    EXPECT_THROW(lexer.apply({1, SIZE_MAX, ""}), std::runtime_error);
+    EXPECT_EQ(lexer.text(), text);
+    EXPECT_EQ(lexer.tokens().size(), count);
+
+    lexer.apply({text.size(), 0, " "});
+    EXPECT_EQ(lexer.text(), text + " ");
+}
+
+TEST(IncrementalLexerTests, RejectedLiteralsThrowWhenHandedOut) {
+    yy::IncrementalLexer lexer("var x : Integer(1)", "overflow.opp");
+    lexer.apply({16, 1, "99999999999"});
+
+    EXPECT_EQ(lexer.tokens()[5].kind, yy::parser::symbol_kind::S_YYerror);
+    EXPECT_THROW(lexer.symbol(5), yy::parser::syntax_error);
+    EXPECT_EQ(lexer.symbol(6).kind(), yy::parser::symbol_kind::S_RIGHT_PAREN);
+}
+
+namespace {
+    // The read end of a pipe fed with `text` in small pieces by a writer thread.
+    int pipe_from(const std::string &text, std::thread &writer) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return -1;
+        }
+        writer = std::thread([&text, fd = fds[1]] {
+            for (size_t offset = 0; offset < text.size(); offset += 1000) {
+                size_t size = std::min<size_t>(1000, text.size() - offset);
+                if (write(fd, text.data() + offset, size) != static_cast<ssize_t>(size)) {
+                    break;
+                }
+            }
+            close(fd);
+        });
+        return fds[0];
+    }
+}
+
+TEST(StreamingReaderTests, WindowedStreamMatchesInMemoryScanner) {
+    const std::string filename = "streamed.opp";
+    const std::string source = make_corpus(256 << 10) + "var x : Integer(99999999999)\n'unterminated";
+
+    yy::Scanner memory{yy::BufferedReader(std::string_view(source)), filename};
+    std::vector<std::string> expected;
+    for (bool eof = false; !eof;) {
+        expected.push_back(describe_next(memory, eof));
+    }
+
+    std::thread writer;
+    int fd = pipe_from(source, writer);
+    ASSERT_GE(fd, 0);
+    yy::Scanner streamed{yy::BufferedReader::stream(fd, 256), filename};
+    // Keep every token until the end, values have to outlive the window.
+    std::deque<yy::parser::symbol_type> tokens;
+    std::vector<std::string> errors;
+    for (;;) {
+        try {
+            tokens.push_back(streamed.get_token());
+            if (tokens.back().kind() == yy::parser::symbol_kind::S_YYEOF) {
+                break;
+            }
+        } catch (const yy::parser::syntax_error &error) {
+            std::ostringstream out;
+            out << "error " << error.location << " " << error.what();
+            errors.push_back(out.str());
+        }
+    }
+    writer.join();
+    close(fd);
+
+    std::vector<std::string> got;
+    for (const auto &token: tokens) {
+        got.push_back(describe(token));
+    }
+    // The only error is the overflow in front of ")", the unterminated string and the end.
+    got.insert(got.end() - 3, errors.begin(), errors.end());
+    EXPECT_EQ(got, expected);
+}
+
+TEST(StreamingReaderTests, TokensLongerThanHalfTheWindowAreRejected) {
+    const std::string source = "var x : String('" + std::string(100, 'a') + "')\nvar y : Integer(1)";
+
+    std::thread writer;
+    int fd = pipe_from(source, writer);
+    ASSERT_GE(fd, 0);
+    yy::Scanner scanner{yy::BufferedReader::stream(fd, 64), "long.opp"};
+    EXPECT_THROW({
+        while (scanner.get_token().kind() != yy::parser::symbol_kind::S_YYEOF) {
+        }
+    }, yy::parser::syntax_error);
+    writer.join();
+    close(fd);
+}
@@ -5,8 +5,27 @@
 #include <gtest/gtest.h>
 #include <string>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
 #include "driver.hpp"
+#include "ast/ast_arena.hpp"
+#include "ast/flat_ast.hpp"
+#include "lexer/buffered_reader.hpp"
+#include "lexer/scanner.hpp"
+#include "parser/parser.tab.hpp"
+#include "parser/incremental_parser.hpp"
+#include "parser/parallel_parser.hpp"
+#include "parser/recursive_descent_parser.hpp"
+#include "semantic/pass_manager.hpp"
+#include "stdlib/builtins.hpp"
+#include "visitor/iterative_visitor.hpp"
+#include "visitor/pretty_print_visitor.hpp"
+#include "visitor/recursive_visitor.hpp"
+#include "util/name.hpp"
+#include "util/program_generator.hpp"
 
 class OppFrontendTests : public testing::TestWithParam<std::string> {
 };
@@ -20,7 +39,7 @@ namespace {
         std::vector<std::string> res;
 
         for (const auto &file: std::filesystem::directory_iterator(path)) {
-            res.emplace_back(path_string + file.path().string());
+            res.emplace_back(file.path().string());
         }
         return res;
     }
@@ -36,3 +55,833 @@ TEST_P(OppFrontendTests, GoodTests) {
 
 INSTANTIATE_TEST_SUITE_P(Container, OppFrontendTests, testing::ValuesIn(GetTests()));
 
+namespace {
+    int ParseText(const std::string &text, yy::ParserBackend backend, std::unique_ptr<Program> &program) {
+        static const std::string filename = "parser_test.opp";
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(text)), filename};
+        if (backend == yy::ParserBackend::RecursiveDescent) {
+            return yy::RecursiveDescentParser(scanner, program)();
+        }
+        return yy::parser(scanner, program, nullptr)();
+    }
+
+    std::unique_ptr<Program> ParseText(const std::string &text, yy::ParserBackend backend) {
+        std::unique_ptr<Program> program;
+        EXPECT_EQ(ParseText(text, backend, program), 0);
+        return program;
+    }
+
+    std::string PrettyPrint(const Program &program) {
+        yy::PrettyPrintVisitor printer;
+        program.accept(printer);
+        return printer.output();
+    }
+
+    // The location of every node; PrettyPrint leaves them out. By offset only:
+    // parsers of the same text may have registered it as different files.
+    class LocationDump : public yy::RecursiveVisitor<void> {
+    public:
+        std::string output() const {
+            return out_.str();
+        }
+
+        void operator()(const BooleanLiteralExpr &node) override { dump(node); }
+
+        void operator()(const IntegerLiteralExpr &node) override { dump(node); }
+
+        void operator()(const RealLiteralExpr &node) override { dump(node); }
+
+        void operator()(const StringLiteralExpr &node) override { dump(node); }
+
+        void operator()(const ThisExpr &node) override { dump(node); }
+
+        void operator()(const FieldAccessExpr &node) override { dump(node); }
+
+        void operator()(const MethodCallExpr &node) override { dump(node); }
+
+        void operator()(const MemberAccess &node) override { dump(node); }
+
+        void operator()(const Body &node) override { dump(node); }
+
+        void operator()(const ReturnStmt &node) override { dump(node); }
+
+        void operator()(const AssignmentStmt &node) override { dump(node); }
+
+        void operator()(const IfStmt &node) override { dump(node); }
+
+        void operator()(const WhileStmt &node) override { dump(node); }
+
+        void operator()(const MemberDeclaration &node) override { dump(node); }
+
+        void operator()(const ParameterDeclaration &node) override { dump(node); }
+
+        void operator()(const VariableDeclaration &node) override {
+            print(static_cast<const BodyExpr &>(node).location());
+            RecursiveVisitor::operator()(node);
+        }
+
+        void operator()(const ConstructorDeclaration &node) override { dump(node); }
+
+        void operator()(const ConstructorDefinition &node) override { dump(node); }
+
+        void operator()(const MethodDeclaration &node) override { dump(node); }
+
+        void operator()(const MethodDefinition &node) override { dump(node); }
+
+        void operator()(const ProgramDeclaration &node) override { dump(node); }
+
+        void operator()(const ClassDeclaration &node) override { dump(node); }
+
+        void operator()(const ClassDefinition &node) override { dump(node); }
+
+        void operator()(const Program &node) override { dump(node); }
+
+    private:
+        template<class Node>
+        void dump(const Node &node) {
+            print(node.location());
+            RecursiveVisitor::operator()(node);
+        }
+
+        void print(const yy::SourceRange &location) {
+            out_ << location.begin.offset << "-" << location.end.offset << "\n";
+        }
+
+        std::ostringstream out_;
+    };
+
+    std::string Locations(const Program &program) {
+        LocationDump dump;
+        program.accept(dump);
+        return dump.output();
+    }
+
+    const MemberDeclarationExpr *FirstMember(const Program &program) {
+        auto &classes = program.class_declarations()->class_declarations();
+        auto *clazz = llvm::dyn_cast<ClassDefinition>(classes.front().get());
+        return clazz->body()->member_declarations().front().get();
+    }
+}
+
+class ParserTests : public testing::TestWithParam<yy::ParserBackend> {
+};
+
+TEST_P(ParserTests, ParametersKeepTheirOrder) {
+    auto program = ParseText("class A is\n    method m(a: Integer, b: Real, c: String,) is\n    end\nend\nA()\n", GetParam());
+    auto *method = llvm::dyn_cast<MethodDefinition>(FirstMember(*program));
+    ASSERT_NE(method, nullptr);
+
+    std::vector<std::string> names;
+    for (auto &parameter: method->header()->parameters()) {
+        names.push_back(parameter->name().str());
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST_P(ParserTests, MemberAccessChainsNestToTheRight) {
+    const size_t links = 100000;
+    std::string text = "class A is\n    var x : this";
+    for (size_t i = 0; i < links; i++) {
+        text += ".next()";
+    }
+    text += ".last\nend\nA()\n";
+
+    auto program = ParseText(text, GetParam());
+    auto *variable = llvm::dyn_cast<VariableDeclaration>(FirstMember(*program));
+    ASSERT_NE(variable, nullptr);
+
+    size_t depth = 0;
+    auto *access = llvm::dyn_cast<MemberAccess>(variable->initializer());
+    const yy::SourceLoc end = access->location().end;
+    for (; access; access = llvm::dyn_cast<MemberAccess>(access->rhs())) {
+        EXPECT_EQ(access->location().end, end);
+        ++depth;
+    }
+    EXPECT_EQ(depth, links + 1);
+}
+
+TEST_P(ParserTests, BuildsTheSameAstAsBison) {
+    yy::ProgramShape shape;
+    shape.classes = 8;
+    for (size_t depth = 0; depth <= 4; depth += 2) {
+        for (size_t chain = 0; chain <= 6; chain += 3) {
+            shape.body_depth = depth;
+            shape.chain_length = chain;
+            const std::string text = yy::generate_program(shape);
+            EXPECT_EQ(
+                    PrettyPrint(*ParseText(text, GetParam())),
+                    PrettyPrint(*ParseText(text, yy::ParserBackend::Bison))
+            );
+        }
+    }
+}
+
+TEST_P(ParserTests, ReportsTheSameSyntaxErrorsAsBison) {
+    const std::vector<std::string> sources = {
+            "",
+            "class A is end",
+            "class A is method m(a: Integer,,) end A()",
+            "class A extends is end A()",
+            "class A is var x : this.5 end A()",
+            "class A is var x : a.b. end A()",
+            "class A is this() is if true then else else end end end A()",
+            "class A is method m() => return end A()",
+            "class A is var x : f(, 1) var y : f(1,) end A()",
+            "class A is var x : 'unterminated end A()",
+            "A() class B is end",
+    };
+    for (const auto &source: sources) {
+        std::unique_ptr<Program> expected_program, program;
+        testing::internal::CaptureStderr();
+        int expected = ParseText(source, yy::ParserBackend::Bison, expected_program);
+        std::string expected_error = testing::internal::GetCapturedStderr();
+        testing::internal::CaptureStderr();
+        int result = ParseText(source, GetParam(), program);
+        std::string error = testing::internal::GetCapturedStderr();
+
+        EXPECT_EQ(result, expected) << source;
+        EXPECT_EQ(error, expected_error) << source;
+    }
+}
+
+TEST_P(ParserTests, BodiesNestAsDeepAsTheSourceDoes) {
+    const size_t levels = 100000;
+    std::string text = "class A is\n    this() is\n";
+    for (size_t i = 0; i < levels; i++) {
+        text += i % 2 ? "while true loop\n" : "if true then\n";
+    }
+    text += "x := 1\n";
+    for (size_t i = levels; i-- > 0;) {
+        text += i % 4 == 0 ? "else end\n" : "end\n";
+    }
+    text += "    end\nend\nA()\n";
+
+    auto program = ParseText(text, GetParam());
+    ASSERT_NE(program, nullptr);
+    auto *constructor = llvm::dyn_cast<ConstructorDefinition>(FirstMember(*program));
+    ASSERT_NE(constructor, nullptr);
+
+    size_t depth = 0;
+    const Body *body = constructor->body();
+    for (;;) {
+        ASSERT_EQ(body->expressions().size(), 1u);
+        auto *statement = body->expressions().front().get();
+        if (auto *if_stmt = llvm::dyn_cast<IfStmt>(statement)) {
+            EXPECT_EQ(if_stmt->else_body() != nullptr, depth % 4 == 0);
+            body = if_stmt->then_body();
+        } else if (auto *while_stmt = llvm::dyn_cast<WhileStmt>(statement)) {
+            body = while_stmt->loop_body();
+        } else {
+            EXPECT_TRUE(llvm::isa<AssignmentStmt>(statement));
+            break;
+        }
+        ++depth;
+    }
+    EXPECT_EQ(depth, levels);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        Backends,
+        ParserTests,
+        testing::Values(yy::ParserBackend::Bison, yy::ParserBackend::RecursiveDescent)
+);
+
+TEST(RecursiveDescentParserTests, ReportsCallsNestedTooDeep) {
+    const size_t depth = yy::RecursiveDescentParser::max_call_depth + 1;
+    std::string text = "class A is\n    var x : ";
+    for (size_t i = 0; i < depth; i++) {
+        text += "f(";
+    }
+    text += std::string(depth, ')') + "\nend\nA()\n";
+
+    std::unique_ptr<Program> program;
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(ParseText(text, yy::ParserBackend::RecursiveDescent, program), 1);
+    EXPECT_NE(testing::internal::GetCapturedStderr().find("calls nest too deep"), std::string::npos);
+    EXPECT_EQ(program, nullptr);
+}
+
+TEST(ParallelParserTests, BuildsTheSameAstAsTheSerialParser) {
+    const std::string filename = "parallel_parser_test.opp";
+    yy::ProgramShape shape;
+    shape.classes = 30;
+    shape.methods_per_class = 3;
+    const std::string text = yy::generate_program(shape);
+    auto serial = ParseText(text, yy::ParserBackend::Bison);
+    const std::string expected = PrettyPrint(*serial);
+    const std::string expected_locations = Locations(*serial);
+
+    for (unsigned threads: {1u, 2u, 4u}) {
+        for (size_t chunk_size: {size_t(1), size_t(700), size_t(0)}) {
+            yy::ParallelParser parser(text, filename, threads, chunk_size);
+            auto program = parser.parse();
+            ASSERT_NE(program, nullptr) << threads << " threads, chunks of " << chunk_size;
+            EXPECT_EQ(PrettyPrint(*program), expected) << threads << " threads, chunks of " << chunk_size;
+            EXPECT_EQ(Locations(*program), expected_locations) << threads << " threads, chunks of " << chunk_size;
+        }
+    }
+    EXPECT_EQ(yy::ParallelParser(text, filename, 2, 1).chunk_count(), shape.classes + 1);
+}
+
+TEST(ParallelParserTests, LeavesFilesItCannotCutToTheSerialParser) {
+    const std::vector<std::string> sources = {
+            "class A is var s : 'spans\nclass Fake is end\n' end\nclass B is end\nA()\n",
+            "class A is end\nclass B is var x : end\nclass C is end\nA()\n",
+            "class A is end\nclass B is end\n",
+            "class A is end\nA()\nclass B is end\n",
+    };
+    for (const auto &source: sources) {
+        EXPECT_EQ(yy::ParallelParser(source, "unused.opp", 2, 1).parse(), nullptr) << source;
+    }
+
+    const size_t depth = yy::RecursiveDescentParser::max_call_depth + 1;
+    std::string nested = "class A is end\nclass B is var x : ";
+    for (size_t i = 0; i < depth; i++) {
+        nested += "f(";
+    }
+    nested += std::string(depth, ')') + " end\nA()\n";
+    EXPECT_EQ(yy::ParallelParser(nested, "unused.opp", 2, 1).parse(), nullptr);
+    EXPECT_NE(ParseText(nested, yy::ParserBackend::Bison), nullptr);
+}
+
+TEST(ParallelParserTests, ParsesBodiesNestedAsDeepAsTheSerialParser) {
+    const size_t levels = 20000;
+    std::string text = "class A is end\nclass B is\n    this() is\n";
+    for (size_t i = 0; i < levels; i++) {
+        text += "while true loop\n";
+    }
+    for (size_t i = 0; i < levels; i++) {
+        text += "end\n";
+    }
+    text += "    end\nend\nA()\n";
+
+    yy::ParallelParser parser(text, "nested.opp", 2, 1);
+    auto program = parser.parse();
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(program->class_declarations()->class_declarations().size(), 2u);
+}
+
+
+namespace {
+    // The incremental parser against a parse from scratch of the same text.
+    void ExpectSameAsFreshParse(const yy::IncrementalParser &parser, const std::string &context) {
+        std::unique_ptr<Program> fresh;
+        testing::internal::CaptureStderr();
+        int failure = ParseText(parser.text(), yy::ParserBackend::RecursiveDescent, fresh);
+        testing::internal::GetCapturedStderr();
+
+        ASSERT_EQ(parser.program() == nullptr, failure != 0) << context;
+        if (fresh) {
+            EXPECT_EQ(PrettyPrint(*parser.program()), PrettyPrint(*fresh)) << context;
+            EXPECT_EQ(Locations(*parser.program()), Locations(*fresh)) << context;
+        }
+    }
+}
+
+TEST(IncrementalParserTests, EditsMatchParsingFromScratch) {
+    yy::ProgramShape shape;
+    shape.classes = 6;
+    shape.methods_per_class = 3;
+    yy::IncrementalParser parser(yy::generate_program(shape), "edited.opp");
+    ASSERT_NE(parser.program(), nullptr);
+
+    // Fragments that keep the program parsing, and some that break it or move
+    // tokens from one class into another; every edit is undone again.
+    const std::vector<std::string> fragments = {
+            "", " ", "\n", "\n\n  ", "7", "x", "'", ".", "end", "end\nclass Z is", "class Y is end\n",
+    };
+    std::mt19937 random(7);
+    for (int i = 0; i < 300; i++) {
+        const std::string &inserted = fragments[random() % fragments.size()];
+        const size_t offset = random() % (parser.text().size() + 1);
+        const size_t removed = std::min<size_t>(random() % 3, parser.text().size() - offset);
+        const std::string original = parser.text().substr(offset, removed);
+        const std::string context = "edit " + std::to_string(i) + " at " + std::to_string(offset);
+
+        testing::internal::CaptureStderr();
+        parser.apply({offset, removed, inserted});
+        testing::internal::GetCapturedStderr();
+        ExpectSameAsFreshParse(parser, context);
+
+        testing::internal::CaptureStderr();
+        parser.apply({offset, inserted.size(), original});
+        testing::internal::GetCapturedStderr();
+        ExpectSameAsFreshParse(parser, context + ", undone");
+    }
+}
+
+TEST(IncrementalParserTests, OnlyTheEditedClassIsParsedAgain) {
+    const std::string text = "class A is\n    var a : 1\nend\n"
+                             "class B is\n    var b : 2\nend\n"
+                             "class C is\n    var c : 3\nend\n"
+                             "C()\n";
+    yy::IncrementalParser parser(text, "edited.opp");
+    EXPECT_EQ(parser.parsed_classes(), 3);
+
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(parser.apply({text.find('2'), 1, "2 + \n\n  2"}), 1);
+    EXPECT_NE(testing::internal::GetCapturedStderr(), "");
+    EXPECT_EQ(parser.program(), nullptr);
+    EXPECT_EQ(parser.apply({text.find('2'), 10, "22\n\n"}), 0);
+    EXPECT_EQ(parser.parsed_classes(), 3);
+    ExpectSameAsFreshParse(parser, "after a syntax error");
+
+    EXPECT_EQ(parser.apply({parser.text().find("22"), 2, "2\n"}), 0);
+    EXPECT_EQ(parser.parsed_classes(), 1);
+    ExpectSameAsFreshParse(parser, "in class B");
+
+    EXPECT_EQ(parser.apply({parser.text().find("C()"), 3, "B()"}), 0);
+    EXPECT_EQ(parser.parsed_classes(), 0);
+    ExpectSameAsFreshParse(parser, "in the main class expression");
+
+    // Without the end of A, B is read as a member of A.
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(parser.apply({parser.text().find("end"), 3, ""}), 1);
+    EXPECT_NE(testing::internal::GetCapturedStderr(), "");
+    EXPECT_EQ(parser.program(), nullptr);
+}
+
+
+TEST(AstArenaTests, NodesBuiltInScopeLiveInTheArena) {
+    yy::ProgramShape shape;
+    shape.classes = 20;
+    const std::string text = yy::generate_program(shape);
+
+    yy::AstArena arena;
+    std::unique_ptr<Program> program;
+    {
+        yy::AstArena::Scope scope(&arena);
+        program = ParseText(text, yy::ParserBackend::Bison);
+        {
+            yy::AstArena::Scope heap(nullptr);
+            EXPECT_EQ(yy::AstArena::current(), nullptr);
+            auto elsewhere = ParseText(text, yy::ParserBackend::RecursiveDescent);
+        }
+        EXPECT_EQ(yy::AstArena::current(), &arena);
+    }
+    EXPECT_EQ(yy::AstArena::current(), nullptr);
+
+    const std::string locations = Locations(*program);
+    EXPECT_EQ(arena.allocations(), static_cast<size_t>(std::count(locations.begin(), locations.end(), '\n')));
+    EXPECT_EQ(PrettyPrint(*program), PrettyPrint(*ParseText(text, yy::ParserBackend::Bison)));
+    program.reset();
+}
+
+namespace {
+    // Node locations in the order they are entered, as LocationDump prints them.
+    class FlatLocationDump : public yy::FlatVisitor {
+    public:
+        bool enter(const yy::FlatAst &ast, yy::NodeId node) override {
+            out_ << ast.location(node).begin.offset << "-" << ast.location(node).end.offset << "\n";
+            return true;
+        }
+
+        std::string output() const {
+            return out_.str();
+        }
+
+    private:
+        std::ostringstream out_;
+    };
+
+    // The program bison parses from `text`, and the FlatAst it builds beside it.
+    std::unique_ptr<Program> ParseFlat(const std::string &text, yy::FlatAst &ast) {
+        yy::Scanner scanner{yy::BufferedReader(std::string_view(text)), "flat_test.opp"};
+        std::unique_ptr<Program> program;
+        yy::FlatAstBuilder builder(ast);
+        EXPECT_EQ(yy::parser(scanner, program, &builder)(), 0);
+        return program;
+    }
+}
+
+TEST(FlatAstTests, RoundTripKeepsTheProgram) {
+    yy::ProgramShape shape;
+    shape.classes = 20;
+    shape.body_depth = 4;
+    shape.chain_length = 6;
+    auto program = ParseText(yy::generate_program(shape), yy::ParserBackend::RecursiveDescent);
+    const std::string locations = Locations(*program);
+
+    yy::FlatAst ast = yy::flatten(*program);
+    EXPECT_EQ(ast.size(), static_cast<size_t>(std::count(locations.begin(), locations.end(), '\n')));
+    EXPECT_EQ(ast.kind(ast.root()), yy::NodeKind::Program);
+
+    FlatLocationDump dump;
+    ast.walk(dump);
+    EXPECT_EQ(dump.output(), locations);
+
+    auto rebuilt = yy::unflatten(ast);
+    EXPECT_EQ(PrettyPrint(*rebuilt), PrettyPrint(*program));
+    EXPECT_EQ(Locations(*rebuilt), locations);
+}
+
+TEST(FlatAstTests, LongChainsTakeNoStack) {
+    const size_t links = 100000;
+    std::string text = "class A is\n    var x : this";
+    for (size_t i = 0; i < links; i++) {
+        text += ".next()";
+    }
+    text += "\nend\nA()\n";
+    auto program = ParseText(text, yy::ParserBackend::RecursiveDescent);
+
+    class ChainCounter : public yy::FlatVisitor {
+    public:
+        bool enter(const yy::FlatAst &ast, yy::NodeId node) override {
+            count += ast.kind(node) == yy::NodeKind::MemberAccess;
+            return true;
+        }
+
+        size_t count = 0;
+    } counter;
+    yy::FlatAst ast = yy::flatten(*program);
+    ast.walk(counter);
+    // The main class expression is `this.A()`.
+    EXPECT_EQ(counter.count, links + 1);
+
+    yy::FlatAst again = yy::flatten(*yy::unflatten(ast));
+    ASSERT_EQ(again.size(), ast.size());
+    for (yy::NodeId node = 0; node < ast.size(); node++) {
+        ASSERT_EQ(again.kind(node), ast.kind(node));
+        ASSERT_EQ(again.location(node), ast.location(node));
+    }
+}
+
+TEST(FlatAstTests, TheParserBuildsTheProgramItReturns) {
+    yy::ProgramShape shape;
+    shape.classes = 20;
+    shape.body_depth = 4;
+    shape.chain_length = 6;
+    yy::FlatAst ast;
+    auto program = ParseFlat(yy::generate_program(shape), ast);
+    EXPECT_EQ(ast.size(), yy::flatten(*program).size());
+    EXPECT_EQ(ast.kind(ast.root()), yy::NodeKind::Program);
+
+    FlatLocationDump dump;
+    ast.walk(dump);
+    EXPECT_EQ(dump.output(), Locations(*program));
+    EXPECT_EQ(PrettyPrint(*yy::unflatten(ast)), PrettyPrint(*program));
+}
+
+namespace {
+    // LocationDump on the iterative visitor.
+    class IterativeLocationDump : public yy::IterativeVisitor<IterativeLocationDump> {
+    public:
+        std::string output() const {
+            return out_.str();
+        }
+
+        template<class Node>
+        bool enter(const Node &node) {
+            print(node.location());
+            return true;
+        }
+
+        bool enter(const VariableDeclaration &node) {
+            print(static_cast<const BodyExpr &>(node).location());
+            return true;
+        }
+
+    private:
+        void print(const yy::SourceRange &location) {
+            out_ << location.begin.offset << "-" << location.end.offset << "\n";
+        }
+
+        std::ostringstream out_;
+    };
+
+    // A method whose body is `levels` ifs deep.
+    std::string NestedIfs(size_t levels, bool with_else) {
+        std::string text = "class A is\n    method m() : Integer is\n";
+        for (size_t level = 0; level < levels; level++) {
+            text += "if this.m() then\n";
+        }
+        text += "return this.m()\n";
+        for (size_t level = 0; level < levels; level++) {
+            text += with_else ? "else\nvar x : 1\nend\n" : "end\n";
+        }
+        return text + "    end\nend\nA()\n";
+    }
+}
+
+TEST(IterativeVisitorTests, VisitsWhatTheRecursiveVisitorVisits) {
+    yy::ProgramShape shape;
+    shape.classes = 20;
+    shape.body_depth = 4;
+    shape.chain_length = 6;
+    auto program = ParseText(yy::generate_program(shape), yy::ParserBackend::RecursiveDescent);
+
+    IterativeLocationDump dump;
+    dump.visit(*program);
+    EXPECT_EQ(dump.output(), Locations(*program));
+
+    // Deeper than it recurses.
+    auto nested = ParseText(NestedIfs(1000, true), yy::ParserBackend::Bison);
+    IterativeLocationDump nested_dump;
+    nested_dump.visit(*nested);
+    EXPECT_EQ(nested_dump.output(), Locations(*nested));
+}
+
+TEST(IterativeVisitorTests, DeepBodiesTakeNoStack) {
+    auto program = ParseText(NestedIfs(100000, false), yy::ParserBackend::Bison);
+    SymbolTableIndex index;
+    SymbolTable table;
+    oppstd::register_builtins(&table);
+
+    yy::PassManager passes;
+    yy::add_semantic_passes(passes, &table, &index);
+    std::vector<SemanticError> errors;
+    passes.run(*program, errors);
+    ASSERT_EQ(errors.size(), 100002);
+    for (size_t level = 0; level < 100000; level++) {
+        ASSERT_EQ(errors[level].message(), "Expected type: Boolean, but found: Integer");
+    }
+    EXPECT_EQ(errors[100000].message(), "Cant get overload for constructor");
+    EXPECT_EQ(errors[100001].message(), "Missing return statement");
+}
+
+TEST(IncrementalParserTests, ShiftsClassesNestedDeeperThanTheStackTakes) {
+    const std::string text = "class Z is\n    var z : 1\nend\n" + NestedIfs(100000, false);
+    yy::IncrementalParser parser(text, "nested.opp");
+    ASSERT_NE(parser.program(), nullptr);
+    EXPECT_EQ(parser.apply({text.find('1'), 1, "1\n\n"}), 0);
+    EXPECT_EQ(parser.parsed_classes(), 1);
+
+    IterativeLocationDump shifted;
+    shifted.visit(*parser.program());
+    IterativeLocationDump fresh;
+    fresh.visit(*ParseText(parser.text(), yy::ParserBackend::RecursiveDescent));
+    EXPECT_EQ(shifted.output(), fresh.output());
+}
+
+namespace {
+    // The diagnostics of the driver's passes over `text`, then the symbols.
+    std::string Analyze(const std::string &text, bool fusion, unsigned threads, const char *skipped = nullptr) {
+        auto program = ParseText(text, yy::ParserBackend::RecursiveDescent);
+        SymbolTableIndex index;
+        SymbolTable table;
+        oppstd::register_builtins(&table);
+
+        yy::PassManager passes;
+        passes.set_fusion(fusion);
+        passes.set_threads(threads);
+        yy::add_semantic_passes(passes, &table, &index);
+        if (skipped) {
+            passes.disable(skipped);
+        }
+
+        std::vector<SemanticError> errors;
+        passes.run(*program, errors);
+        std::ostringstream out;
+        for (auto &error: errors) {
+            out << error << "\n";
+        }
+        out << table.print_debug_info();
+        return out.str();
+    }
+
+    // The parent class, whose field `age` is redefined, and the field `lives`,
+    // which the local variable is taken for, come after their uses.
+    const std::string forward_references =
+            "class Cat extends Pet is\n"
+            "    var age : 'one'\n"
+            "    method name() : String is\n"
+            "        var lives : 9\n"
+            "        lives := 'nine'\n"
+            "        if lives then\n"
+            "            return 1\n"
+            "        end\n"
+            "    end\n"
+            "    var lives : 7\n"
+            "end\n"
+            "class Pet is\n"
+            "    var age : 1\n"
+            "    method kind() : Integer is\n"
+            "        return true\n"
+            "    end\n"
+            "end\n"
+            "Cat()\n";
+}
+
+TEST(PassManagerTests, ReportsWhatThePassesReportOneAfterTheOther) {
+    const std::string serial = Analyze(forward_references, false, 1);
+    EXPECT_NE(serial.find("Redefinition of field: age"), std::string::npos);
+    EXPECT_EQ(Analyze(forward_references, true, 1), serial);
+    EXPECT_EQ(Analyze(forward_references, false, 4), serial);
+    EXPECT_EQ(Analyze(forward_references, true, 4), serial);
+
+    yy::ProgramShape shape;
+    shape.classes = 20;
+    shape.body_depth = 3;
+    const std::string text = yy::generate_program(shape);
+    EXPECT_EQ(Analyze(text, true, 4), Analyze(text, false, 1));
+}
+
+TEST(PassManagerTests, FusesWalksAndSkipsWhatADisabledPassFeeds) {
+    SymbolTableIndex index;
+    SymbolTable table;
+    yy::PassManager passes;
+    yy::add_semantic_passes(passes, &table, &index);
+    // The collectors, then the symbol table with the passes that read it per
+    // class, then inheritance, which needs the types of all fields.
+    EXPECT_EQ(passes.walks(), 4u);
+    // Control flow needs nothing, so it gets a walk of its own to run beside the others.
+    passes.set_threads(4);
+    EXPECT_EQ(passes.walks(), 5u);
+    passes.set_fusion(false);
+    EXPECT_EQ(passes.walks(), 7u);
+
+    passes.disable("type checker");
+    EXPECT_EQ(passes.passes(), (std::vector<std::string>{
+            "class collector", "method collector", "symbol table", "entrypoint", "control flow"
+    }));
+    EXPECT_THROW(passes.disable("optimizer"), std::runtime_error);
+
+    yy::driver driver;
+    EXPECT_TRUE(driver.skip_pass("type-checker"));
+    EXPECT_TRUE(driver.skip_pass("control flow"));
+    EXPECT_FALSE(driver.skip_pass("optimizer"));
+
+    const std::string skipped = Analyze(forward_references, true, 1, "type checker");
+    EXPECT_EQ(skipped.find("Expected type"), std::string::npos);
+    EXPECT_NE(skipped.find("Missing return statement"), std::string::npos);
+}
+
+TEST(PassManagerTests, ControlFlowOnTheFlatAstReportsWhatItReportsOnTheProgram) {
+    for (auto &text: {forward_references, NestedIfs(100000, false), NestedIfs(1000, true)}) {
+        yy::FlatAst ast;
+        auto program = ParseFlat(text, ast);
+        std::vector<SemanticError> tree_errors;
+        std::vector<SemanticError> flat_errors;
+        for (auto flat: {false, true}) {
+            SymbolTableIndex index;
+            SymbolTable table;
+            oppstd::register_builtins(&table);
+            yy::PassManager passes;
+            yy::add_semantic_passes(passes, &table, &index, flat ? &ast : nullptr);
+            passes.run(*program, flat ? flat_errors : tree_errors);
+        }
+        ASSERT_EQ(flat_errors.size(), tree_errors.size());
+        for (size_t i = 0; i < tree_errors.size(); i++) {
+            ASSERT_EQ(flat_errors[i].message(), tree_errors[i].message());
+            ASSERT_EQ(flat_errors[i].location(), tree_errors[i].location());
+        }
+    }
+}
+
+TEST(SymbolTableTests, ScopesFindWhatWasDeclaredAroundThem) {
+    // More fields than fit in a record, and more scopes than fit in a chunk.
+    const size_t fields = 3000;
+    SymbolTable table;
+    yy::Name class_name("SymbolTableTestsClass");
+    auto clazz = table.add_symbol(class_name, std::make_unique<ClassSymbol>(class_name, nullptr));
+    ASSERT_NE(clazz, nullptr);
+    auto class_symbol = table.resolve_class(class_name);
+    ASSERT_NE(class_symbol, nullptr);
+    EXPECT_EQ(table.add_symbol(class_name, std::make_unique<ClassSymbol>(class_name, nullptr)), nullptr);
+
+    std::vector<SymbolTable *> scopes;
+    for (size_t i = 0; i < fields; i++) {
+        yy::Name name("symbol_table_field_" + std::to_string(i));
+        auto field = std::make_unique<InstanceSymbol>(InstanceSymbolKind::field, class_symbol, name, nullptr);
+        ASSERT_NE(clazz->add_symbol(name, std::move(field)), nullptr);
+        scopes.push_back(clazz->add_child());
+    }
+
+    for (size_t i = 0; i < fields; i++) {
+        yy::Name name("symbol_table_field_" + std::to_string(i));
+        auto field = table.resolve_field(class_name, name);
+        ASSERT_NE(field, nullptr);
+        EXPECT_EQ(field->name(), name);
+        EXPECT_EQ(scopes[i]->resolve_local(name), field);
+        EXPECT_EQ(scopes[i]->resolve_this(), class_symbol);
+    }
+    EXPECT_EQ(table.resolve_field(class_name, yy::Name("symbol_table_no_field")), nullptr);
+    EXPECT_EQ(table.resolve_this(), nullptr);
+}
+
+TEST(SymbolTableTests, EmptyNamesAreNeverFound) {
+    SymbolTable table;
+    yy::Name class_name("SymbolTableTestsEmptyNames");
+    auto clazz = table.add_symbol(class_name, std::make_unique<ClassSymbol>(class_name, nullptr));
+    ASSERT_NE(clazz, nullptr);
+    auto few = clazz->add_child();
+    ASSERT_NE(few->add_symbol(yy::Name("symbol_table_few"), {}), nullptr);
+    // Names in a record, then in a hash table.
+    for (auto scope: {few, clazz}) {
+        for (size_t i = 0; i < 2; i++) {
+            EXPECT_NE(scope->add_symbol(yy::Name(), {}), nullptr);
+        }
+    }
+    for (size_t i = 0; i < 10; i++) {
+        ASSERT_NE(clazz->add_symbol(yy::Name("symbol_table_many_" + std::to_string(i)), {}), nullptr);
+        EXPECT_NE(clazz->add_symbol(yy::Name(), {}), nullptr);
+    }
+    EXPECT_EQ(few->resolve_symbol(yy::Name()), nullptr);
+    EXPECT_EQ(clazz->resolve_symbol(yy::Name()), nullptr);
+    EXPECT_EQ(few->resolve_symbol(yy::Name("symbol_table_many_9")), clazz->resolve_symbol(yy::Name("symbol_table_many_9")));
+}
+
+TEST(NameTests, EqualTextsAreOneName) {
+    const std::string text = "interned_in_test";
+    EXPECT_TRUE(yy::Name::find("never_interned_in_test").empty());
+
+    yy::Name name(text);
+    EXPECT_FALSE(name.empty());
+    EXPECT_EQ(name, yy::Name(std::string_view("interned_in_test")));
+    EXPECT_EQ(name, yy::Name::find(text));
+    EXPECT_NE(name, yy::Name("interned_in_test_too"));
+    EXPECT_EQ(name.str(), text);
+    EXPECT_TRUE(yy::Name("").empty());
+}
+
+TEST(NameTests, ThreadsShareThePool) {
+    const size_t names = 10000;
+    std::vector<std::vector<yy::Name>> interned(4);
+    std::vector<std::thread> threads;
+    for (auto &mine: interned) {
+        threads.emplace_back([&mine] {
+            for (size_t i = 0; i < names; i++) {
+                mine.emplace_back("shared_" + std::to_string(i));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < names; i++) {
+        for (auto &theirs: interned) {
+            ASSERT_EQ(theirs[i], interned[0][i]);
+        }
+        ASSERT_EQ(interned[0][i].str(), "shared_" + std::to_string(i));
+    }
+}
+
+
+TEST(GeneratedProgramTests, SameShapeGivesSameProgram) {
+    yy::ProgramShape shape;
+    shape.classes = 5;
+    EXPECT_EQ(yy::generate_program(shape), yy::generate_program(shape));
+
+    shape.seed = 2;
+    yy::ProgramShape other = shape;
+    other.seed = 3;
+    EXPECT_NE(yy::generate_program(shape), yy::generate_program(other));
+}
+
+// Generated programs are full of type errors; every pass has to get through them.
+TEST(GeneratedProgramTests, PassesRunOverGeneratedPrograms) {
+    const auto path = std::filesystem::temp_directory_path() / "opp_generated.opp";
+    yy::ProgramShape shape;
+    shape.classes = 3;
+    shape.methods_per_class = 4;
+    shape.chain_length = 2;
+    for (size_t depth = 0; depth <= 3; depth++) {
+        shape.body_depth = depth;
+        std::ofstream(path) << yy::generate_program(shape);
+
+        yy::driver driver;
+        EXPECT_EQ(driver.parse(path.string()), 0);
+    }
+    std::filesystem::remove(path);
+}